@@ -10,6 +10,7 @@
 // pch
 #include <builder/pch.h>
 
+#include <map>
 #include <set>
 #include <queue>
 #include <optional>
@@ -26,11 +27,16 @@ namespace kara::parser {
     struct Code;
     struct Root;
     struct Type;
+    struct Enum;
+    struct EnumCase;
     struct Block;
     struct Index;
+    struct Match;
     struct Assign;
+    struct Lambda;
     struct Import;
     struct Ternary;
+    struct Unpack;
     struct Function;
     struct Variable;
     struct Reference;
@@ -127,6 +133,8 @@ namespace kara::builder {
         Variable(const parser::Variable *node, const ops::Context &context);
         // function parameter
         Variable(const parser::Variable *node, const ops::Context &context, llvm::Value *argument);
+        // for in loop variable, value points at the current element
+        Variable(const parser::Variable *node, utils::Typename type, llvm::Value *value);
     };
 
     struct Cache {
@@ -181,10 +189,55 @@ namespace kara::builder {
         explicit Type(const parser::Type *node, builder::Builder &builder);
     };
 
+    // enum Name { A, B = 5 }, every case is a constant of the underlying integer type
+    struct Enum {
+        builder::Builder &builder;
+        const parser::Enum *node = nullptr;
+
+        // smallest integer type that holds every case, unless one is given
+        utils::PrimitiveTypename underlying;
+        llvm::IntegerType *type = nullptr;
+
+        std::unordered_map<const parser::EnumCase *, llvm::ConstantInt *> values;
+
+        // the first case, new values start out holding it
+        llvm::ConstantInt *initial = nullptr;
+        // a value no case uses, ?E and (E | null) store it for empty instead of a flag, null if every value is a case
+        llvm::ConstantInt *niche = nullptr;
+
+        explicit Enum(const parser::Enum *node, builder::Builder &builder);
+    };
+
+    // [K -> V], open addressing with a control byte per slot, lookup code is generated per map type (map.cpp)
+    struct Map {
+        builder::Builder &builder;
+
+        utils::MapTypename type;
+
+        llvm::StructType *structType = nullptr; // { size, capacity, growth, control, slots }
+        llvm::StructType *entryType = nullptr; // { K, V }
+
+        // internal functions, created by build()
+        llvm::Function *find = nullptr; // (map, &K) -> &entry, null if missing
+        llvm::Function *insert = nullptr; // (map, &K) -> &entry, K must be missing, value is left uninitialized
+        llvm::Function *erase = nullptr; // (map, &entry), value must already be destroyed
+        llvm::Function *rehash = nullptr; // (map, capacity), capacity is a power of two, at least 8
+
+        // separate from constructor, struct keys might not have a body yet when the type is first named
+        void build();
+
+        Map(const utils::MapTypename &type, builder::Builder &builder);
+    };
+
+    // the type each ^T name of a generic function was inferred as, in parser::Function::generics order
+    using Generics = std::vector<std::pair<std::string, utils::Typename>>;
+
     struct Function {
         enum class Purpose {
             UserFunction,
             TypeDestructor,
+            ElementDestructor,
+            Closure,
         };
 
         Purpose purpose = Purpose::UserFunction;
@@ -208,9 +261,26 @@ namespace kara::builder {
         utils::FunctionTypename type;
         llvm::Function *function = nullptr;
 
+        // malloc calls from `new`, candidates for promote() with their allocated type
+        std::vector<std::pair<llvm::CallInst *, llvm::Type *>> heapAllocations;
+
+        // Closure only, variables from enclosing functions copied into the environment in this order
+        std::vector<std::pair<const parser::Variable *, utils::Typename>> captures;
+        // nullptr when nothing is captured, the closure then carries a null environment
+        llvm::StructType *environment = nullptr;
+
+        // generic instantiations only, built once per distinct set of types with linkonce_odr linkage
+        Generics generics;
+
         void build();
+        // moves heapAllocations that never leave this function to the entry block
+        void promote();
+        // Closure only, marks the environment nocapture if no pointer derived from it outlives the call
+        void markEnvironment();
 
         Function(const hermes::Node *node, Builder &builder);
+        // body is emitted by the caller into entry, build() must not be called
+        Function(llvm::Function *function, Builder &builder);
     };
 
     struct Builder {
@@ -226,6 +296,11 @@ namespace kara::builder {
         llvm::Function *mallocCache = nullptr;
         llvm::Function *freeCache = nullptr;
         llvm::Function *reallocCache = nullptr;
+        llvm::Function *callocCache = nullptr;
+
+        llvm::Function *allocateCache = nullptr;
+        llvm::Function *deallocateCache = nullptr;
+        llvm::Function *reallocateCache = nullptr;
 
         std::unordered_set<const SourceFile *> dependencies;
 
@@ -239,22 +314,68 @@ namespace kara::builder {
 
         const hermes::Node *lookupDestroy(const utils::Typename &type);
         bool needsDestroy(const utils::Typename &type);
+        // true if ops::makeInitialize would only write zero bytes, so calloc'd memory is already initialized
+        bool initializesToZero(const utils::Typename &type);
+        // the T that ?T and (T | null) store for empty instead of a flag, null pointers and unused enum values
+        // nullptr if every value of T means something
+        llvm::Constant *makeNiche(const utils::Typename &type);
+        // for (&T | null) or (E | null), the index of the T which is stored in place of the whole variant
+        std::optional<size_t> variantNiche(const utils::VariantTypename &type);
 
         std::unordered_map<const parser::Type *, std::unique_ptr<Function>> implicitDestructors;
 
         std::unordered_map<const parser::Type *, std::unique_ptr<builder::Type>> types;
+        std::unordered_map<const parser::Enum *, std::unique_ptr<builder::Enum>> enums;
         std::unordered_map<const parser::Variable *, std::unique_ptr<builder::Variable>> globals;
         std::unordered_map<const parser::Function *, std::unique_ptr<builder::Function>> functions;
+        // keyed with the enclosing function too, a lambda in a generic function is built once per instantiation
+        std::map<std::pair<const parser::Lambda *, const builder::Function *>, std::unique_ptr<builder::Function>>
+            lambdas;
+
+        // generic function -> one builder::Function per Generics, searched like elementDestructors
+        std::vector<std::unique_ptr<builder::Function>> instantiations;
+        // generic functions being matched or built, innermost last, resolveTypename looks ^T names up here
+        std::vector<std::pair<const parser::Function *, Generics>> instantiating;
+
+        std::vector<std::unique_ptr<builder::Map>> maps;
+
+        // text -> i8 * into a private unnamed_addr global, so every use of a literal shares one copy
+        std::unordered_map<std::string, llvm::Constant *> strings;
+
+        // element type -> void (T *data, u64 size) that destroys each element, see makeElementDestructor
+        std::vector<std::pair<utils::Typename, std::unique_ptr<builder::Function>>> elementDestructors;
+        // variant type -> void (Variant *) that switches on the tag, see makeVariantDestructor
+        std::vector<std::pair<utils::Typename, std::unique_ptr<builder::Function>>> variantDestructors;
 
         builder::Type *makeType(const parser::Type *node);
+        builder::Enum *makeEnum(const parser::Enum *node);
+        builder::Map *makeMap(const utils::MapTypename &type);
+        llvm::Constant *makeStringConstant(const std::string &text);
+        // nullptr if type needs no destroy, otherwise generated once per type
+        llvm::Function *makeElementDestructor(const utils::Typename &type);
+        // nullptr if no alternative needs a destroy, otherwise generated once per type
+        llvm::Function *makeVariantDestructor(const utils::VariantTypename &type);
         builder::Variable *makeGlobal(const parser::Variable *node);
         builder::Function *makeFunction(const parser::Function *node);
+        // generated once per generics, every file calling it with the same types emits the same copy
+        builder::Function *makeInstantiation(const parser::Function *node, const Generics &generics);
+        // scope is the cache where the lambda is written, captured variables are looked up there
+        builder::Function *makeLambda(
+            const parser::Lambda *node, const builder::Function *parent, const builder::Cache &scope);
 
         llvm::Function *getMalloc();
         llvm::Function *getFree();
         llvm::Function *getRealloc();
+        llvm::Function *getCalloc();
+
+        // sized hooks for options.allocator, prefer ops::makeAllocate and friends
+        llvm::Function *getAllocate();
+        llvm::Function *getDeallocate();
+        llvm::Function *getReallocate();
 
         std::vector<const hermes::Node *> findAll(const parser::Reference *node);
+        // path of the source file node was parsed from, this file or one of its dependencies
+        const std::string &declaringPath(const hermes::Node *node);
 
         using SearchChecker = std::function<bool(const hermes::Node *)>;
 
@@ -263,12 +384,34 @@ namespace kara::builder {
 
         utils::Typename resolveTypename(const hermes::Node *node);
 
+        // true if node only names literals, let globals, types, enums and functions makeConstant can fold
+        bool isConstant(const parser::Expression *node);
+        // node folded at compile time and converted to type if one is given, the value is an llvm::Constant
+        // throws VerifyError on anything that would have to run, see constant.cpp
+        builder::Result makeConstant(
+            const parser::Expression *node, const std::optional<utils::Typename> &type = std::nullopt);
+        // types[i] is passed to parameter i, nullopt if node cannot take them or a ^T is left unbound
+        std::optional<Generics> inferGenerics(
+            const parser::Function *node, const std::vector<std::optional<utils::Typename>> &types);
+
         llvm::Type *makeTypename(const utils::Typename &type);
         [[nodiscard]] llvm::Type *makePrimitiveType(utils::PrimitiveType type) const;
 
-        llvm::StructType *makeOptionalType(const utils::Typename &of);
+        // R (i8 *environment, parameters...) after platform formatting, closures are {function *, i8 *environment}
+        llvm::FunctionType *makeClosureFunctionType(const utils::FunctionTypename &type);
+        // {i1, T}, or just T when T has a null niche
+        llvm::Type *makeOptionalType(const utils::Typename &of);
+        // {payload, tag} with the smallest tag that fits, or the niche alternative alone
+        llvm::Type *makeVariantType(const utils::VariantTypename &type);
+        llvm::IntegerType *makeVariantTagType(const utils::VariantTypename &type);
         // take llvm::Type * ? can use hashmap
         llvm::StructType *makeVariableArrayType(const utils::Typename &of);
+        // same layout as variable arrays up to data, followed by storage for size elements
+        llvm::StructType *makeHybridArrayType(const utils::Typename &of, size_t size);
+        // [T::] views, size then data so size is at the same index as variable arrays
+        llvm::StructType *makeIterableArrayType(const utils::Typename &of);
+        // {count, T} allocated together, a *shared T points at the T
+        llvm::StructType *makeSharedType(const utils::Typename &of);
 
         Builder(const SourceFile &file, SourceManager &manager, const Target &target, const options::Options &opts);
     };
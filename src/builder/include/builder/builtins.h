@@ -68,6 +68,26 @@ namespace kara::builder::ops::handlers::builtins {
         };
     }
 
+    namespace maps {
+        Maybe<builder::Result> size(const Context &context, const Parameters &parameters);
+
+        Maybe<builder::Result> get(const Context &context, const Parameters &parameters);
+        Maybe<builder::Result> set(const Context &context, const Parameters &parameters);
+        Maybe<builder::Result> remove(const Context &context, const Parameters &parameters);
+
+        Maybe<builder::Result> reserve(const Context &context, const Parameters &parameters);
+        Maybe<builder::Result> clear(const Context &context, const Parameters &parameters);
+
+        constexpr std::array functions = {
+            std::make_pair("size", size),
+            std::make_pair("get", get),
+            std::make_pair("set", set),
+            std::make_pair("remove", remove),
+            std::make_pair("reserve", reserve),
+            std::make_pair("clear", clear),
+        };
+    }
+
     namespace unique {
         Maybe<builder::Result> get(const Context &context, const Parameters &parameters);
         Maybe<builder::Result> release(const Context &context, const Parameters &parameters);
@@ -87,7 +107,8 @@ namespace kara::builder::ops::handlers::builtins {
     }
 
     // sorry, no flattening...
-    constexpr auto functions = utility::concat(arrays::functions, misc::functions, unique::functions);
+    constexpr auto functions
+        = utility::concat(arrays::functions, maps::functions, misc::functions, unique::functions);
 
     std::vector<BuiltinFunction> matching(const std::string &name);
 }
\ No newline at end of file
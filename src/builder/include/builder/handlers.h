@@ -67,10 +67,20 @@ namespace kara::builder::ops::handlers {
         const Context &context, const builder::Result &result, const utils::Typename &type, bool force);
     Maybe<builder::Result> makeConvertForcedFuncPtrToFuncPtr(
         const Context &context, const builder::Result &result, const utils::Typename &type, bool force);
+    Maybe<builder::Result> makeConvertForcedEnumToInt(
+        const Context &context, const builder::Result &result, const utils::Typename &type, bool force);
+    Maybe<builder::Result> makeConvertForcedIntToEnum(
+        const Context &context, const builder::Result &result, const utils::Typename &type, bool force);
     Maybe<builder::Result> makeConvertUniqueOrMutableToRef(
         const Context &context, const builder::Result &result, const utils::Typename &type, bool force);
     Maybe<builder::Result> makeConvertUniqueToVariableArray(
         const Context &context, const builder::Result &result, const utils::Typename &type, bool force);
+    Maybe<builder::Result> makeConvertArrayToIterable(
+        const Context &context, const builder::Result &result, const utils::Typename &type, bool force);
+    Maybe<builder::Result> makeConvertTupleElements(
+        const Context &context, const builder::Result &result, const utils::Typename &type, bool force);
+    Maybe<builder::Result> makeConvertTypeToVariant(
+        const Context &context, const builder::Result &result, const utils::Typename &type, bool force);
     Maybe<builder::Result> makeConvertExprArrayToUnboundedRef(
         const Context &context, const builder::Result &result, const utils::Typename &type, bool force);
     Maybe<builder::Result> makeConvertRefToAnyRef(
@@ -104,6 +114,10 @@ namespace kara::builder::ops::handlers {
     Maybe<builder::Result> makeDereferenceWithOptional(const Context &context, const builder::Result &value);
     Maybe<builder::Result> makeMoveWithUnique(const Context &context, const builder::Result &value);
     Maybe<builder::Result> makeMoveWithVariableArray(const Context &context, const builder::Result &value);
+    Maybe<builder::Result> makeMoveWithMap(const Context &context, const builder::Result &value);
+    Maybe<builder::Result> makeMoveWithTuple(const Context &context, const builder::Result &value);
+    Maybe<builder::Result> makeMoveWithVariant(const Context &context, const builder::Result &value);
+    Maybe<builder::Result> makeMoveWithClosure(const Context &context, const builder::Result &value);
 
     Maybe<builder::Result> makeAddNumber(
         const Context &context, const builder::Result &left, const builder::Result &right);
@@ -119,9 +133,13 @@ namespace kara::builder::ops::handlers {
     Maybe<builder::Result> makeEQNumber(
         const Context &context, const builder::Result &left, const builder::Result &right);
     Maybe<builder::Result> makeEQRef(const Context &context, const builder::Result &left, const builder::Result &right);
+    Maybe<builder::Result> makeEQEnum(
+        const Context &context, const builder::Result &left, const builder::Result &right);
     Maybe<builder::Result> makeNENumber(
         const Context &context, const builder::Result &left, const builder::Result &right);
     Maybe<builder::Result> makeNERef(const Context &context, const builder::Result &left, const builder::Result &right);
+    Maybe<builder::Result> makeNEEnum(
+        const Context &context, const builder::Result &left, const builder::Result &right);
     Maybe<builder::Result> makeGTNumber(
         const Context &context, const builder::Result &left, const builder::Result &right);
     Maybe<builder::Result> makeGENumber(
@@ -150,19 +168,36 @@ namespace kara::builder::ops::handlers {
         const Context &context, const builder::Result &value, const matching::MatchInput &input);
 
     // Marked as taking builder::Result to avoid multiple infers... new solution maybe be needed in future
+    // Enum.Case, takes the unresolved enum name since an enum is never a value by itself
+    Maybe<builder::Wrapped> makeDotForEnumCase(
+        const Context &context, const builder::Unresolved &value, const parser::Reference *node);
     Maybe<builder::Wrapped> makeDotForField(
         const Context &context, const builder::Result &value, const parser::Reference *node);
+    Maybe<builder::Wrapped> makeDotForTupleElement(
+        const Context &context, const builder::Result &value, const parser::Reference *node);
     Maybe<builder::Wrapped> makeDotForUFCS(
         const Context &context, const builder::Result &value, const parser::Reference *node);
 
     bool makeInitializeNumber(const Context &context, llvm::Value *ptr, const utils::Typename &type);
+    bool makeInitializeEnum(const Context &context, llvm::Value *ptr, const utils::Typename &type);
     bool makeInitializeReference(const Context &context, llvm::Value *ptr, const utils::Typename &type);
+    bool makeInitializeClosure(const Context &context, llvm::Value *ptr, const utils::Typename &type);
     bool makeInitializeVariableArray(const Context &context, llvm::Value *ptr, const utils::Typename &type);
+    bool makeInitializeFixedArray(const Context &context, llvm::Value *ptr, const utils::Typename &type);
+    bool makeInitializeMap(const Context &context, llvm::Value *ptr, const utils::Typename &type);
     bool makeInitializeStruct(const Context &context, llvm::Value *ptr, const utils::Typename &type);
+    bool makeInitializeTuple(const Context &context, llvm::Value *ptr, const utils::Typename &type);
+    bool makeInitializeVariant(const Context &context, llvm::Value *ptr, const utils::Typename &type);
+    bool makeInitializeOptional(const Context &context, llvm::Value *ptr, const utils::Typename &type);
     bool makeInitializeIgnore(const Context &context, llvm::Value *ptr, const utils::Typename &type);
 
     bool makeDestroyReference(const Context &context, llvm::Value *ptr, const utils::Typename &type); // block it
     bool makeDestroyUnique(const Context &context, llvm::Value *ptr, const utils::Typename &type);
+    bool makeDestroyShared(const Context &context, llvm::Value *ptr, const utils::Typename &type);
     bool makeDestroyVariableArray(const Context &context, llvm::Value *ptr, const utils::Typename &type);
+    bool makeDestroyMap(const Context &context, llvm::Value *ptr, const utils::Typename &type);
+    bool makeDestroyTuple(const Context &context, llvm::Value *ptr, const utils::Typename &type);
+    bool makeDestroyVariant(const Context &context, llvm::Value *ptr, const utils::Typename &type);
+    bool makeDestroyClosure(const Context &context, llvm::Value *ptr, const utils::Typename &type);
     bool makeDestroyRegular(const Context &context, llvm::Value *ptr, const utils::Typename &type);
 }
\ No newline at end of file
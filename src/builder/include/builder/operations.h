@@ -19,7 +19,7 @@ namespace kara::builder::ops {
     }
 
     template <typename... Args>
-    void die(const char *format, Args &&...args) {
+    [[noreturn]] void die(const char *format, Args &&...args) {
         throw std::runtime_error(fmt::format(format, std::forward<Args>(args)...));
     }
 
@@ -76,7 +76,61 @@ namespace kara::builder::ops {
     builder::Result makeRealType(const Context &context, const Result &result);
 
     llvm::Value *makeAlloca(const Context &context, const utils::Typename &type, const std::string &name = "");
-    llvm::Value *makeMalloc(const Context &context, const utils::Typename &type, const std::string &name = "");
+    llvm::Value *makeMalloc(
+        const Context &context, const utils::Typename &type, const std::string &name = "", bool zeroed = false);
+    // [T:expr] local, stack allocated up to options.stackArrayLimit bytes, released when the current scope exits
+    // elements are initialized here and destroyed on release
+    llvm::Value *makeStackArray(const Context &context, const utils::ArrayTypename &type, const std::string &name = "");
+    // runs makeInitialize over size elements of type starting at data, a memset if they start out as zero
+    void makeInitializeElements(
+        const Context &context, llvm::Value *data, llvm::Value *size, const utils::Typename &type);
+
+    // i8 * based, type is the element type for alignment, size is in bytes and can be 0 if unknown on deallocate
+    llvm::Value *makeAllocate(const Context &context, llvm::Value *size, llvm::Type *type);
+    // calloc, or allocate and memset when going through options.allocator
+    llvm::Value *makeAllocateZeroed(const Context &context, llvm::Value *size, llvm::Type *type);
+    void makeDeallocate(const Context &context, llvm::Value *pointer, llvm::Value *size, llvm::Type *type);
+    llvm::Value *makeReallocate(
+        const Context &context, llvm::Value *pointer, llvm::Value *oldSize, llvm::Value *newSize, llvm::Type *type);
+
+    // ptr points to a VariableSize, Hybrid or Iterable array struct, returns a pointer to the first element
+    llvm::Value *makeArrayData(const Context &context, llvm::Value *ptr, const utils::ArrayTypename &type);
+    // {first element, size} for an array value that knows its length, nullopt for [T]
+    std::optional<std::pair<llvm::Value *, llvm::Value *>> makeArraySpan(
+        const Context &context, const builder::Result &value);
+    // reallocates storage to fit capacity elements and updates capacity, Hybrid arrays move inline if capacity fits
+    void makeArrayReserve(
+        const Context &context, llvm::Value *ptr, const utils::ArrayTypename &type, llvm::Value *capacity);
+
+    // ptr points to a VariableSize or Hybrid array, destroys its elements and leaves size and storage as is
+    void makeArrayDestroyElements(const Context &context, llvm::Value *ptr, const utils::ArrayTypename &type);
+
+    // ptr points to a [K -> V], destroys the value in every full slot and leaves the table as is
+    void makeMapDestroyValues(const Context &context, llvm::Value *ptr, const utils::MapTypename &type);
+
+    // pointer is the value of a non-null *shared T, returns a pointer to the {count, T} block holding it
+    llvm::Value *makeSharedBlock(const Context &context, llvm::Value *pointer, const utils::Typename &type);
+    // adds delta to the count, atomically unless options.nonAtomicShared, returns the count from before
+    llvm::Value *makeSharedCountAdd(
+        const Context &context, llvm::Value *pointer, const utils::Typename &type, int64_t delta);
+    // one more owner for pointer, does nothing if it is null, returns pointer
+    llvm::Value *makeSharedRetain(const Context &context, llvm::Value *pointer, const utils::Typename &type);
+
+    // ptr points to a ?T, these read the flag or the null niche depending on Builder::makeOptionalType
+    llvm::Value *makeOptionalHolds(const Context &context, llvm::Value *ptr, const utils::OptionalTypename &type);
+    llvm::Value *makeOptionalValue(const Context &context, llvm::Value *ptr, const utils::OptionalTypename &type);
+    // value is nullptr to store an empty optional
+    void makeOptionalStore(
+        const Context &context, llvm::Value *ptr, const utils::OptionalTypename &type, llvm::Value *value);
+
+    // ptr points to a variant, the tag is the index of the alternative being held
+    llvm::Value *makeVariantTag(const Context &context, llvm::Value *ptr, const utils::VariantTypename &type);
+    // pointer to the storage for alternative index, only valid to read while that alternative is held
+    llvm::Value *makeVariantValue(
+        const Context &context, llvm::Value *ptr, const utils::VariantTypename &type, size_t index);
+    // switches to alternative index without destroying the old one, value is stored as is
+    void makeVariantStore(const Context &context, llvm::Value *ptr, const utils::VariantTypename &type, size_t index,
+        llvm::Value *value);
 
     std::optional<builder::Result> makeConvert(
         const Context &context, const builder::Result &value, const utils::Typename &type, bool force = false);
@@ -93,10 +147,18 @@ namespace kara::builder::ops {
         builder::Result makeSpecial(const Context &context, utils::SpecialType type);
         builder::Result makeBool(const Context &context, bool value);
         builder::Result makeNumber(const Context &context, const utils::NumberValue &value);
+        // inserts are {offset into text, value}, in order, any inserts make a heap allocated *[byte:]
         builder::Result makeString(const Context &context, const std::string &text,
-            const std::unordered_map<size_t, builder::Result> &inserts = {});
+            const std::vector<std::pair<size_t, builder::Result>> &inserts = {});
         builder::Result makeArray(const Context &context, const std::vector<builder::Result> &values);
-        builder::Result makeNew(const Context &context, const utils::Typename &type);
+        // built as a value with insertvalue, values are passed into the tuple
+        builder::Result makeTuple(const Context &context, const std::vector<builder::Result> &values);
+        // initialize is false when the caller overwrites the whole value right after
+        // shared allocates the count alongside the value and returns *shared T instead of *T
+        builder::Result makeNew(
+            const Context &context, const utils::Typename &type, bool initialize = true, bool shared = false);
+        // {function, environment}, captured variables are copied into an environment allocated like new
+        builder::Result makeClosure(const Context &context, const parser::Lambda *node);
     }
 
     namespace unary {
@@ -197,10 +259,15 @@ namespace kara::builder::ops {
 
         void makeIf(const Context &context, const parser::If *node);
         void makeFor(const Context &context, const parser::For *node);
+        // variants switch on the tag and bind what each arm holds, values switch or compare with == arm by arm
+        void makeMatch(const Context &context, const parser::Match *node);
         void makeBlock(const Context &context, const parser::Block *node);
         void makeAssign(const Context &context, const parser::Assign *node);
         void makeStatement(const Context &context, const parser::Statement *node);
 
+        // one variable per name, each holds an element of the tuple value
+        std::vector<std::unique_ptr<builder::Variable>> makeUnpack(const Context &context, const parser::Unpack *node);
+
         using Destinations = std::unordered_map<builder::ExitPoint, llvm::BasicBlock *>;
 
         llvm::BasicBlock *makeScope(const Context &context, const parser::Code *node, const Destinations &destinations);
@@ -3,11 +3,13 @@
 #include <builder/error.h>
 #include <builder/target.h>
 #include <builder/manager.h>
+#include <builder/operations.h>
 #include <builder/platform.h>
 
 #include <cstdlib>
 #include <parser/expression.h>
 #include <parser/function.h>
+#include <parser/literals.h>
 #include <parser/type.h>
 #include <parser/variable.h>
 
@@ -44,6 +46,192 @@ namespace kara::builder {
         }
     }
 
+    builder::Enum *Builder::makeEnum(const parser::Enum *node) {
+        auto iterator = enums.find(node);
+
+        if (iterator != enums.end())
+            return iterator->second.get();
+
+        auto result = std::make_unique<builder::Enum>(node, *this);
+        auto pointer = result.get();
+
+        enums[node] = std::move(result);
+
+        return pointer;
+    }
+
+    builder::Map *Builder::makeMap(const utils::MapTypename &type) {
+        auto iterator = std::find_if(maps.begin(), maps.end(), [&type](const auto &map) { return map->type == type; });
+
+        if (iterator == maps.end()) {
+            maps.push_back(std::make_unique<builder::Map>(type, *this));
+
+            return maps.back().get();
+        } else {
+            return iterator->get();
+        }
+    }
+
+    llvm::Constant *Builder::makeStringConstant(const std::string &text) {
+        auto iterator = strings.find(text);
+
+        if (iterator != strings.end())
+            return iterator->second;
+
+        llvm::Constant *initial = llvm::ConstantDataArray::getString(context, text);
+
+        std::string convertedText(std::min(text.size(), size_t(32)), '.');
+
+        std::transform(text.begin(), text.begin() + convertedText.size(), convertedText.begin(),
+            [](char c) { return (std::isalpha(c) || std::isdigit(c)) ? c : '_'; });
+
+        auto variable = new llvm::GlobalVariable(*module, initial->getType(), true,
+            llvm::GlobalVariable::LinkageTypes::PrivateLinkage, initial, fmt::format("str_{}", convertedText));
+
+        // lets llvm put it in a mergeable .rodata.str section, the linker folds copies from other objects
+        variable->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+        variable->setAlignment(llvm::Align(1));
+
+        auto zero = llvm::ConstantInt::get(llvm::Type::getInt64Ty(context), 0);
+        auto pointer = llvm::ConstantExpr::getInBoundsGetElementPtr(initial->getType(), variable,
+            llvm::ArrayRef<llvm::Constant *> { zero, zero });
+
+        strings[text] = pointer;
+
+        return pointer;
+    }
+
+    llvm::Function *Builder::makeElementDestructor(const utils::Typename &type) {
+        if (!needsDestroy(type))
+            return nullptr;
+
+        auto iterator = std::find_if(elementDestructors.begin(), elementDestructors.end(),
+            [&type](const auto &destructor) { return destructor.first == type; });
+
+        if (iterator != elementDestructors.end())
+            return iterator->second->function;
+
+        auto elementType = makeTypename(type);
+        auto sizeType = llvm::Type::getInt64Ty(context);
+
+        auto functionType = llvm::FunctionType::get(
+            llvm::Type::getVoidTy(context), { llvm::PointerType::get(elementType, 0), sizeType }, false);
+
+        auto function = llvm::Function::Create(functionType, llvm::GlobalVariable::InternalLinkage,
+            fmt::format("{}.destroy_elements", toString(type)), module.get());
+
+        function->addFnAttr(llvm::Attribute::NoUnwind);
+
+        elementDestructors.emplace_back(type, std::make_unique<builder::Function>(function, *this));
+
+        auto destructor = elementDestructors.back().second.get();
+
+        auto data = function->getArg(0);
+        auto size = function->getArg(1);
+
+        data->setName("data");
+        size->setName("size");
+
+        destructor->entryBlock = llvm::BasicBlock::Create(context, "entry", function);
+
+        auto loopBlock = llvm::BasicBlock::Create(context, "loop", function);
+        auto doneBlock = llvm::BasicBlock::Create(context, "done", function);
+
+        destructor->entry.SetInsertPoint(destructor->entryBlock);
+
+        llvm::IRBuilder<> loop(loopBlock);
+
+        auto index = loop.CreatePHI(sizeType, 2, "index");
+        index->addIncoming(llvm::ConstantInt::get(sizeType, 0), destructor->entryBlock);
+
+        ops::Context loopContext { *this, nullptr, &loop, nullptr, destructor, nullptr };
+
+        // may branch, the back edge comes from wherever the destroy left off
+        ops::makeDestroy(loopContext, loop.CreateInBoundsGEP(elementType, data, index), type);
+
+        auto next = loop.CreateAdd(index, llvm::ConstantInt::get(sizeType, 1));
+        index->addIncoming(next, loop.GetInsertBlock());
+
+        loop.CreateCondBr(loop.CreateICmpULT(next, size), loopBlock, doneBlock);
+
+        // after the body so allocas made while destroying stay ahead of the branch
+        destructor->entry.CreateCondBr(
+            destructor->entry.CreateICmpEQ(size, llvm::ConstantInt::get(sizeType, 0)), doneBlock, loopBlock);
+
+        llvm::IRBuilder<>(doneBlock).CreateRetVoid();
+
+        return function;
+    }
+
+    llvm::Function *Builder::makeVariantDestructor(const utils::VariantTypename &type) {
+        if (!needsDestroy(type))
+            return nullptr;
+
+        auto iterator = std::find_if(variantDestructors.begin(), variantDestructors.end(),
+            [&type](const auto &destructor) { return destructor.first == utils::Typename(type); });
+
+        if (iterator != variantDestructors.end())
+            return iterator->second->function;
+
+        auto variantType = makeTypename(type);
+        auto tagType = makeVariantTagType(type);
+
+        auto functionType = llvm::FunctionType::get(
+            llvm::Type::getVoidTy(context), { llvm::PointerType::get(variantType, 0) }, false);
+
+        auto function = llvm::Function::Create(functionType, llvm::GlobalVariable::InternalLinkage,
+            fmt::format("{}.destroy", toString(type)), module.get());
+
+        function->addFnAttr(llvm::Attribute::NoUnwind);
+
+        variantDestructors.emplace_back(type, std::make_unique<builder::Function>(function, *this));
+
+        auto destructor = variantDestructors.back().second.get();
+
+        auto value = function->getArg(0);
+        value->setName("value");
+
+        destructor->entryBlock = llvm::BasicBlock::Create(context, "entry", function);
+
+        auto doneBlock = llvm::BasicBlock::Create(context, "done", function);
+
+        destructor->entry.SetInsertPoint(destructor->entryBlock);
+
+        ops::Context entryContext { *this, nullptr, &destructor->entry, nullptr, destructor, nullptr };
+
+        auto tag = ops::makeVariantTag(entryContext, value, type);
+
+        std::vector<std::pair<llvm::ConstantInt *, llvm::BasicBlock *>> cases;
+
+        for (size_t a = 0; a < type.alternatives.size(); a++) {
+            const auto &alternative = type.alternatives[a];
+
+            if (!needsDestroy(alternative))
+                continue;
+
+            auto block = llvm::BasicBlock::Create(context, "alternative", function, doneBlock);
+
+            llvm::IRBuilder<> destroy(block);
+            ops::Context destroyContext { *this, nullptr, &destroy, nullptr, destructor, nullptr };
+
+            ops::makeDestroy(destroyContext, ops::makeVariantValue(destroyContext, value, type, a), alternative);
+
+            destroy.CreateBr(doneBlock);
+
+            cases.emplace_back(llvm::ConstantInt::get(tagType, a), block);
+        }
+
+        // after the cases so allocas made while destroying stay ahead of the switch
+        auto switchInst = destructor->entry.CreateSwitch(tag, doneBlock, cases.size());
+
+        for (auto [index, block] : cases)
+            switchInst->addCase(index, block);
+
+        llvm::IRBuilder<>(doneBlock).CreateRetVoid();
+
+        return function;
+    }
+
     builder::Variable *Builder::makeGlobal(const parser::Variable *node) {
         auto iterator = globals.find(node);
 
@@ -76,6 +264,106 @@ namespace kara::builder {
         }
     }
 
+    builder::Function *Builder::makeInstantiation(const parser::Function *node, const Generics &generics) {
+        auto iterator = std::find_if(instantiations.begin(), instantiations.end(), [&](const auto &instantiation) {
+            return instantiation->node == node && instantiation->generics == generics;
+        });
+
+        if (iterator != instantiations.end())
+            return iterator->get();
+
+        auto ptr = std::make_unique<builder::Function>(node, *this);
+
+        builder::Function *result = ptr.get();
+        result->generics = generics;
+
+        instantiations.push_back(std::move(ptr));
+
+        instantiating.emplace_back(node, generics);
+        result->build();
+        instantiating.pop_back();
+
+        return result;
+    }
+
+    builder::Function *Builder::makeLambda(
+        const parser::Lambda *node, const builder::Function *parent, const builder::Cache &scope) {
+        auto key = std::make_pair(node, parent);
+        auto iterator = lambdas.find(key);
+
+        if (iterator != lambdas.end())
+            return iterator->second.get();
+
+        auto ptr = std::make_unique<builder::Function>(node, *this);
+
+        builder::Function *result = ptr.get();
+        lambdas[key] = std::move(ptr);
+
+        auto isInside = [node](const hermes::Node *value) {
+            for (auto current = value; current; current = current->parent) {
+                if (current == node)
+                    return true;
+            }
+
+            return false;
+        };
+
+        // every name inside, nested lambdas included, that resolves to a local of an enclosing function
+        std::unordered_set<const parser::Variable *> seen;
+        std::vector<const hermes::Node *> pending = { node };
+
+        while (!pending.empty()) {
+            auto current = pending.back();
+            pending.pop_back();
+
+            for (auto it = current->children.rbegin(); it != current->children.rend(); ++it)
+                pending.push_back(it->get());
+
+            // the name after a dot is a field
+            if (!current->is(parser::Kind::Reference) || current->parent->is(parser::Kind::Dot))
+                continue;
+
+            auto references = findAll(current->as<parser::Reference>());
+
+            auto isVariable = [](const hermes::Node *n) { return n->is(parser::Kind::Variable); };
+            auto variable = std::find_if(references.begin(), references.end(), isVariable);
+
+            if (variable == references.end())
+                continue;
+
+            auto var = (*variable)->as<parser::Variable>();
+
+            if (var->parent->is(parser::Kind::Root) || isInside(var) || !seen.insert(var).second)
+                continue;
+
+            auto info = scope.find(&Cache::variables, var);
+
+            if (!info)
+                throw VerifyError(current, "Cannot find variable reference.");
+
+            // captures are copied in, a copy of something that owns memory would be destroyed twice
+            if (needsDestroy(info->type)) {
+                throw VerifyError(current, "Cannot capture {} of type {}, capture a reference to it instead.",
+                    var->name, toString(info->type));
+            }
+
+            result->captures.emplace_back(var, info->type);
+        }
+
+        if (!result->captures.empty()) {
+            std::vector<llvm::Type *> fields(result->captures.size());
+
+            std::transform(result->captures.begin(), result->captures.end(), fields.begin(),
+                [this](const auto &capture) { return makeTypename(capture.second); });
+
+            result->environment = llvm::StructType::get(context, fields);
+        }
+
+        result->build();
+
+        return result;
+    }
+
     llvm::Function *Builder::getMalloc() {
         auto existing = module->getFunction("malloc");
 
@@ -110,6 +398,23 @@ namespace kara::builder {
         return freeCache;
     }
 
+    llvm::Function *Builder::getCalloc() {
+        auto existing = module->getFunction("calloc");
+
+        if (existing)
+            return existing;
+
+        if (!callocCache) {
+            auto sizeType = llvm::Type::getInt64Ty(context);
+            auto type = llvm::FunctionType::get(llvm::Type::getInt8PtrTy(context), { sizeType, sizeType }, false);
+
+            callocCache = llvm::Function::Create(
+                type, llvm::GlobalVariable::LinkageTypes::ExternalLinkage, options.calloc, *module);
+        }
+
+        return callocCache;
+    }
+
     llvm::Function *Builder::getRealloc() {
         // needs naming handled by builder
         auto existing = module->getFunction("realloc");
@@ -128,9 +433,75 @@ namespace kara::builder {
         return reallocCache;
     }
 
-    llvm::StructType *Builder::makeOptionalType(const utils::Typename &type) {
+    llvm::Function *Builder::getAllocate() {
+        assert(!options.allocator.empty());
+
+        if (!allocateCache) {
+            auto sizeType = llvm::Type::getInt64Ty(context);
+            auto type = llvm::FunctionType::get(llvm::Type::getInt8PtrTy(context), { sizeType, sizeType }, false);
+
+            auto name = fmt::format("{}_allocate", options.allocator);
+
+            allocateCache = module->getFunction(name);
+
+            if (!allocateCache) {
+                allocateCache = llvm::Function::Create(
+                    type, llvm::GlobalVariable::LinkageTypes::ExternalLinkage, name, *module);
+            }
+        }
+
+        return allocateCache;
+    }
+
+    llvm::Function *Builder::getDeallocate() {
+        assert(!options.allocator.empty());
+
+        if (!deallocateCache) {
+            auto sizeType = llvm::Type::getInt64Ty(context);
+            auto type = llvm::FunctionType::get(
+                llvm::Type::getVoidTy(context), { llvm::Type::getInt8PtrTy(context), sizeType, sizeType }, false);
+
+            auto name = fmt::format("{}_deallocate", options.allocator);
+
+            deallocateCache = module->getFunction(name);
+
+            if (!deallocateCache) {
+                deallocateCache = llvm::Function::Create(
+                    type, llvm::GlobalVariable::LinkageTypes::ExternalLinkage, name, *module);
+            }
+        }
+
+        return deallocateCache;
+    }
+
+    llvm::Function *Builder::getReallocate() {
+        assert(!options.allocator.empty());
+
+        if (!reallocateCache) {
+            auto sizeType = llvm::Type::getInt64Ty(context);
+            auto dataType = llvm::Type::getInt8PtrTy(context);
+            auto type = llvm::FunctionType::get(dataType, { dataType, sizeType, sizeType, sizeType }, false);
+
+            auto name = fmt::format("{}_reallocate", options.allocator);
+
+            reallocateCache = module->getFunction(name);
+
+            if (!reallocateCache) {
+                reallocateCache = llvm::Function::Create(
+                    type, llvm::GlobalVariable::LinkageTypes::ExternalLinkage, name, *module);
+            }
+        }
+
+        return reallocateCache;
+    }
+
+    llvm::Type *Builder::makeOptionalType(const utils::Typename &type) {
         llvm::Type *subtype = makeTypename(type);
 
+        // null, or an unused enum value, means empty
+        if (makeNiche(type))
+            return subtype;
+
         auto holdsType = llvm::Type::getInt1Ty(context);
 
         /*
@@ -143,6 +514,39 @@ namespace kara::builder {
         return llvm::StructType::get(context, { holdsType, subtype });
     }
 
+    llvm::IntegerType *Builder::makeVariantTagType(const utils::VariantTypename &type) {
+        auto count = type.alternatives.size();
+
+        return llvm::IntegerType::get(context, count <= 0x100 ? 8 : count <= 0x10000 ? 16 : 32);
+    }
+
+    llvm::Type *Builder::makeVariantType(const utils::VariantTypename &type) {
+        if (auto niche = variantNiche(type))
+            return makeTypename(type.alternatives[*niche]);
+
+        uint64_t size = 0;
+        uint64_t align = 1;
+
+        for (const auto &alternative : type.alternatives) {
+            auto llvmType = makeTypename(alternative);
+
+            size = std::max(size, target.layout->getTypeAllocSize(llvmType).getFixedSize());
+            align = std::max(align, target.layout->getABITypeAlign(llvmType).value());
+        }
+
+        /*
+         * struct VariantType {
+         *   iAlign payload[size / align]; // big enough for every alternative
+         *   iN tag;
+         * }
+         */
+
+        auto unit = llvm::IntegerType::get(context, align * 8);
+        auto payload = llvm::ArrayType::get(unit, (size + align - 1) / align);
+
+        return llvm::StructType::get(context, { payload, makeVariantTagType(type) });
+    }
+
     llvm::StructType *Builder::makeVariableArrayType(const utils::Typename &type) {
         llvm::Type *subtype = makeTypename(type);
 
@@ -160,6 +564,66 @@ namespace kara::builder {
         return llvm::StructType::get(context, { sizeType, sizeType, pointerType });
     }
 
+    llvm::StructType *Builder::makeHybridArrayType(const utils::Typename &type, size_t size) {
+        llvm::Type *subtype = makeTypename(type);
+
+        auto sizeType = llvm::Type::getInt64Ty(context);
+        auto pointerType = llvm::PointerType::get(subtype, 0);
+        auto storageType = llvm::ArrayType::get(subtype, size);
+
+        /*
+         * struct HybridArrayOfInts {
+         *   size_t size;
+         *   size_t capacity; // <= 50 means elements live in storage and data is null
+         *   int *data;
+         *   int storage[50];
+         * };
+         */
+
+        return llvm::StructType::get(context, { sizeType, sizeType, pointerType, storageType });
+    }
+
+    llvm::StructType *Builder::makeIterableArrayType(const utils::Typename &type) {
+        llvm::Type *subtype = makeTypename(type);
+
+        auto sizeType = llvm::Type::getInt64Ty(context);
+        auto pointerType = llvm::PointerType::get(subtype, 0);
+
+        /*
+         * struct IterableArrayOfInts {
+         *   size_t size;
+         *   int *data; // not owned
+         * };
+         */
+
+        return llvm::StructType::get(context, { sizeType, pointerType });
+    }
+
+    llvm::StructType *Builder::makeSharedType(const utils::Typename &type) {
+        auto sizeType = llvm::Type::getInt64Ty(context);
+
+        /*
+         * struct SharedInt {
+         *   size_t count;
+         *   int value; // *shared int points here
+         * };
+         */
+
+        return llvm::StructType::get(context, { sizeType, makeTypename(type) });
+    }
+
+    const std::string &Builder::declaringPath(const hermes::Node *node) {
+        while (node->parent)
+            node = node->parent;
+
+        for (auto dependency : dependencies) {
+            if (dependency->root.get() == node)
+                return dependency->path;
+        }
+
+        return file.path;
+    }
+
     const hermes::Node *Builder::lookupDestroy(const utils::Typename &type) {
         std::string name;
 
@@ -189,7 +653,19 @@ namespace kara::builder {
                 auto base = builder.makeType(type.type); // cycle?
                 return builder.lookupDestroy(type) || base->implicitDestructor; // might need some better checking here
             }
-            bool operator()(const utils::ArrayTypename &type) { return type.kind == utils::ArrayKind::VariableSize; }
+            bool operator()(const utils::EnumTypename &) { return false; }
+            bool operator()(const utils::ArrayTypename &type) {
+                return type.kind == utils::ArrayKind::VariableSize || type.kind == utils::ArrayKind::Hybrid;
+            }
+            bool operator()(const utils::MapTypename &type) { return true; }
+            bool operator()(const utils::TupleTypename &type) {
+                return std::any_of(type.elements.begin(), type.elements.end(),
+                    [this](const auto &element) { return builder.needsDestroy(element); });
+            }
+            bool operator()(const utils::VariantTypename &type) {
+                return std::any_of(type.alternatives.begin(), type.alternatives.end(),
+                    [this](const auto &alternative) { return builder.needsDestroy(alternative); });
+            }
             bool operator()(const utils::FunctionTypename &type) { return type.kind == utils::FunctionKind::Regular; }
             bool operator()(const utils::OptionalTypename &type) {
                 return builder.needsDestroy(*type.value); // ?
@@ -201,6 +677,80 @@ namespace kara::builder {
         return std::visit(visitor, type);
     }
 
+    bool Builder::initializesToZero(const utils::Typename &type) {
+        struct {
+            Builder &builder;
+
+            bool operator()(const utils::NamedTypename &type) {
+                auto fields = type.type->fields();
+
+                return std::all_of(fields.begin(), fields.end(), [this](auto field) {
+                    return !field->hasFixedType
+                        || builder.initializesToZero(builder.resolveTypename(field->fixedType()));
+                });
+            }
+            bool operator()(const utils::EnumTypename &type) { return builder.makeEnum(type.type)->initial->isZero(); }
+            bool operator()(const utils::ArrayTypename &type) {
+                if (type.kind == utils::ArrayKind::FixedSize)
+                    return builder.initializesToZero(*type.value);
+
+                return type.kind != utils::ArrayKind::Hybrid; // capacity starts at the inline size
+            }
+            bool operator()(const utils::MapTypename &) { return true; }
+            bool operator()(const utils::TupleTypename &type) {
+                return std::all_of(type.elements.begin(), type.elements.end(),
+                    [this](const auto &element) { return builder.initializesToZero(element); });
+            }
+            // starts out holding the first alternative, or the empty one for a niche
+            bool operator()(const utils::VariantTypename &type) {
+                if (auto niche = builder.variantNiche(type))
+                    return builder.makeNiche(type.alternatives[*niche])->isNullValue();
+
+                return builder.initializesToZero(type.alternatives.front());
+            }
+            bool operator()(const utils::FunctionTypename &) { return true; }
+            // a cleared flag, or a niche that happens to be zero
+            bool operator()(const utils::OptionalTypename &type) {
+                auto niche = builder.makeNiche(*type.value);
+
+                return !niche || niche->isNullValue();
+            }
+            bool operator()(const utils::PrimitiveTypename &) { return true; }
+            bool operator()(const utils::ReferenceTypename &) { return true; }
+        } visitor { *this };
+
+        return std::visit(visitor, type);
+    }
+
+    llvm::Constant *Builder::makeNiche(const utils::Typename &type) {
+        // *shared T points past its count, so it is null exactly when it holds nothing too
+        if (std::holds_alternative<utils::ReferenceTypename>(type))
+            return llvm::Constant::getNullValue(makeTypename(type));
+
+        if (auto enumType = std::get_if<utils::EnumTypename>(&type))
+            return makeEnum(enumType->type)->niche;
+
+        return nullptr;
+    }
+
+    std::optional<size_t> Builder::variantNiche(const utils::VariantTypename &type) {
+        if (type.alternatives.size() != 2)
+            return std::nullopt;
+
+        auto isNull = [](const utils::Typename &alternative) {
+            auto primitive = std::get_if<utils::PrimitiveTypename>(&alternative);
+
+            return primitive && primitive->type == utils::PrimitiveType::Null;
+        };
+
+        for (size_t a = 0; a < 2; a++) {
+            if (makeNiche(type.alternatives[a]) && isNull(type.alternatives[1 - a]))
+                return a;
+        }
+
+        return std::nullopt;
+    }
+
     Builder::Builder(const SourceFile &file, SourceManager &manager, const Target &target, const options::Options &opts)
         : root(file.root.get())
         , file(file)
@@ -226,7 +776,7 @@ namespace kara::builder {
 
             auto e = node->as<parser::Function>();
 
-            return e->name == "destroy" && e->parameterCount == 1;
+            return e->name == "destroy" && e->parameterCount == 1 && e->generics.empty();
         });
 
         destroyInvocables.reserve(destroyInvocablesRaw.size());
@@ -276,10 +826,20 @@ namespace kara::builder {
                 break;
             }
 
-            case parser::Kind::Function:
-                makeFunction(node->as<parser::Function>());
+            case parser::Kind::Enum:
+                makeEnum(node->as<parser::Enum>());
                 break;
 
+            case parser::Kind::Function: {
+                auto e = node->as<parser::Function>();
+
+                // generic functions are only built when called, see makeInstantiation
+                if (e->generics.empty())
+                    makeFunction(e);
+
+                break;
+            }
+
             default:
                 throw VerifyError(node.get(), "Cannot build this node in root.");
             }
@@ -0,0 +1,508 @@
+#include <builder/builder.h>
+
+#include <builder/error.h>
+#include <builder/handlers.h>
+#include <builder/operations.h>
+
+#include <parser/expression.h>
+#include <parser/function.h>
+#include <parser/literals.h>
+#include <parser/operator.h>
+#include <parser/type.h>
+#include <parser/variable.h>
+
+#include <cassert>
+
+namespace kara::builder {
+    namespace {
+        // deep enough for any table worth folding, shallow enough to catch runaway recursion
+        constexpr size_t maxConstantDepth = 512;
+
+        bool isGlobalConstant(const parser::Variable *variable) {
+            return variable->parent->is(parser::Kind::Root) && !variable->isMutable && !variable->isExternal;
+        }
+
+        // functions written as name(...) => expression, anything with statements is left to run
+        bool isFoldable(const parser::Function *function) {
+            return !function->isExtern && function->generics.empty()
+                && function->body()->is(parser::Kind::Expression);
+        }
+
+        // ?T, variants and array views only exist behind a reference to memory
+        bool needsStorage(const utils::Typename &type) {
+            if (std::holds_alternative<utils::OptionalTypename>(type))
+                return true;
+
+            if (std::holds_alternative<utils::VariantTypename>(type))
+                return true;
+
+            auto array = std::get_if<utils::ArrayTypename>(&type);
+
+            return array
+                && (array->kind == utils::ArrayKind::Iterable || array->kind == utils::ArrayKind::VariableSize);
+        }
+
+        // Walks an expression like ops::expression does, except every value is an llvm::Constant.
+        // Operators reuse ops::, their IRBuilder folds constant operands instead of inserting anything.
+        struct Evaluator {
+            Builder &builder;
+            const ops::Context &context;
+
+            // globals whose initializer is being folded, a cycle between them is reported instead of followed
+            std::unordered_set<const parser::Variable *> &globals;
+
+            // parameters of the function being folded, empty for the expression makeConstant was given
+            std::unordered_map<const parser::Variable *, builder::Result> parameters;
+
+            size_t depth = 0;
+
+            [[noreturn]] static void reject(const hermes::Node *node) {
+                throw VerifyError(node, "Expression cannot be evaluated at compile time.");
+            }
+
+            builder::Result check(const hermes::Node *node, const builder::Result &result) const {
+                if (!llvm::isa_and_nonnull<llvm::Constant>(result.value) || !context.ir->GetInsertBlock()->empty())
+                    reject(node);
+
+                if (llvm::isa<llvm::UndefValue>(result.value))
+                    throw VerifyError(node, "Expression has no defined value, it might divide by zero.");
+
+                return result;
+            }
+
+            builder::Result convert(const hermes::Node *node, const builder::Result &value,
+                const utils::Typename &type, bool force = false) {
+                // these conversions build the value in a stack slot, there is no function here to hold one
+                if (!(value.type == type) && needsStorage(type)) {
+                    throw VerifyError(node, "Converting type {} to type {} cannot be done at compile time.",
+                        toString(value.type), toString(type));
+                }
+
+                auto converted = ops::makeConvert(context, value, type, force);
+
+                if (!converted)
+                    throw VerifyError(node, "Cannot convert type {} to type {}.", toString(value.type), toString(type));
+
+                return check(node, *converted);
+            }
+
+            builder::Result global(const parser::Reference *node, const parser::Variable *variable) {
+                if (!isGlobalConstant(variable))
+                    throw VerifyError(node, "Variable {} cannot be read at compile time.", node->name);
+
+                if (!globals.insert(variable).second)
+                    throw VerifyError(node, "Global {} depends on its own value.", node->name);
+
+                std::optional<builder::Result> value;
+
+                if (variable->hasConstantValue)
+                    value = ops::nouns::makeNumber(context, variable->constantValue()->value);
+                else if (variable->hasInitialValue)
+                    value = evaluate(variable->value());
+                else
+                    throw VerifyError(variable, "All constant globals must be initialized with some value.");
+
+                if (variable->hasFixedType)
+                    value = convert(node, *value, builder.resolveTypename(variable->fixedType()));
+
+                globals.erase(variable);
+
+                return *value;
+            }
+
+            builder::Result noun(const hermes::Node *node) {
+                switch (node->is<parser::Kind>()) {
+                case parser::Kind::Number:
+                    return ops::nouns::makeNumber(context, node->as<parser::Number>()->value);
+
+                case parser::Kind::Bool:
+                    return ops::nouns::makeBool(context, node->as<parser::Bool>()->value);
+
+                case parser::Kind::Special:
+                    return check(node, ops::nouns::makeSpecial(context, node->as<parser::Special>()->type));
+
+                case parser::Kind::Parentheses: {
+                    auto e = node->as<parser::Parentheses>();
+
+                    if (e->children.size() != 1)
+                        reject(node);
+
+                    return evaluate(e->body());
+                }
+
+                case parser::Kind::Reference: {
+                    auto e = node->as<parser::Reference>();
+
+                    auto references = builder.findAll(e);
+
+                    auto isVariable = [](const hermes::Node *n) { return n->is(parser::Kind::Variable); };
+                    auto iterator = std::find_if(references.begin(), references.end(), isVariable);
+
+                    if (iterator == references.end())
+                        reject(node);
+
+                    auto variable = (*iterator)->as<parser::Variable>();
+
+                    auto parameter = parameters.find(variable);
+
+                    if (parameter != parameters.end())
+                        return parameter->second;
+
+                    return global(e, variable);
+                }
+
+                default:
+                    reject(node);
+                }
+            }
+
+            builder::Result construct(
+                const parser::Call *node, const parser::Type *type, const std::vector<builder::Result> &values) {
+                auto fields = type->fields();
+
+                std::vector<llvm::Constant *> elements(fields.size());
+
+                for (size_t a = 0; a < fields.size(); a++) {
+                    auto field = convert(node, values[a], builder.resolveTypename(fields[a]->fixedType()));
+
+                    elements[a] = llvm::cast<llvm::Constant>(field.value);
+                }
+
+                return builder::Result {
+                    builder::Result::FlagTemporary,
+                    llvm::ConstantStruct::get(builder.makeType(type)->type, elements),
+                    utils::NamedTypename { type->name, type },
+                    context.accumulator,
+                };
+            }
+
+            builder::Result invoke(const parser::Call *node, const parser::Function *function,
+                const std::vector<builder::Result> &values) {
+                if (!isFoldable(function)) {
+                    throw VerifyError(node, "Only functions written as {}(...) => value can be called at compile time.",
+                        function->name);
+                }
+
+                if (depth >= maxConstantDepth)
+                    throw VerifyError(node, "Compile time evaluation went deeper than {} calls.", maxConstantDepth);
+
+                Evaluator inner { builder, context, globals, {}, depth + 1 };
+
+                auto variables = function->parameters();
+
+                for (size_t a = 0; a < variables.size(); a++) {
+                    auto type = builder.resolveTypename(variables[a]->fixedType());
+
+                    inner.parameters.emplace(variables[a], convert(node, values[a], type));
+                }
+
+                auto result = inner.evaluate(function->body()->as<parser::Expression>());
+
+                if (function->hasFixedType)
+                    return convert(node, result, builder.resolveTypename(function->fixedType()));
+
+                return result;
+            }
+
+            builder::Result call(const utils::ExpressionOperation &operation) {
+                auto node = operation.op->as<parser::Call>();
+
+                auto callee = std::get_if<utils::ExpressionNoun>(operation.a.get());
+
+                if (!callee || !callee->content->is(parser::Kind::Reference))
+                    reject(node);
+
+                ops::matching::MatchInput input;
+                input.names = node->namesStripped();
+
+                for (auto parameter : node->parameters())
+                    input.parameters.push_back(evaluate(parameter));
+
+                const hermes::Node *pick = nullptr;
+                ops::matching::MatchResult picked;
+
+                size_t bet = SIZE_MAX;
+                bool ambiguous = false;
+
+                for (auto option : builder.findAll(callee->content->as<parser::Reference>())) {
+                    std::vector<const parser::Variable *> variables;
+
+                    if (option->is(parser::Kind::Function) && !option->as<parser::Function>()->isExtern
+                        && option->as<parser::Function>()->generics.empty())
+                        variables = option->as<parser::Function>()->parameters();
+                    else if (option->is(parser::Kind::Type) && !option->as<parser::Type>()->isAlias)
+                        variables = option->as<parser::Type>()->fields();
+                    else
+                        continue;
+
+                    auto result = ops::matching::match(builder, ops::matching::translate(builder, variables), input);
+
+                    if (result.failed)
+                        continue;
+
+                    if (result.numImplicit == bet) {
+                        ambiguous = true;
+                    } else if (result.numImplicit < bet) {
+                        bet = result.numImplicit;
+                        ambiguous = false;
+
+                        pick = option;
+                        picked = std::move(result);
+                    }
+                }
+
+                if (!pick)
+                    throw VerifyError(node, "No function or type matches these parameters at compile time.");
+
+                if (ambiguous)
+                    throw VerifyError(node, "Multiple functions match the most accurate conversion level, {}.", bet);
+
+                if (pick->is(parser::Kind::Type))
+                    return construct(node, pick->as<parser::Type>(), picked.map);
+
+                return invoke(node, pick->as<parser::Function>(), picked.map);
+            }
+
+            builder::Result dot(const utils::ExpressionOperation &operation) {
+                auto node = operation.op->as<parser::Dot>();
+
+                if (!node->children.front()->is(parser::Kind::Reference))
+                    reject(node);
+
+                auto reference = node->reference();
+
+                // Color.Red
+                if (auto noun = std::get_if<utils::ExpressionNoun>(operation.a.get())) {
+                    if (noun->content->is(parser::Kind::Reference)) {
+                        auto name = noun->content->as<parser::Reference>();
+
+                        auto unresolved = builder::Unresolved(name, builder.findAll(name), {});
+
+                        if (auto enumCase = ops::handlers::makeDotForEnumCase(context, unresolved, reference))
+                            return check(node, std::get<builder::Result>(*enumCase));
+                    }
+                }
+
+                // a field of a folded struct
+                auto value = evaluate(*operation.a);
+                auto named = std::get_if<utils::NamedTypename>(&value.type);
+
+                if (!named)
+                    reject(node);
+
+                auto fields = named->type->fields();
+
+                auto isField = [reference](auto field) { return field->name == reference->name; };
+                auto field = std::find_if(fields.begin(), fields.end(), isField);
+
+                if (field == fields.end())
+                    throw VerifyError(node, "Type {} has no field {}.", named->name, reference->name);
+
+                auto index = static_cast<unsigned>(std::distance(fields.begin(), field));
+
+                return builder::Result {
+                    builder::Result::FlagTemporary,
+                    llvm::cast<llvm::Constant>(value.value)->getAggregateElement(index),
+                    builder.resolveTypename((*field)->fixedType()),
+                    context.accumulator,
+                };
+            }
+
+            builder::Result operation(const utils::ExpressionOperation &operation) {
+                auto node = operation.op;
+
+                switch (node->is<parser::Kind>()) {
+                case parser::Kind::Unary: {
+                    auto value = evaluate(*operation.a);
+
+                    switch (node->as<parser::Unary>()->op) {
+                    case utils::UnaryOperation::Not:
+                        return check(node, ops::blame(node, ops::unary::makeNot, context, value));
+
+                    case utils::UnaryOperation::Negative:
+                        return check(node, ops::blame(node, ops::unary::makeNegative, context, value));
+
+                    default:
+                        reject(node);
+                    }
+                }
+
+                case parser::Kind::Ternary: {
+                    auto e = node->as<parser::Ternary>();
+
+                    auto typenameBool = utils::PrimitiveTypename { utils::PrimitiveType::Bool };
+                    auto condition = convert(node, evaluate(*operation.a), typenameBool);
+
+                    // only the side that is taken, the other is usually the end of a recursion
+                    auto taken = llvm::cast<llvm::Constant>(condition.value)->isOneValue() ? e->onTrue() : e->onFalse();
+
+                    return evaluate(taken);
+                }
+
+                case parser::Kind::As:
+                    return convert(
+                        node, evaluate(*operation.a), builder.resolveTypename(node->as<parser::As>()->type()), true);
+
+                case parser::Kind::Slash:
+                    return evaluate(*operation.a);
+
+                case parser::Kind::Call:
+                    return call(operation);
+
+                case parser::Kind::Dot:
+                    return dot(operation);
+
+                default:
+                    reject(node);
+                }
+            }
+
+            builder::Result combinator(const utils::ExpressionCombinator &combinator) {
+                auto left = evaluate(*combinator.a);
+                auto right = evaluate(*combinator.b);
+
+                auto node = combinator.op;
+
+                auto fold = [&](auto function) {
+                    return check(node, ops::blame(node, function, context, left, right));
+                };
+
+                switch (node->op) {
+                case utils::BinaryOperation::Add:
+                    return fold(ops::binary::makeAdd);
+                case utils::BinaryOperation::Sub:
+                    return fold(ops::binary::makeSub);
+                case utils::BinaryOperation::Mul:
+                    return fold(ops::binary::makeMul);
+                case utils::BinaryOperation::Div:
+                    return fold(ops::binary::makeDiv);
+                case utils::BinaryOperation::Mod:
+                    return fold(ops::binary::makeMod);
+                case utils::BinaryOperation::Equals:
+                    return fold(ops::binary::makeEQ);
+                case utils::BinaryOperation::NotEquals:
+                    return fold(ops::binary::makeNE);
+                case utils::BinaryOperation::Greater:
+                    return fold(ops::binary::makeGT);
+                case utils::BinaryOperation::GreaterEqual:
+                    return fold(ops::binary::makeGE);
+                case utils::BinaryOperation::Lesser:
+                    return fold(ops::binary::makeLT);
+                case utils::BinaryOperation::LesserEqual:
+                    return fold(ops::binary::makeLE);
+                case utils::BinaryOperation::Or:
+                    return fold(ops::binary::makeOr);
+                case utils::BinaryOperation::And:
+                    return fold(ops::binary::makeAnd);
+
+                default:
+                    reject(node);
+                }
+            }
+
+            builder::Result evaluate(const utils::ExpressionResult &result) {
+                struct {
+                    Evaluator &evaluator;
+
+                    builder::Result operator()(const utils::ExpressionNoun &result) {
+                        return evaluator.noun(result.content);
+                    }
+
+                    builder::Result operator()(const utils::ExpressionOperation &result) {
+                        return evaluator.operation(result);
+                    }
+
+                    builder::Result operator()(const utils::ExpressionCombinator &result) {
+                        return evaluator.combinator(result);
+                    }
+                } visitor { *this };
+
+                return std::visit(visitor, result);
+            }
+
+            builder::Result evaluate(const parser::Expression *node) { return evaluate(node->result); }
+        };
+    }
+
+    bool Builder::isConstant(const parser::Expression *node) {
+        std::vector<const hermes::Node *> pending = { node };
+
+        while (!pending.empty()) {
+            auto current = pending.back();
+            pending.pop_back();
+
+            for (const auto &child : current->children)
+                pending.push_back(child.get());
+
+            switch (current->is<parser::Kind>()) {
+            case parser::Kind::Expression:
+            case parser::Kind::Number:
+            case parser::Kind::Bool:
+            case parser::Kind::Special:
+            case parser::Kind::Parentheses:
+            case parser::Kind::Operator:
+            case parser::Kind::Unary:
+            case parser::Kind::Call:
+            case parser::Kind::CallParameterName:
+            case parser::Kind::Dot:
+            case parser::Kind::Ternary:
+            case parser::Kind::As:
+            case parser::Kind::Slash:
+                break;
+
+            case parser::Kind::Reference: {
+                // the name after a dot is a field or enum case
+                if (current->parent->is(parser::Kind::Dot))
+                    break;
+
+                auto references = findAll(current->as<parser::Reference>());
+
+                if (references.empty())
+                    return false;
+
+                auto reference = references.front();
+
+                if (reference->is(parser::Kind::Variable) && !isGlobalConstant(reference->as<parser::Variable>()))
+                    return false;
+
+                if (reference->is(parser::Kind::Function) && !isFoldable(reference->as<parser::Function>()))
+                    return false;
+
+                break;
+            }
+
+            default: {
+                // typenames under As are fine, anything else only exists at runtime
+                // stop at node, an As outside of the expression being checked does not count
+                bool underAs = false;
+
+                for (auto parent = current; parent != node && !underAs; parent = parent->parent)
+                    underAs = parent->parent->is(parser::Kind::As);
+
+                if (underAs)
+                    break;
+
+                return false;
+            }
+            }
+        }
+
+        return true;
+    }
+
+    builder::Result Builder::makeConstant(const parser::Expression *node, const std::optional<utils::Typename> &type) {
+        // every operand is a constant, so the IRBuilder folds instead of inserting into this block
+        std::unique_ptr<llvm::BasicBlock> scratch(llvm::BasicBlock::Create(context));
+        llvm::IRBuilder<> ir(scratch.get());
+
+        ops::Context constantContext = { *this, nullptr, &ir };
+
+        std::unordered_set<const parser::Variable *> globals;
+
+        Evaluator evaluator { *this, constantContext, globals };
+
+        auto result = evaluator.evaluate(node);
+
+        return type ? evaluator.convert(node, result, *type) : result;
+    }
+}
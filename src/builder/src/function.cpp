@@ -13,32 +13,117 @@
 #include <parser/type.h>
 #include <parser/variable.h>
 
+#include <llvm/IR/Verifier.h>
+#include <llvm/Support/xxhash.h>
+#include <llvm/Transforms/Utils/ModuleUtils.h>
+
+#include <algorithm>
 #include <map>
 #include <cassert>
 
 namespace kara::builder {
+    namespace {
+        struct Signature {
+            std::vector<const parser::Variable *> parameters;
+
+            const hermes::Node *fixedType = nullptr;
+            const hermes::Node *body = nullptr;
+        };
+
+        Signature signatureOf(const hermes::Node *node) {
+            if (node->is(parser::Kind::Lambda)) {
+                auto e = node->as<parser::Lambda>();
+
+                return { e->parameters(), e->fixedType(), e->body() };
+            }
+
+            auto e = node->as<parser::Function>();
+
+            return { e->parameters(), e->fixedType(), e->body() };
+        }
+
+        // collects the file declaring every type and enum a typename names, two files can each have a Point
+        struct DeclarationCollector {
+            Builder &builder;
+            std::vector<std::string> &paths;
+
+            void operator()(const utils::NamedTypename &type) {
+                if (type.type)
+                    paths.push_back(builder.declaringPath(type.type));
+            }
+            void operator()(const utils::EnumTypename &type) {
+                if (type.type)
+                    paths.push_back(builder.declaringPath(type.type));
+            }
+            void operator()(const utils::ArrayTypename &type) { std::visit(*this, *type.value); }
+            void operator()(const utils::MapTypename &type) {
+                std::visit(*this, *type.key);
+                std::visit(*this, *type.value);
+            }
+            void operator()(const utils::TupleTypename &type) {
+                for (const auto &element : type.elements)
+                    std::visit(*this, element);
+            }
+            void operator()(const utils::VariantTypename &type) {
+                for (const auto &alternative : type.alternatives)
+                    std::visit(*this, alternative);
+            }
+            void operator()(const utils::FunctionTypename &type) {
+                for (const auto &parameter : type.parameters)
+                    std::visit(*this, parameter.second);
+
+                std::visit(*this, *type.returnType);
+            }
+            void operator()(const utils::OptionalTypename &type) { std::visit(*this, *type.value); }
+            void operator()(const utils::PrimitiveTypename &) { }
+            void operator()(const utils::ReferenceTypename &type) { std::visit(*this, *type.value); }
+        };
+
+        void addAttributes(llvm::Function *function, const parser::Function *node) {
+            if (node->isInline)
+                function->addFnAttr(llvm::Attribute::AlwaysInline);
+            if (node->isNoInline)
+                function->addFnAttr(llvm::Attribute::NoInline);
+            if (node->isCold)
+                function->addFnAttr(llvm::Attribute::Cold);
+            if (node->isHot)
+                function->addFnAttr(llvm::Attribute::Hot);
+
+            if (node->isPure) {
+                function->addFnAttr(llvm::Attribute::NoUnwind);
+
+                auto returnsThroughPointer = std::any_of(function->arg_begin(), function->arg_end(),
+                    [](const llvm::Argument &argument) { return argument.hasStructRetAttr(); });
+
+                // the platform might return through a pointer that the function has to write to
+                if (!returnsThroughPointer)
+                    function->addFnAttr(llvm::Attribute::ReadOnly);
+            }
+        }
+    }
+
     void Function::build() {
-        bool responsible = parser::search::exclusive::root(node) == builder.root;
+        // instantiations have no home file, every file that calls one emits its own linkonce_odr copy
+        bool responsible = parser::search::exclusive::root(node) == builder.root || !generics.empty();
 
         utils::Typename returnTypename = from(utils::PrimitiveType::Nothing);
 
         const hermes::Node *body;
 
         switch (node->is<parser::Kind>()) {
-        case parser::Kind::Function: {
-            auto e = node->as<parser::Function>();
+        case parser::Kind::Function:
+        case parser::Kind::Lambda: {
+            auto isLambda = node->is(parser::Kind::Lambda);
+            auto signature = signatureOf(node);
 
-            if (auto fixed = e->fixedType())
-                returnTypename = builder.resolveTypename(fixed);
+            if (signature.fixedType)
+                returnTypename = builder.resolveTypename(signature.fixedType);
 
-            body = responsible ? e->body() : nullptr;
+            body = responsible ? signature.body : nullptr;
             // Check for inferred type from expression node maybe?
-            if (body && body->is(parser::Kind::Expression) && !e->hasFixedType
+            if (body && body->is(parser::Kind::Expression) && !signature.fixedType
                 && returnTypename == from(utils::PrimitiveType::Nothing)) {
 
-                auto astFunction = node->as<parser::Function>();
-                auto parameters = astFunction->parameters();
-
                 // this might be bad?
                 Cache tempCache;
 
@@ -46,13 +131,20 @@ namespace kara::builder {
                 tempContext.function = this;
                 tempContext.cache = &tempCache;
 
-                for (auto parameter : parameters) {
+                for (auto parameter : signature.parameters) {
                     tempCache.variables.insert({
                         parameter,
                         std::make_unique<builder::Variable>(parameter, tempContext, nullptr),
                     });
                 }
 
+                for (const auto &[capture, captureType] : captures) {
+                    tempCache.variables.insert({
+                        capture,
+                        std::make_unique<builder::Variable>(capture, captureType, nullptr),
+                    });
+                }
+
                 auto expressionValue = ops::expression::make(tempContext, body->as<parser::Expression>());
                 returnTypename = expressionValue.type;
             }
@@ -60,16 +152,14 @@ namespace kara::builder {
             returnType = builder.makeTypename(returnTypename);
 
             // sad
-            utils::FunctionParameters parameters(e->parameterCount);
-            std::vector<std::pair<std::string, llvm::Type *>> parameterTypes(e->parameterCount);
+            utils::FunctionParameters parameters(signature.parameters.size());
+            std::vector<std::pair<std::string, llvm::Type *>> parameterTypes(signature.parameters.size());
 
-            auto parameterVariables = e->parameters();
-
-            for (size_t a = 0; a < e->parameterCount; a++) {
-                auto var = parameterVariables[a];
+            for (size_t a = 0; a < signature.parameters.size(); a++) {
+                auto var = signature.parameters[a];
 
                 if (!var->hasFixedType) {
-                    throw VerifyError(e->children[a].get(),
+                    throw VerifyError(var,
                         "Function parameter must have given type, default "
                         "parameters are not implemented.");
                 }
@@ -82,18 +172,54 @@ namespace kara::builder {
             }
 
             type = {
-                utils::FunctionKind::Pointer,
+                isLambda ? utils::FunctionKind::Regular : utils::FunctionKind::Pointer,
                 std::move(parameters),
                 std::make_shared<utils::Typename>(returnTypename),
             };
 
+            // same layout as Builder::makeClosureFunctionType, the environment goes ahead of the parameters
+            if (isLambda) {
+                auto environmentType = llvm::Type::getInt8PtrTy(builder.context);
+
+                parameterTypes.insert(parameterTypes.begin(), { "environment", environmentType });
+            }
+
             rawArguments = { returnType, parameterTypes };
             auto formattedArguments = builder.platform->formatArguments(builder.target, rawArguments);
 
+            auto isCVarArgs = !isLambda && node->as<parser::Function>()->isCVarArgs;
+
             llvm::FunctionType *valueType = llvm::FunctionType::get(
-                formattedArguments.returnType, formattedArguments.parameterTypes(), e->isCVarArgs);
-            function = llvm::Function::Create(
-                valueType, llvm::GlobalVariable::ExternalLinkage, 0, e->name, builder.module.get());
+                formattedArguments.returnType, formattedArguments.parameterTypes(), isCVarArgs);
+
+            // only closures made in this module can reach a lambda
+            if (isLambda) {
+                function = llvm::Function::Create(
+                    valueType, llvm::GlobalVariable::InternalLinkage, 0, "lambda", builder.module.get());
+            } else if (!generics.empty()) {
+                std::vector<std::string> names(generics.size());
+
+                std::transform(generics.begin(), generics.end(), names.begin(),
+                    [](const auto &generic) { return toString(generic.second); });
+
+                // type names are not unique across files, the hash tells another file's f<Point> apart
+                std::vector<std::string> paths = { builder.declaringPath(node) };
+                DeclarationCollector collector { builder, paths };
+
+                for (const auto &generic : generics)
+                    std::visit(collector, generic.second);
+
+                auto identity = llvm::xxHash64(fmt::format("{}", fmt::join(paths, "\n")));
+                auto name = fmt::format(
+                    "{}<{}>.{:016x}", node->as<parser::Function>()->name, fmt::join(names, ", "), identity);
+
+                // same name and body in every file, so the linker keeps one copy per distinct set of types
+                function = llvm::Function::Create(
+                    valueType, llvm::GlobalVariable::LinkOnceODRLinkage, 0, name, builder.module.get());
+            } else {
+                function = llvm::Function::Create(valueType, llvm::GlobalVariable::ExternalLinkage, 0,
+                    node->as<parser::Function>()->name, builder.module.get());
+            }
 
             // name function parameters
             for (size_t a = 0; a < formattedArguments.parameters.size(); a++) {
@@ -104,6 +230,9 @@ namespace kara::builder {
                 arg->addAttrs(attrs);
             }
 
+            if (!isLambda)
+                addAttributes(function, node->as<parser::Function>());
+
             break;
         }
 
@@ -138,12 +267,16 @@ namespace kara::builder {
             entry.SetInsertPoint(entryBlock);
             exit.SetInsertPoint(exitBlock);
 
+            // llvm.used keeps it from being internalized when the target is an executable
+            if (purpose == Purpose::UserFunction && node->as<parser::Function>()->isExport)
+                llvm::appendToUsed(*builder.module, { function });
+
             std::vector<llvm::Argument *> arguments(function->arg_size());
 
             for (size_t a = 0; a < arguments.size(); a++)
                 arguments[a] = function->getArg(a);
 
-            if (node->is(parser::Kind::Function)) {
+            if (purpose == Purpose::UserFunction || purpose == Purpose::Closure) {
                 ops::Context entryContext {
                     builder,
                     nullptr,
@@ -156,18 +289,34 @@ namespace kara::builder {
                     nullptr,
                 };
 
-                auto astFunction = node->as<parser::Function>();
-                auto parameters = astFunction->parameters();
+                auto parameters = signatureOf(node).parameters;
 
                 auto realArguments = builder.platform->tieArguments(
                     entryContext, rawArguments.returnType, rawArguments.parameterTypes(), arguments);
 
+                // skips the environment
+                size_t offset = purpose == Purpose::Closure;
+
                 // Create parameters within scope.
                 for (size_t a = 0; a < parameters.size(); a++) {
                     auto parameterNode = parameters[a];
 
                     cache.variables[parameterNode]
-                        = std::make_unique<builder::Variable>(parameterNode, entryContext, realArguments[a]);
+                        = std::make_unique<builder::Variable>(parameterNode, entryContext, realArguments[a + offset]);
+                }
+
+                if (purpose == Purpose::Closure) {
+                    if (environment) {
+                        auto pointer
+                            = entry.CreatePointerCast(realArguments.front(), llvm::PointerType::get(environment, 0));
+
+                        for (size_t a = 0; a < captures.size(); a++) {
+                            auto &[capture, captureType] = captures[a];
+
+                            cache.variables[capture] = std::make_unique<builder::Variable>(
+                                capture, captureType, entry.CreateStructGEP(environment, pointer, a));
+                        }
+                    }
                 }
             }
 
@@ -319,6 +468,20 @@ namespace kara::builder {
                 builder.platform->tieReturn(
                     exitContext, returnType, exit.CreateLoad(returnType, returnValue, "final"), arguments);
             }
+
+            promote();
+
+            if (purpose == Purpose::Closure)
+                markEnvironment();
+
+            // points at the declaration that broke instead of printing the whole module once the target is linked
+            if (builder.options.verify == "function") {
+                std::string message;
+                llvm::raw_string_ostream stream(message);
+
+                if (llvm::verifyFunction(*function, &stream))
+                    throw VerifyError(node, "Function {} failed to verify.\n{}", function->getName().str(), message);
+            }
         }
     }
 
@@ -331,6 +494,8 @@ namespace kara::builder {
             switch (node->is<parser::Kind>()) {
             case parser::Kind::Function:
                 return Purpose::UserFunction;
+            case parser::Kind::Lambda:
+                return Purpose::Closure;
             case parser::Kind::Type:
                 return Purpose::TypeDestructor;
             default:
@@ -338,4 +503,11 @@ namespace kara::builder {
             }
         })();
     }
+
+    Function::Function(llvm::Function *function, Builder &builder)
+        : purpose(Purpose::ElementDestructor)
+        , builder(builder)
+        , entry(builder.context)
+        , exit(builder.context)
+        , function(function) { }
 }
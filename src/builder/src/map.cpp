@@ -0,0 +1,563 @@
+#include <builder/builder.h>
+
+#include <builder/target.h>
+#include <builder/operations.h>
+
+#include <parser/type.h>
+#include <parser/variable.h>
+
+#include <cassert>
+#include <algorithm>
+
+namespace kara::builder {
+    namespace {
+        /*
+         * Every slot has a control byte:
+         *   0x80 - empty, 0xFE - deleted, 0b0xxxxxxx - full, holding the low 7 bits of the hash (h2).
+         * Control bytes are read a group (8 slots) at a time as a u64 and matched with bit tricks,
+         * so a lookup touches one cache line of control bytes for most probes.
+         */
+        constexpr uint64_t controlEmpty = 0x80;
+        constexpr uint64_t controlDeleted = 0xFE;
+
+        constexpr uint64_t groupShift = 3; // 8 slots per group
+        constexpr uint64_t minimumCapacity = 8;
+
+        constexpr uint64_t lsbs = 0x0101010101010101;
+        constexpr uint64_t msbs = 0x8080808080808080;
+
+        bool isHashable(Builder &builder, const utils::Typename &type) {
+            if (auto primitive = std::get_if<utils::PrimitiveTypename>(&type))
+                return primitive->isNumber() || primitive->type == utils::PrimitiveType::Bool;
+
+            if (auto reference = std::get_if<utils::ReferenceTypename>(&type))
+                return reference->kind == utils::ReferenceKind::Regular; // by address
+
+            if (auto named = std::get_if<utils::NamedTypename>(&type)) {
+                auto fields = named->type->fields();
+
+                return std::all_of(fields.begin(), fields.end(), [&builder](const parser::Variable *field) {
+                    return field->hasFixedType && isHashable(builder, builder.resolveTypename(field->fixedType()));
+                });
+            }
+
+            return false;
+        }
+
+        // not mixed, combined values go through makeMix before use
+        llvm::Value *makeHash(Builder &builder, llvm::IRBuilder<> &ir, llvm::Value *ptr, const utils::Typename &type) {
+            auto i64 = ir.getInt64Ty();
+
+            if (auto primitive = std::get_if<utils::PrimitiveTypename>(&type)) {
+                auto llvmType = builder.makePrimitiveType(primitive->type);
+
+                llvm::Value *value = ir.CreateLoad(llvmType, ptr);
+
+                if (primitive->isFloat()) {
+                    // -0.0 + 0.0 is 0.0, so both zeros hash the same and match their fcmp
+                    value = ir.CreateFAdd(value, llvm::ConstantFP::get(llvmType, 0.0));
+                    value = ir.CreateBitCast(value, ir.getIntNTy(llvmType->getPrimitiveSizeInBits()));
+                }
+
+                return ir.CreateZExt(value, i64);
+            }
+
+            if (auto reference = std::get_if<utils::ReferenceTypename>(&type))
+                return ir.CreatePtrToInt(ir.CreateLoad(builder.makeTypename(*reference), ptr), i64);
+
+            if (auto named = std::get_if<utils::NamedTypename>(&type)) {
+                auto structure = builder.makeType(named->type);
+
+                llvm::Value *result = llvm::ConstantInt::get(i64, 0);
+
+                for (auto field : named->type->fields()) {
+                    auto fieldPtr = ir.CreateStructGEP(structure->type, ptr, structure->indices.at(field));
+                    auto fieldHash = makeHash(builder, ir, fieldPtr, builder.resolveTypename(field->fixedType()));
+
+                    result = ir.CreateMul(ir.CreateXor(result, fieldHash), llvm::ConstantInt::get(i64, 0x9E3779B97F4A7C15));
+                }
+
+                return result;
+            }
+
+            throw std::runtime_error(fmt::format("Type {} cannot be hashed.", toString(type)));
+        }
+
+        // murmur3 finalizer, both ends of the hash are used (h1 picks the group, h2 is stored in control)
+        llvm::Value *makeMix(llvm::IRBuilder<> &ir, llvm::Value *value) {
+            auto i64 = ir.getInt64Ty();
+
+            value = ir.CreateXor(value, ir.CreateLShr(value, 33));
+            value = ir.CreateMul(value, llvm::ConstantInt::get(i64, 0xFF51AFD7ED558CCD));
+            value = ir.CreateXor(value, ir.CreateLShr(value, 33));
+            value = ir.CreateMul(value, llvm::ConstantInt::get(i64, 0xC4CEB9FE1A85EC53));
+
+            return ir.CreateXor(value, ir.CreateLShr(value, 33));
+        }
+
+        llvm::Value *makeEqual(
+            Builder &builder, llvm::IRBuilder<> &ir, llvm::Value *a, llvm::Value *b, const utils::Typename &type) {
+            if (auto primitive = std::get_if<utils::PrimitiveTypename>(&type)) {
+                auto llvmType = builder.makePrimitiveType(primitive->type);
+
+                auto left = ir.CreateLoad(llvmType, a);
+                auto right = ir.CreateLoad(llvmType, b);
+
+                return primitive->isFloat() ? ir.CreateFCmpOEQ(left, right) : ir.CreateICmpEQ(left, right);
+            }
+
+            if (auto reference = std::get_if<utils::ReferenceTypename>(&type)) {
+                auto llvmType = builder.makeTypename(*reference);
+
+                return ir.CreateICmpEQ(ir.CreateLoad(llvmType, a), ir.CreateLoad(llvmType, b));
+            }
+
+            if (auto named = std::get_if<utils::NamedTypename>(&type)) {
+                auto structure = builder.makeType(named->type);
+
+                llvm::Value *result = ir.getTrue();
+
+                for (auto field : named->type->fields()) {
+                    auto index = structure->indices.at(field);
+
+                    auto equal = makeEqual(builder, ir, ir.CreateStructGEP(structure->type, a, index),
+                        ir.CreateStructGEP(structure->type, b, index), builder.resolveTypename(field->fixedType()));
+
+                    result = ir.CreateAnd(result, equal);
+                }
+
+                return result;
+            }
+
+            throw std::runtime_error(fmt::format("Type {} cannot be compared.", toString(type)));
+        }
+
+        struct Groups {
+            Builder &builder;
+            llvm::IRBuilder<> &ir;
+
+            llvm::Value *load(llvm::Value *control, llvm::Value *group) const {
+                auto i64 = ir.getInt64Ty();
+
+                auto pointer = ir.CreateGEP(ir.getInt8Ty(), control, ir.CreateShl(group, groupShift));
+                llvm::Value *bytes = ir.CreateAlignedLoad(
+                    i64, ir.CreatePointerCast(pointer, llvm::PointerType::get(i64, 0)), llvm::Align(8));
+
+                // matches below count slots from the low byte
+                if (builder.target.layout->isBigEndian())
+                    bytes = ir.CreateUnaryIntrinsic(llvm::Intrinsic::bswap, bytes);
+
+                return bytes;
+            }
+
+            // high bit set in every byte equal to h2, may report extra bytes after a real match
+            llvm::Value *matchHash(llvm::Value *bytes, llvm::Value *h2) const {
+                auto i64 = ir.getInt64Ty();
+
+                auto x = ir.CreateXor(bytes, ir.CreateMul(h2, llvm::ConstantInt::get(i64, lsbs)));
+
+                return ir.CreateAnd(ir.CreateAnd(ir.CreateSub(x, llvm::ConstantInt::get(i64, lsbs)), ir.CreateNot(x)),
+                    llvm::ConstantInt::get(i64, msbs));
+            }
+
+            llvm::Value *matchEmpty(llvm::Value *bytes) const {
+                return ir.CreateAnd(ir.CreateAnd(bytes, ir.CreateShl(ir.CreateNot(bytes), 6)),
+                    llvm::ConstantInt::get(ir.getInt64Ty(), msbs));
+            }
+
+            llvm::Value *matchEmptyOrDeleted(llvm::Value *bytes) const {
+                return ir.CreateAnd(ir.CreateAnd(bytes, ir.CreateNot(ir.CreateShl(bytes, 7))),
+                    llvm::ConstantInt::get(ir.getInt64Ty(), msbs));
+            }
+
+            // slot index of the lowest match
+            llvm::Value *first(llvm::Value *group, llvm::Value *matches) const {
+                auto bit = ir.CreateBinaryIntrinsic(llvm::Intrinsic::cttz, matches, ir.getTrue());
+
+                return ir.CreateAdd(ir.CreateShl(group, groupShift), ir.CreateLShr(bit, 3));
+            }
+        };
+    }
+
+    void Map::build() {
+        if (find)
+            return;
+
+        if (!isHashable(builder, *type.key))
+            throw std::runtime_error(fmt::format("Type {} cannot be used as a map key.", toString(*type.key)));
+
+        if (builder.needsDestroy(*type.key))
+            throw std::runtime_error(fmt::format("Map key {} must not need to be destroyed.", toString(*type.key)));
+
+        auto &context = builder.context;
+
+        auto name = toString(type);
+
+        auto i64 = llvm::Type::getInt64Ty(context);
+        auto i8 = llvm::Type::getInt8Ty(context);
+
+        auto mapPointer = llvm::PointerType::get(structType, 0);
+        auto keyPointer = llvm::PointerType::get(builder.makeTypename(*type.key), 0);
+        auto entryPointer = llvm::PointerType::get(entryType, 0);
+
+        auto entrySize = llvm::ConstantInt::get(i64, builder.target.layout->getTypeAllocSize(entryType));
+
+        auto zero = llvm::ConstantInt::get(i64, 0);
+        auto one = llvm::ConstantInt::get(i64, 1);
+
+        auto makeKeyHash = [this](llvm::IRBuilder<> &ir, llvm::Value *key) {
+            return makeMix(ir, makeHash(builder, ir, key, *type.key));
+        };
+
+        auto makeFunction = [&](llvm::Type *returnType, std::vector<llvm::Type *> parameters, const char *suffix) {
+            auto function = llvm::Function::Create(llvm::FunctionType::get(returnType, parameters, false),
+                llvm::GlobalVariable::LinkageTypes::InternalLinkage, fmt::format("{}.{}", name, suffix),
+                *builder.module);
+
+            function->addFnAttr(llvm::Attribute::NoUnwind);
+
+            return function;
+        };
+
+        find = makeFunction(entryPointer, { mapPointer, keyPointer }, "find");
+        insert = makeFunction(entryPointer, { mapPointer, keyPointer }, "insert");
+        erase = makeFunction(llvm::Type::getVoidTy(context), { mapPointer, entryPointer }, "erase");
+        rehash = makeFunction(llvm::Type::getVoidTy(context), { mapPointer, i64 }, "rehash");
+
+        find->addFnAttr(llvm::Attribute::InlineHint);
+        find->addFnAttr(llvm::Attribute::ReadOnly);
+        rehash->addFnAttr(llvm::Attribute::NoInline);
+
+        // walks groups h1, h1 + 1, h1 + 3, h1 + 6..., visits every group once when the group count is a power of two
+        struct Probe {
+            llvm::PHINode *group = nullptr;
+            llvm::PHINode *step = nullptr;
+        };
+
+        auto makeProbe = [&](llvm::IRBuilder<> &ir, llvm::BasicBlock *probe, llvm::Value *h1, llvm::Value *capacity) {
+            auto groupMask = ir.CreateSub(ir.CreateLShr(capacity, groupShift), one);
+            auto first = ir.CreateAnd(h1, groupMask);
+
+            auto from = ir.GetInsertBlock();
+            ir.CreateBr(probe);
+
+            ir.SetInsertPoint(probe);
+
+            Probe result { ir.CreatePHI(i64, 2), ir.CreatePHI(i64, 2) };
+            result.group->addIncoming(first, from);
+            result.step->addIncoming(zero, from);
+
+            return std::make_pair(result, groupMask);
+        };
+
+        auto makeNext = [&](llvm::IRBuilder<> &ir, const Probe &probe, llvm::Value *groupMask) {
+            auto step = ir.CreateAdd(probe.step, one);
+            auto group = ir.CreateAnd(ir.CreateAdd(probe.group, step), groupMask);
+
+            probe.group->addIncoming(group, ir.GetInsertBlock());
+            probe.step->addIncoming(step, ir.GetInsertBlock());
+
+            ir.CreateBr(probe.group->getParent());
+        };
+
+        // find
+        {
+            auto map = find->getArg(0);
+            auto key = find->getArg(1);
+
+            auto blockEntry = llvm::BasicBlock::Create(context, "entry", find);
+            auto blockStart = llvm::BasicBlock::Create(context, "start", find);
+            auto blockProbe = llvm::BasicBlock::Create(context, "probe", find);
+            auto blockMatch = llvm::BasicBlock::Create(context, "match", find);
+            auto blockCompare = llvm::BasicBlock::Create(context, "compare", find);
+            auto blockFound = llvm::BasicBlock::Create(context, "found", find);
+            auto blockExhausted = llvm::BasicBlock::Create(context, "exhausted", find);
+            auto blockNext = llvm::BasicBlock::Create(context, "next", find);
+            auto blockMissing = llvm::BasicBlock::Create(context, "missing", find);
+
+            llvm::IRBuilder<> ir(blockEntry);
+            Groups groups { builder, ir };
+
+            auto capacity = ir.CreateLoad(i64, ir.CreateStructGEP(structType, map, 1));
+            ir.CreateCondBr(ir.CreateICmpEQ(capacity, zero), blockMissing, blockStart);
+
+            ir.SetInsertPoint(blockStart);
+
+            auto hash = makeKeyHash(ir, key);
+            auto h2 = ir.CreateAnd(hash, 0x7F);
+
+            auto control = ir.CreateLoad(llvm::PointerType::get(i8, 0), ir.CreateStructGEP(structType, map, 3));
+            auto slots = ir.CreateLoad(entryPointer, ir.CreateStructGEP(structType, map, 4));
+
+            auto [probe, groupMask] = makeProbe(ir, blockProbe, ir.CreateLShr(hash, 7), capacity);
+
+            auto bytes = groups.load(control, probe.group);
+            auto candidates = groups.matchHash(bytes, h2);
+
+            ir.CreateBr(blockMatch);
+
+            ir.SetInsertPoint(blockMatch);
+
+            auto remaining = ir.CreatePHI(i64, 2);
+            remaining->addIncoming(candidates, blockProbe);
+
+            ir.CreateCondBr(ir.CreateICmpNE(remaining, zero), blockCompare, blockExhausted);
+
+            ir.SetInsertPoint(blockCompare);
+
+            auto entry = ir.CreateGEP(entryType, slots, groups.first(probe.group, remaining));
+            auto equal = makeEqual(builder, ir, ir.CreateStructGEP(entryType, entry, 0), key, *type.key);
+
+            remaining->addIncoming(ir.CreateAnd(remaining, ir.CreateSub(remaining, one)), ir.GetInsertBlock());
+
+            ir.CreateCondBr(equal, blockFound, blockMatch);
+
+            ir.SetInsertPoint(blockFound);
+            ir.CreateRet(entry);
+
+            // an empty slot ends every probe sequence, the key would have been placed there
+            ir.SetInsertPoint(blockExhausted);
+            ir.CreateCondBr(ir.CreateICmpNE(groups.matchEmpty(bytes), zero), blockMissing, blockNext);
+
+            ir.SetInsertPoint(blockNext);
+            makeNext(ir, probe, groupMask);
+
+            ir.SetInsertPoint(blockMissing);
+            ir.CreateRet(llvm::ConstantPointerNull::get(entryPointer));
+        }
+
+        // insert
+        {
+            auto map = insert->getArg(0);
+            auto key = insert->getArg(1);
+
+            auto blockEntry = llvm::BasicBlock::Create(context, "entry", insert);
+            auto blockGrow = llvm::BasicBlock::Create(context, "grow", insert);
+            auto blockStart = llvm::BasicBlock::Create(context, "start", insert);
+            auto blockProbe = llvm::BasicBlock::Create(context, "probe", insert);
+            auto blockNext = llvm::BasicBlock::Create(context, "next", insert);
+            auto blockPlace = llvm::BasicBlock::Create(context, "place", insert);
+
+            llvm::IRBuilder<> ir(blockEntry);
+            Groups groups { builder, ir };
+
+            auto sizePtr = ir.CreateStructGEP(structType, map, 0);
+            auto capacityPtr = ir.CreateStructGEP(structType, map, 1);
+            auto growthPtr = ir.CreateStructGEP(structType, map, 2);
+
+            ir.CreateCondBr(ir.CreateICmpEQ(ir.CreateLoad(i64, growthPtr), zero), blockGrow, blockStart);
+
+            // out of room, rebuild in place if most of the used slots are tombstones, otherwise double
+            ir.SetInsertPoint(blockGrow);
+            {
+                auto size = ir.CreateLoad(i64, sizePtr);
+                auto capacity = ir.CreateLoad(i64, capacityPtr);
+
+                auto doubled = ir.CreateSelect(ir.CreateICmpEQ(capacity, zero),
+                    llvm::ConstantInt::get(i64, minimumCapacity), ir.CreateShl(capacity, 1));
+                auto mostlyDeleted = ir.CreateICmpULT(ir.CreateShl(size, 1), capacity);
+
+                ir.CreateCall(rehash, { map, ir.CreateSelect(mostlyDeleted, capacity, doubled) });
+                ir.CreateBr(blockStart);
+            }
+
+            ir.SetInsertPoint(blockStart);
+
+            auto capacity = ir.CreateLoad(i64, capacityPtr);
+
+            auto hash = makeKeyHash(ir, key);
+            auto h2 = ir.CreateAnd(hash, 0x7F);
+
+            auto control = ir.CreateLoad(llvm::PointerType::get(i8, 0), ir.CreateStructGEP(structType, map, 3));
+            auto slots = ir.CreateLoad(entryPointer, ir.CreateStructGEP(structType, map, 4));
+
+            auto [probe, groupMask] = makeProbe(ir, blockProbe, ir.CreateLShr(hash, 7), capacity);
+
+            auto available = groups.matchEmptyOrDeleted(groups.load(control, probe.group));
+            ir.CreateCondBr(ir.CreateICmpNE(available, zero), blockPlace, blockNext);
+
+            ir.SetInsertPoint(blockNext);
+            makeNext(ir, probe, groupMask);
+
+            ir.SetInsertPoint(blockPlace);
+
+            auto index = groups.first(probe.group, available);
+            auto controlPtr = ir.CreateGEP(i8, control, index);
+
+            // reusing a tombstone does not use up growth, it was paid for when the slot was first filled
+            auto wasEmpty = ir.CreateICmpEQ(ir.CreateLoad(i8, controlPtr), llvm::ConstantInt::get(i8, controlEmpty));
+
+            ir.CreateStore(ir.CreateTrunc(h2, i8), controlPtr);
+            ir.CreateStore(ir.CreateSub(ir.CreateLoad(i64, growthPtr), ir.CreateZExt(wasEmpty, i64)), growthPtr);
+            ir.CreateStore(ir.CreateAdd(ir.CreateLoad(i64, sizePtr), one), sizePtr);
+
+            auto entry = ir.CreateGEP(entryType, slots, index);
+            auto keyType = builder.makeTypename(*type.key);
+
+            ir.CreateStore(ir.CreateLoad(keyType, key), ir.CreateStructGEP(entryType, entry, 0));
+            ir.CreateRet(entry);
+        }
+
+        // erase
+        {
+            auto map = erase->getArg(0);
+            auto entry = erase->getArg(1);
+
+            llvm::IRBuilder<> ir(llvm::BasicBlock::Create(context, "entry", erase));
+            Groups groups { builder, ir };
+
+            auto sizePtr = ir.CreateStructGEP(structType, map, 0);
+            auto growthPtr = ir.CreateStructGEP(structType, map, 2);
+
+            auto control = ir.CreateLoad(llvm::PointerType::get(i8, 0), ir.CreateStructGEP(structType, map, 3));
+            auto slots = ir.CreateLoad(entryPointer, ir.CreateStructGEP(structType, map, 4));
+
+            auto index = ir.CreatePtrDiff(entryType, entry, slots);
+
+            // probes stop at a group with an empty slot, so nothing can be behind this one and it may be emptied
+            auto bytes = groups.load(control, ir.CreateLShr(index, groupShift));
+            auto hasEmpty = ir.CreateICmpNE(groups.matchEmpty(bytes), zero);
+
+            auto mark = ir.CreateSelect(
+                hasEmpty, llvm::ConstantInt::get(i8, controlEmpty), llvm::ConstantInt::get(i8, controlDeleted));
+
+            ir.CreateStore(mark, ir.CreateGEP(i8, control, index));
+            ir.CreateStore(ir.CreateAdd(ir.CreateLoad(i64, growthPtr), ir.CreateZExt(hasEmpty, i64)), growthPtr);
+            ir.CreateStore(ir.CreateSub(ir.CreateLoad(i64, sizePtr), one), sizePtr);
+
+            ir.CreateRetVoid();
+        }
+
+        // rehash
+        {
+            auto map = rehash->getArg(0);
+            auto newCapacity = rehash->getArg(1);
+
+            auto blockEntry = llvm::BasicBlock::Create(context, "entry", rehash);
+            auto blockLoop = llvm::BasicBlock::Create(context, "loop", rehash);
+            auto blockMove = llvm::BasicBlock::Create(context, "move", rehash);
+            auto blockProbe = llvm::BasicBlock::Create(context, "probe", rehash);
+            auto blockNext = llvm::BasicBlock::Create(context, "next", rehash);
+            auto blockPlace = llvm::BasicBlock::Create(context, "place", rehash);
+            auto blockAdvance = llvm::BasicBlock::Create(context, "advance", rehash);
+            auto blockRelease = llvm::BasicBlock::Create(context, "release", rehash);
+            auto blockDone = llvm::BasicBlock::Create(context, "done", rehash);
+
+            llvm::IRBuilder<> ir(blockEntry);
+            Groups groups { builder, ir };
+
+            ops::Context opsContext { builder, nullptr, &ir, nullptr, nullptr, nullptr };
+
+            auto sizePtr = ir.CreateStructGEP(structType, map, 0);
+            auto capacityPtr = ir.CreateStructGEP(structType, map, 1);
+            auto growthPtr = ir.CreateStructGEP(structType, map, 2);
+            auto controlPtr = ir.CreateStructGEP(structType, map, 3);
+            auto slotsPtr = ir.CreateStructGEP(structType, map, 4);
+
+            auto oldCapacity = ir.CreateLoad(i64, capacityPtr);
+            auto oldControl = ir.CreateLoad(llvm::PointerType::get(i8, 0), controlPtr);
+            auto oldSlots = ir.CreateLoad(entryPointer, slotsPtr);
+
+            // control is read as u64 groups
+            auto newControl = ops::makeAllocate(opsContext, newCapacity, i64);
+            ir.CreateMemSet(newControl, llvm::ConstantInt::get(i8, controlEmpty), newCapacity, llvm::Align(8));
+
+            auto newSlots = ir.CreatePointerCast(
+                ops::makeAllocate(opsContext, ir.CreateMul(newCapacity, entrySize), entryType), entryPointer);
+
+            ir.CreateCondBr(ir.CreateICmpEQ(oldCapacity, zero), blockDone, blockLoop);
+
+            ir.SetInsertPoint(blockLoop);
+
+            auto index = ir.CreatePHI(i64, 2);
+            index->addIncoming(zero, blockEntry);
+
+            auto full = ir.CreateICmpSGE(ir.CreateLoad(i8, ir.CreateGEP(i8, oldControl, index)),
+                llvm::ConstantInt::get(i8, 0)); // high bit clear
+
+            ir.CreateCondBr(full, blockMove, blockAdvance);
+
+            ir.SetInsertPoint(blockMove);
+
+            auto oldEntry = ir.CreateGEP(entryType, oldSlots, index);
+
+            auto hash = makeKeyHash(ir, ir.CreateStructGEP(entryType, oldEntry, 0));
+            auto h2 = ir.CreateAnd(hash, 0x7F);
+
+            auto [probe, groupMask] = makeProbe(ir, blockProbe, ir.CreateLShr(hash, 7), newCapacity);
+
+            // no tombstones in a fresh table, first free slot is empty
+            auto available = groups.matchEmptyOrDeleted(groups.load(newControl, probe.group));
+            ir.CreateCondBr(ir.CreateICmpNE(available, zero), blockPlace, blockNext);
+
+            ir.SetInsertPoint(blockNext);
+            makeNext(ir, probe, groupMask);
+
+            ir.SetInsertPoint(blockPlace);
+            {
+                auto newIndex = groups.first(probe.group, available);
+                auto newEntry = ir.CreateGEP(entryType, newSlots, newIndex);
+
+                auto align = builder.target.layout->getPrefTypeAlign(entryType);
+
+                ir.CreateStore(ir.CreateTrunc(h2, i8), ir.CreateGEP(i8, newControl, newIndex));
+                ir.CreateMemCpy(newEntry, align, oldEntry, align, entrySize);
+
+                ir.CreateBr(blockAdvance);
+            }
+
+            ir.SetInsertPoint(blockAdvance);
+
+            auto nextIndex = ir.CreateAdd(index, one);
+            index->addIncoming(nextIndex, blockAdvance);
+
+            ir.CreateCondBr(ir.CreateICmpEQ(nextIndex, oldCapacity), blockRelease, blockLoop);
+
+            ir.SetInsertPoint(blockRelease);
+
+            auto dataType = llvm::Type::getInt8PtrTy(context);
+
+            ops::makeDeallocate(opsContext, oldControl, oldCapacity, i64);
+            ops::makeDeallocate(opsContext, ir.CreatePointerCast(oldSlots, dataType),
+                ir.CreateMul(oldCapacity, entrySize), entryType);
+
+            ir.CreateBr(blockDone);
+
+            ir.SetInsertPoint(blockDone);
+
+            // max load factor is 7/8
+            auto growth = ir.CreateSub(
+                ir.CreateSub(newCapacity, ir.CreateLShr(newCapacity, 3)), ir.CreateLoad(i64, sizePtr));
+
+            ir.CreateStore(newCapacity, capacityPtr);
+            ir.CreateStore(growth, growthPtr);
+            ir.CreateStore(newControl, controlPtr);
+            ir.CreateStore(newSlots, slotsPtr);
+
+            ir.CreateRetVoid();
+        }
+    }
+
+    Map::Map(const utils::MapTypename &type, builder::Builder &builder)
+        : builder(builder)
+        , type(type) {
+        auto &context = builder.context;
+
+        auto sizeType = llvm::Type::getInt64Ty(context);
+
+        entryType = llvm::StructType::get(context, { builder.makeTypename(*type.key), builder.makeTypename(*type.value) });
+
+        /*
+         * struct MapOfIntToLong {
+         *   size_t size;
+         *   size_t capacity; // 0 or a power of two, at least 8
+         *   size_t growth; // inserts left before a rehash, tombstones count against it
+         *   uint8_t *control; // capacity bytes
+         *   struct { int key; long value; } *slots;
+         * };
+         */
+
+        structType = llvm::StructType::get(context,
+            { sizeType, sizeType, sizeType, llvm::Type::getInt8PtrTy(context), llvm::PointerType::get(entryType, 0) });
+    }
+}
@@ -6,6 +6,8 @@
 #include <parser/type.h>
 #include <parser/variable.h>
 
+#include <llvm/Analysis/ValueTracking.h>
+
 #include <cassert>
 #include <climits>
 
@@ -37,6 +39,48 @@ namespace kara::builder::ops::matching {
         return result;
     }
 
+    namespace {
+        // the type passed to each parameter, placed the same way match() places them, nullopt if nothing is passed
+        std::vector<std::optional<utils::Typename>> arrange(
+            const std::vector<const parser::Variable *> &parameters, const MatchInput &input) {
+            std::vector<std::optional<utils::Typename>> result(parameters.size());
+            std::vector<bool> taken(input.parameters.size());
+
+            for (const auto &[index, name] : input.names) {
+                auto iterator = std::find_if(parameters.begin(), parameters.end(),
+                    [&name = name](auto parameter) { return parameter->name == name; });
+
+                // match() reports these
+                if (iterator == parameters.end() || index >= input.parameters.size())
+                    continue;
+
+                result[std::distance(parameters.begin(), iterator)] = input.parameters[index].type;
+                taken[index] = true;
+            }
+
+            size_t next = 0;
+
+            for (size_t a = 0; a < input.parameters.size(); a++) {
+                if (taken[a])
+                    continue;
+
+                while (next < result.size() && result[next])
+                    next++;
+
+                if (next >= result.size())
+                    break;
+
+                result[next] = input.parameters[a].type;
+            }
+
+            return result;
+        }
+
+        std::optional<Generics> infer(Builder &builder, const parser::Function *function, const MatchInput &input) {
+            return builder.inferGenerics(function, arrange(function->parameters(), input));
+        }
+    }
+
     MatchResult match(Builder &builder, const utils::FunctionParameters &parameters, const MatchInput &input) {
         if (parameters.size() != input.parameters.size()) {
             auto error = fmt::format("Expected {} parameters but got {}.", parameters.size(), input.parameters.size());
@@ -147,23 +191,50 @@ namespace kara::builder::ops::matching {
             passParameters[a] = ops::get(context, ops::makeConvert(context, match.map[a], parameterType).value());
         }
 
-        auto llvmType = context.builder.makeTypename(type);
-        assert(llvmType->isPointerTy());
-        auto llvmFunction = llvmType->getPointerElementType();
-        assert(llvmFunction->isFunctionTy());
+        auto isClosure = type.kind == utils::FunctionKind::Regular;
+
+        llvm::FunctionType *llvmFunctionType;
+
+        if (isClosure) {
+            llvmFunctionType = context.builder.makeClosureFunctionType(type);
+        } else {
+            auto llvmType = context.builder.makeTypename(type);
+            assert(llvmType->isPointerTy());
+            auto llvmFunction = llvmType->getPointerElementType();
+            assert(llvmFunction->isFunctionTy());
+
+            llvmFunctionType = reinterpret_cast<llvm::FunctionType *>(llvmFunction);
+        }
 
-        auto llvmFunctionType = reinterpret_cast<llvm::FunctionType *>(llvmFunction);
         llvm::FunctionCallee callee(nullptr, nullptr);
+        llvm::Value *environment = nullptr;
 
         if (context.ir) {
-            callee = llvm::FunctionCallee(llvmFunctionType, function);
+            if (isClosure) {
+                // a closure made in this expression calls its lambda directly, which LLVM can then inline
+                auto pick = [&context, function](unsigned index) -> llvm::Value * {
+                    if (auto inserted = llvm::FindInsertedValue(function, index))
+                        return inserted;
+
+                    return context.ir->CreateExtractValue(function, index);
+                };
+
+                environment = pick(1);
+                passParameters.insert(passParameters.begin(), environment);
+
+                callee = llvm::FunctionCallee(llvmFunctionType, pick(0));
+            } else {
+                callee = llvm::FunctionCallee(llvmFunctionType, function);
+            }
         }
 
         auto expectedReturn = context.builder.makeTypename(*type.returnType);
 
+        auto returned = context.builder.platform->invokeFunction(context, callee, expectedReturn, passParameters);
+
         return builder::Result {
             builder::Result::FlagTemporary,
-            context.builder.platform->invokeFunction(context, callee, expectedReturn, passParameters),
+            returned,
             *type.returnType,
             context.accumulator,
         };
@@ -218,6 +289,25 @@ namespace kara::builder::ops::matching {
                 throw;
             }
 
+            // ^T is bound while the parameters are resolved, matching then converts like any other call
+            if (node->is(parser::Kind::Function) && !node->as<parser::Function>()->generics.empty()) {
+                auto function = node->as<parser::Function>();
+                auto generics = infer(context.builder, function, inputCopy);
+
+                if (!generics) {
+                    auto error = fmt::format("Cannot infer ^{} from the given parameters.",
+                        fmt::join(function->generics, ", ^"));
+
+                    return std::make_tuple(node, MatchResult { error });
+                }
+
+                context.builder.instantiating.emplace_back(function, std::move(*generics));
+                auto translatedParameters = translate(context.builder, parameters);
+                context.builder.instantiating.pop_back();
+
+                return std::make_tuple(node, ops::matching::match(context.builder, translatedParameters, inputCopy));
+            }
+
             auto translatedParameters = translate(context.builder, parameters);
 
             return std::make_tuple(node, ops::matching::match(context.builder, translatedParameters, inputCopy));
@@ -328,14 +418,16 @@ namespace kara::builder::ops::matching {
 
             auto pickVariables = e->parameters();
 
-            auto builderFunction = context.builder.makeFunction(e);
+            auto builderFunction = e->generics.empty()
+                ? context.builder.makeFunction(e)
+                : context.builder.makeInstantiation(e, infer(context.builder, e, input).value());
 
             std::vector<llvm::Value *> passParameters(match.map.size());
 
             for (size_t a = 0; a < passParameters.size(); a++) {
                 assert(pickVariables[a]->hasFixedType);
 
-                auto type = context.builder.resolveTypename(pickVariables[a]->fixedType());
+                const auto &type = builderFunction->type.parameters[a].second;
 
                 auto convertedValue = ops::makeConvert(context, match.map[a], type).value();
                 auto passedValue = ops::makePass(context, convertedValue);
@@ -63,8 +63,6 @@ namespace kara::builder::ops::modifiers {
             if (!function)
                 throw VerifyError(node, "Call must be done on a function typename.");
 
-            assert(function->kind == utils::FunctionKind::Pointer);
-
             auto returnedResult = ops::matching::call(context, *function, ops::get(context, result), input);
 
             return ops::matching::unwrap(returnedResult, node);
@@ -80,9 +78,15 @@ namespace kara::builder::ops::modifiers {
 
         case parser::Kind::Reference: {
             auto resolve = [&]() {
+                if (auto unresolved = std::get_if<builder::Unresolved>(&value)) {
+                    if (auto enumCase = handlers::makeDotForEnumCase(context, *unresolved, node->reference()))
+                        return *enumCase;
+                }
+
                 auto v = handlers::resolve(
                     std::array {
                         handlers::makeDotForField,
+                        handlers::makeDotForTupleElement,
                         handlers::makeDotForUFCS,
                     },
                     context, infer(), node->reference());
@@ -135,6 +139,14 @@ namespace kara::builder::ops::modifiers {
                     elementPointer, context.ir->CreateLoad(pointerToElementPointer, dataPtr), index);
             }
 
+            case utils::ArrayKind::Hybrid:
+            case utils::ArrayKind::Iterable: {
+                auto elementType = context.builder.makeTypename(*arrayType->value);
+
+                return context.ir->CreateGEP(
+                    elementType, ops::makeArrayData(context, ops::ref(context, sub), *arrayType), index);
+            }
+
             default:
                 throw;
             }
@@ -284,8 +296,21 @@ namespace kara::builder::ops::modifiers {
 namespace kara::builder::ops::expression {
     builder::Wrapped makeNounContent(const Context &context, const hermes::Node *node) {
         switch (node->is<parser::Kind>()) {
-        case parser::Kind::Parentheses:
-            return ops::expression::make(context, node->as<parser::Parentheses>()->body());
+        case parser::Kind::Parentheses: {
+            auto *e = node->as<parser::Parentheses>();
+
+            if (e->children.size() == 1)
+                return ops::expression::make(context, e->body());
+
+            auto elements = e->elements();
+            std::vector<builder::Result> values;
+            values.reserve(elements.size());
+
+            std::transform(elements.begin(), elements.end(), std::back_inserter(values),
+                [&context](auto x) { return ops::expression::make(context, x); });
+
+            return ops::nouns::makeTuple(context, values);
+        }
 
         case parser::Kind::Reference: {
             auto e = node->as<parser::Reference>();
@@ -305,6 +330,9 @@ namespace kara::builder::ops::expression {
             return builder::Unresolved(e, { e }, {});
         }
 
+        case parser::Kind::Lambda:
+            return ops::nouns::makeClosure(context, node->as<parser::Lambda>());
+
         case parser::Kind::Special:
             return ops::nouns::makeSpecial(context, node->as<parser::Special>()->type);
 
@@ -314,9 +342,16 @@ namespace kara::builder::ops::expression {
         case parser::Kind::String: {
             auto *e = node->as<parser::String>();
 
-            assert(e->inserts.empty());
+            std::vector<std::pair<size_t, builder::Result>> inserts;
+            inserts.reserve(e->inserts.size());
+
+            for (size_t a = 0; a < e->inserts.size(); a++) {
+                auto insert = e->children[a]->as<parser::Expression>();
+
+                inserts.emplace_back(e->inserts[a], ops::expression::make(context, insert));
+            }
 
-            return ops::nouns::makeString(context, e->text);
+            return ops::nouns::makeString(context, e->text, inserts);
         }
 
         case parser::Kind::Array: {
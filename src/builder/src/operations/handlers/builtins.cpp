@@ -62,15 +62,17 @@ namespace kara::builder::ops::handlers::builtins {
             case utils::ArrayKind::Unbounded:
                 return std::nullopt; // let UFCS maybe take action
 
-            case utils::ArrayKind::Iterable:
-                throw;
+            case utils::ArrayKind::VariableSize:
+            case utils::ArrayKind::Hybrid:
+            case utils::ArrayKind::Iterable: {
+                auto arrayStructType = context.builder.makeTypename(*array);
 
-            case utils::ArrayKind::VariableSize: {
-                auto arrayStructType = context.builder.makeVariableArrayType(*array->value);
+                // a view can't change the length of what it looks at
+                auto isMutable = array->kind != utils::ArrayKind::Iterable && value.isSet(builder::Result::FlagMutable);
 
                 // mutable should probably be turned off after
                 return builder::Result {
-                    builder::Result::FlagReference | (value.flags & builder::Result::FlagMutable),
+                    builder::Result::FlagReference | (isMutable ? builder::Result::FlagMutable : 0),
                     context.ir ? context.ir->CreateStructGEP(arrayStructType, ops::ref(context, value), 0) : nullptr,
                     utils::PrimitiveTypename { utils::PrimitiveType::ULong },
                     context.accumulator,
@@ -94,10 +96,10 @@ namespace kara::builder::ops::handlers::builtins {
 
             auto [value, array] = *arrayValue;
 
-            if (array->kind != utils::ArrayKind::VariableSize)
+            if (array->kind != utils::ArrayKind::VariableSize && array->kind != utils::ArrayKind::Hybrid)
                 return std::nullopt;
 
-            auto arrayStructType = context.builder.makeVariableArrayType(*array->value);
+            auto arrayStructType = context.builder.makeTypename(*array);
 
             return builder::Result {
                 builder::Result::FlagReference | (value.flags & builder::Result::FlagMutable),
@@ -119,6 +121,22 @@ namespace kara::builder::ops::handlers::builtins {
 
             auto [value, array] = *arrayValue;
 
+            utils::ReferenceTypename dataType {
+                array->value,
+                value.isSet(builder::Result::FlagMutable),
+                utils::ReferenceKind::Regular,
+            };
+
+            // inline elements have no data field to point into, hand out the address instead
+            if (array->kind == utils::ArrayKind::Hybrid) {
+                return builder::Result {
+                    builder::Result::FlagTemporary,
+                    context.ir ? ops::makeArrayData(context, ops::ref(context, value), *array) : nullptr,
+                    dataType,
+                    context.accumulator,
+                };
+            }
+
             if (array->kind != utils::ArrayKind::VariableSize)
                 return std::nullopt;
 
@@ -127,11 +145,7 @@ namespace kara::builder::ops::handlers::builtins {
             return builder::Result {
                 builder::Result::FlagReference | (value.flags & builder::Result::FlagMutable),
                 context.ir ? context.ir->CreateStructGEP(arrayStructType, ops::ref(context, value), 2) : nullptr,
-                utils::ReferenceTypename {
-                    array->value,
-                    value.isSet(builder::Result::FlagMutable),
-                    utils::ReferenceKind::Regular,
-                },
+                dataType,
                 context.accumulator,
             };
         }
@@ -151,7 +165,7 @@ namespace kara::builder::ops::handlers::builtins {
             if (!named(input[1].first, "size"))
                 return std::nullopt;
 
-            if (array->kind != utils::ArrayKind::VariableSize)
+            if (array->kind != utils::ArrayKind::VariableSize && array->kind != utils::ArrayKind::Hybrid)
                 return std::nullopt;
 
             auto ulongTypename = utils::PrimitiveTypename { utils::PrimitiveType::ULong };
@@ -163,44 +177,17 @@ namespace kara::builder::ops::handlers::builtins {
             auto &size = *converted;
 
             if (context.ir) {
-                auto reallocFunc = context.builder.getRealloc();
-
                 auto ptr = ops::ref(context, value);
 
-                auto baseType = context.builder.makeTypename(*array->value);
-                auto arrayStructType = context.builder.makeVariableArrayType(*array->value);
+                auto arrayStructType = context.builder.makeTypename(*array);
 
                 auto sizePtr = context.ir->CreateStructGEP(arrayStructType, ptr, 0); // 0 is size
-                auto capacityPtr = context.ir->CreateStructGEP(arrayStructType, ptr, 1); // 1 is capacity
-                auto dataPtr = context.ir->CreateStructGEP(arrayStructType, ptr, 2); // 2 is data
-
-                assert(dataPtr->getType()->isPointerTy());
-
-                auto dataPtrType = llvm::Type::getInt8PtrTy(context.builder.context);
-                auto dataPtrRealType = dataPtr->getType()->getPointerElementType();
-
-                assert(dataPtrRealType->isPointerTy());
-
-                auto dataElementType = dataPtrRealType->getPointerElementType();
-
-                auto dataSize = context.builder.target.layout->getTypeAllocSize(dataElementType);
-                auto constantSize = llvm::ConstantInt::get(llvm::Type::getInt64Ty(context.builder.context), dataSize);
-
-                auto baseTypePointer = llvm::PointerType::get(baseType, 0);
-
-                auto dataPtrLoaded = context.ir->CreateLoad(baseTypePointer, dataPtr);
-                auto dataCasted = context.ir->CreatePointerCast(dataPtrLoaded, dataPtrType);
 
                 auto llvmSize = ops::get(context, size);
 
-                auto allocSize = context.ir->CreateMul(llvmSize, constantSize);
-
-                auto newData = context.ir->CreateCall(reallocFunc, { dataCasted, allocSize });
-                auto newDataCasted = context.ir->CreatePointerCast(newData, dataPtrRealType);
+                ops::makeArrayReserve(context, ptr, *array, llvmSize);
 
-                context.ir->CreateStore(newDataCasted, dataPtr);
                 context.ir->CreateStore(llvmSize, sizePtr);
-                context.ir->CreateStore(llvmSize, capacityPtr);
             }
 
             return builder::Result {
@@ -226,7 +213,7 @@ namespace kara::builder::ops::handlers::builtins {
             if (!named(input[1].first, "size"))
                 return std::nullopt;
 
-            if (array->kind != utils::ArrayKind::VariableSize)
+            if (array->kind != utils::ArrayKind::VariableSize && array->kind != utils::ArrayKind::Hybrid)
                 return std::nullopt;
 
             auto ulongTypename = utils::PrimitiveTypename { utils::PrimitiveType::ULong };
@@ -238,33 +225,11 @@ namespace kara::builder::ops::handlers::builtins {
             auto &size = *converted;
 
             if (context.ir) {
-                auto reallocFunc = context.builder.getRealloc();
-
-                auto baseType = context.builder.makeTypename(*array->value);
-                auto arrayStructType = context.builder.makeVariableArrayType(*array->value);
+                auto arrayStructType = context.builder.makeTypename(*array);
 
                 auto ptr = ops::ref(context, value);
 
                 auto sizePtr = context.ir->CreateStructGEP(arrayStructType, ptr, 0); // 0 is size
-                auto capacityPtr = context.ir->CreateStructGEP(arrayStructType, ptr, 1); // 1 is capacity
-                auto dataPtr = context.ir->CreateStructGEP(arrayStructType, ptr, 2); // 2 is data
-
-                assert(dataPtr->getType()->isPointerTy());
-
-                auto dataPtrType = llvm::Type::getInt8PtrTy(context.builder.context);
-                auto dataPtrRealType = dataPtr->getType()->getPointerElementType();
-
-                assert(dataPtrRealType->isPointerTy());
-
-                auto dataElementType = dataPtrRealType->getPointerElementType();
-
-                auto dataSize = context.builder.target.layout->getTypeAllocSize(dataElementType);
-                auto constantSize = llvm::ConstantInt::get(llvm::Type::getInt64Ty(context.builder.context), dataSize);
-
-                auto baseTypePointer = llvm::PointerType::get(baseType, 0);
-
-                auto dataCasted
-                    = context.ir->CreatePointerCast(context.ir->CreateLoad(baseTypePointer, dataPtr), dataPtrType);
 
                 auto i64 = llvm::Type::getInt64Ty(context.builder.context);
 
@@ -275,13 +240,7 @@ namespace kara::builder::ops::handlers::builtins {
                 // IDK if it works like that but at least be safe
                 auto maximum = context.ir->CreateMaximum(llvmSize, llvmExistingSize);
 
-                auto allocSize = context.ir->CreateMul(maximum, constantSize);
-
-                auto newData = context.ir->CreateCall(reallocFunc, { dataCasted, allocSize });
-                auto newDataCasted = context.ir->CreatePointerCast(newData, dataPtrRealType);
-
-                context.ir->CreateStore(newDataCasted, dataPtr);
-                context.ir->CreateStore(maximum, capacityPtr);
+                ops::makeArrayReserve(context, ptr, *array, maximum);
             }
 
             return builder::Result {
@@ -307,7 +266,7 @@ namespace kara::builder::ops::handlers::builtins {
             if (!named(input[1].first, "value"))
                 return std::nullopt;
 
-            if (array->kind != utils::ArrayKind::VariableSize)
+            if (array->kind != utils::ArrayKind::VariableSize && array->kind != utils::ArrayKind::Hybrid)
                 return std::nullopt;
 
             auto converted = ops::makeConvert(context, input[1].second, *array->value);
@@ -318,9 +277,48 @@ namespace kara::builder::ops::handlers::builtins {
 
             auto &toInsert = *converted;
 
-            if (context.ir) {
-                auto reallocFunc = context.builder.getRealloc();
+            // hybrid arrays double their capacity, spilling to the heap once the inline elements are used up
+            if (array->kind == utils::ArrayKind::Hybrid && context.ir) {
+                auto ptr = ops::ref(context, value);
+
+                auto baseType = context.builder.makeTypename(*array->value);
+                auto arrayStructType = context.builder.makeTypename(*array);
+
+                auto sizePtr = context.ir->CreateStructGEP(arrayStructType, ptr, 0); // 0 is size
+                auto capacityPtr = context.ir->CreateStructGEP(arrayStructType, ptr, 1); // 1 is capacity
+
+                auto i64 = llvm::Type::getInt64Ty(context.builder.context);
+
+                auto originalSize = context.ir->CreateLoad(i64, sizePtr);
+                auto capacity = context.ir->CreateLoad(i64, capacityPtr);
+
+                auto blockCurrent = context.ir->GetInsertBlock();
+
+                auto blockInsert = llvm::BasicBlock::Create(
+                    context.builder.context, "add_insert", blockCurrent->getParent(), blockCurrent->getNextNode());
+                auto blockGrow = llvm::BasicBlock::Create(
+                    context.builder.context, "add_grow", blockCurrent->getParent(), blockInsert);
+
+                context.ir->CreateCondBr(context.ir->CreateICmpEQ(originalSize, capacity), blockGrow, blockInsert);
+
+                llvm::IRBuilder<> growBuilder(blockGrow);
+                auto growContext = context.move(&growBuilder);
+
+                auto two = llvm::ConstantInt::get(i64, 2);
+                ops::makeArrayReserve(growContext, ptr, *array, growBuilder.CreateMul(capacity, two));
+
+                growBuilder.CreateBr(blockInsert);
+
+                context.ir->SetInsertPoint(blockInsert);
 
+                auto one = llvm::ConstantInt::get(i64, 1);
+
+                auto newElementPtr
+                    = context.ir->CreateGEP(baseType, ops::makeArrayData(context, ptr, *array), originalSize);
+                context.ir->CreateStore(ops::get(context, toInsert), newElementPtr);
+
+                context.ir->CreateStore(context.ir->CreateNUWAdd(originalSize, one), sizePtr);
+            } else if (context.ir) {
                 auto ptr = ops::ref(context, value);
 
                 auto baseType = context.builder.makeTypename(*array->value);
@@ -354,9 +352,10 @@ namespace kara::builder::ops::handlers::builtins {
                 auto originalSize = context.ir->CreateLoad(i64, sizePtr);
                 auto llvmSize = context.ir->CreateNUWAdd(originalSize, one);
 
+                auto oldAllocSize = context.ir->CreateMul(context.ir->CreateLoad(i64, capacityPtr), constantSize);
                 auto allocSize = context.ir->CreateMul(llvmSize, constantSize);
 
-                auto newData = context.ir->CreateCall(reallocFunc, { dataCasted, allocSize });
+                auto newData = ops::makeReallocate(context, dataCasted, oldAllocSize, allocSize, baseType);
                 auto newDataCasted = context.ir->CreatePointerCast(newData, dataPtrRealType);
 
                 auto newElementPtr = context.ir->CreateGEP(baseType, newDataCasted, originalSize);
@@ -387,12 +386,25 @@ namespace kara::builder::ops::handlers::builtins {
 
             auto [value, array] = *arrayValue;
 
-            if (array->kind != utils::ArrayKind::VariableSize)
+            if (array->kind != utils::ArrayKind::VariableSize && array->kind != utils::ArrayKind::Hybrid)
                 return std::nullopt;
 
-            if (context.ir) {
-                auto freeFunc = context.builder.getFree();
+            if (context.ir)
+                ops::makeArrayDestroyElements(context, ops::ref(context, value), *array);
+
+            if (array->kind == utils::ArrayKind::Hybrid && context.ir) {
+                auto ptr = ops::ref(context, value);
+
+                auto arrayStructType = context.builder.makeTypename(*array);
+
+                auto sizeType = llvm::Type::getInt64Ty(context.builder.context);
+                auto zero = llvm::ConstantInt::get(sizeType, 0);
 
+                // moves back to inline storage, giving up any heap allocation
+                ops::makeArrayReserve(context, ptr, *array, zero);
+
+                context.ir->CreateStore(zero, context.ir->CreateStructGEP(arrayStructType, ptr, 0)); // 0 is size
+            } else if (context.ir) {
                 auto ptr = ops::ref(context, value);
 
                 auto baseType = context.builder.makeTypename(*array->value);
@@ -413,7 +425,11 @@ namespace kara::builder::ops::handlers::builtins {
                 auto llvmFreePointer = context.ir->CreateLoad(baseTypePointer, dataPtr);
                 auto llvmFreeParameter = context.ir->CreatePointerCast(llvmFreePointer, llvmFreeDataType);
 
-                context.ir->CreateCall(freeFunc, { llvmFreeParameter });
+                auto elementSize = llvm::ConstantInt::get(
+                    llvmSizeType, context.builder.target.layout->getTypeAllocSize(baseType));
+                auto llvmFreeSize = context.ir->CreateMul(context.ir->CreateLoad(llvmSizeType, capacityPtr), elementSize);
+
+                ops::makeDeallocate(context, llvmFreeParameter, llvmFreeSize, baseType);
 
                 assert(llvmDataType->isPointerTy());
 
@@ -582,11 +598,10 @@ namespace kara::builder::ops::handlers::builtins {
             case utils::ArrayKind::Unbounded:
                 return std::nullopt; // let UFCS maybe take action
 
-            case utils::ArrayKind::Iterable:
-                throw;
-
-            case utils::ArrayKind::VariableSize: {
-                auto arrayStructType = context.builder.makeVariableArrayType(*array->value);
+            case utils::ArrayKind::VariableSize:
+            case utils::ArrayKind::Hybrid:
+            case utils::ArrayKind::Iterable: {
+                auto arrayStructType = context.builder.makeTypename(*array);
 
                 llvm::Value *index = nullptr;
 
@@ -609,6 +624,358 @@ namespace kara::builder::ops::handlers::builtins {
         }
     }
 
+    namespace maps {
+        std::optional<std::tuple<builder::Result, const utils::MapTypename *>> popMap(const ops::Context &context,
+            ops::matching::MatchInputFlattened &input, size_t index = 0, const char *name = "map") {
+            if (!named(input[index].first, name))
+                return std::nullopt;
+
+            auto &value = input[index].second;
+
+            auto map = std::get_if<utils::MapTypename>(ops::findRealType(value.type));
+            if (!map)
+                return std::nullopt;
+
+            return std::make_tuple(ops::makeRealType(context, value), map);
+        }
+
+        // pointer to a key of the map's key type, generates the map's functions if needed
+        llvm::Value *makeKey(const Context &context, const builder::Result &key, const utils::MapTypename &map) {
+            auto converted = ops::makeConvert(context, key, *map.key);
+            if (!converted)
+                die("Key parameter could not be converted to map key type {}.", toString(*map.key));
+
+            context.builder.makeMap(map)->build();
+
+            return context.ir ? ops::ref(context, *converted) : nullptr;
+        }
+
+        Maybe<builder::Result> size(const Context &context, const Parameters &parameters) {
+            auto input = ops::matching::flatten(parameters);
+
+            if (input.size() != 1)
+                return std::nullopt;
+
+            auto mapValue = popMap(context, input);
+            if (!mapValue)
+                return std::nullopt;
+
+            auto [value, map] = *mapValue;
+
+            auto mapStructType = context.builder.makeTypename(*map);
+
+            // not mutable, size is only changed by set/remove
+            return builder::Result {
+                builder::Result::FlagReference,
+                context.ir ? context.ir->CreateStructGEP(mapStructType, ops::ref(context, value), 0) : nullptr,
+                utils::PrimitiveTypename { utils::PrimitiveType::ULong },
+                context.accumulator,
+            };
+        }
+
+        Maybe<builder::Result> get(const Context &context, const Parameters &parameters) {
+            auto input = ops::matching::flatten(parameters);
+
+            if (input.size() != 2)
+                return std::nullopt;
+
+            auto mapValue = popMap(context, input);
+            if (!mapValue)
+                return std::nullopt;
+
+            auto [value, map] = *mapValue;
+
+            if (!named(input[1].first, "key"))
+                return std::nullopt;
+
+            auto key = makeKey(context, input[1].second, *map);
+
+            llvm::Value *result = nullptr;
+
+            if (context.ir) {
+                auto builderMap = context.builder.makeMap(*map);
+
+                auto entry = context.ir->CreateCall(builderMap->find, { ops::ref(context, value), key });
+
+                auto valuePointer = llvm::PointerType::get(context.builder.makeTypename(*map->value), 0);
+                auto valuePtr = context.ir->CreateStructGEP(builderMap->entryType, entry, 1);
+
+                // ?&V is just the pointer, null is the empty state when the key is missing
+                result = context.ir->CreateSelect(
+                    context.ir->CreateIsNull(entry), llvm::ConstantPointerNull::get(valuePointer), valuePtr);
+            }
+
+            auto reference = utils::ReferenceTypename {
+                map->value,
+                value.isSet(builder::Result::FlagMutable),
+                utils::ReferenceKind::Regular,
+            };
+
+            return builder::Result {
+                builder::Result::FlagTemporary,
+                result,
+                utils::OptionalTypename { std::make_shared<utils::Typename>(std::move(reference)), false },
+                context.accumulator,
+            };
+        }
+
+        Maybe<builder::Result> set(const Context &context, const Parameters &parameters) {
+            auto input = ops::matching::flatten(parameters);
+
+            if (input.size() != 3)
+                return std::nullopt;
+
+            auto mapValue = popMap(context, input);
+            if (!mapValue)
+                return std::nullopt;
+
+            auto [value, map] = *mapValue;
+
+            if (!named(input[1].first, "key") || !named(input[2].first, "value"))
+                return std::nullopt;
+
+            auto key = makeKey(context, input[1].second, *map);
+
+            auto converted = ops::makeConvert(context, input[2].second, *map->value);
+            if (!converted) {
+                die("`set` builtin's value parameter could not be converted to map value type {}.",
+                    toString(*map->value));
+            }
+
+            // map takes ownership
+            auto toInsert = ops::makePass(context, *converted);
+
+            if (context.ir) {
+                auto builderMap = context.builder.makeMap(*map);
+
+                auto ptr = ops::ref(context, value);
+                auto entry = context.ir->CreateCall(builderMap->find, { ptr, key });
+
+                auto blockCurrent = context.ir->GetInsertBlock();
+
+                auto blockStore = llvm::BasicBlock::Create(
+                    context.builder.context, "set_store", blockCurrent->getParent(), blockCurrent->getNextNode());
+                auto blockInsert = llvm::BasicBlock::Create(
+                    context.builder.context, "set_insert", blockCurrent->getParent(), blockStore);
+                auto blockReplace = llvm::BasicBlock::Create(
+                    context.builder.context, "set_replace", blockCurrent->getParent(), blockInsert);
+
+                context.ir->CreateCondBr(context.ir->CreateIsNull(entry), blockInsert, blockReplace);
+
+                llvm::IRBuilder<> replaceBuilder(blockReplace);
+                auto replaceContext = context.move(&replaceBuilder);
+
+                if (context.builder.needsDestroy(*map->value)) {
+                    ops::makeDestroy(replaceContext,
+                        replaceBuilder.CreateStructGEP(builderMap->entryType, entry, 1), *map->value);
+                }
+
+                replaceBuilder.CreateBr(blockStore);
+
+                llvm::IRBuilder<> insertBuilder(blockInsert);
+
+                auto inserted = insertBuilder.CreateCall(builderMap->insert, { ptr, key });
+                insertBuilder.CreateBr(blockStore);
+
+                context.ir->SetInsertPoint(blockStore);
+
+                auto slot = context.ir->CreatePHI(entry->getType(), 2);
+                slot->addIncoming(entry, replaceBuilder.GetInsertBlock());
+                slot->addIncoming(inserted, blockInsert);
+
+                context.ir->CreateStore(
+                    ops::get(context, toInsert), context.ir->CreateStructGEP(builderMap->entryType, slot, 1));
+            }
+
+            return builder::Result {
+                builder::Result::FlagTemporary,
+                nullptr,
+                utils::PrimitiveTypename { utils::PrimitiveType::Nothing },
+                nullptr,
+            };
+        }
+
+        Maybe<builder::Result> remove(const Context &context, const Parameters &parameters) {
+            auto input = ops::matching::flatten(parameters);
+
+            if (input.size() != 2)
+                return std::nullopt;
+
+            auto mapValue = popMap(context, input);
+            if (!mapValue)
+                return std::nullopt;
+
+            auto [value, map] = *mapValue;
+
+            if (!named(input[1].first, "key"))
+                return std::nullopt;
+
+            auto key = makeKey(context, input[1].second, *map);
+
+            llvm::Value *removed = nullptr;
+
+            if (context.ir) {
+                auto builderMap = context.builder.makeMap(*map);
+
+                auto ptr = ops::ref(context, value);
+                auto entry = context.ir->CreateCall(builderMap->find, { ptr, key });
+
+                auto blockCurrent = context.ir->GetInsertBlock();
+
+                auto blockResume = llvm::BasicBlock::Create(
+                    context.builder.context, "remove_resume", blockCurrent->getParent(), blockCurrent->getNextNode());
+                auto blockErase = llvm::BasicBlock::Create(
+                    context.builder.context, "remove_erase", blockCurrent->getParent(), blockResume);
+
+                context.ir->CreateCondBr(context.ir->CreateIsNotNull(entry), blockErase, blockResume);
+
+                llvm::IRBuilder<> eraseBuilder(blockErase);
+                auto eraseContext = context.move(&eraseBuilder);
+
+                if (context.builder.needsDestroy(*map->value)) {
+                    ops::makeDestroy(
+                        eraseContext, eraseBuilder.CreateStructGEP(builderMap->entryType, entry, 1), *map->value);
+                }
+
+                eraseBuilder.CreateCall(builderMap->erase, { ptr, entry });
+                eraseBuilder.CreateBr(blockResume);
+
+                context.ir->SetInsertPoint(blockResume);
+
+                auto phi = context.ir->CreatePHI(context.ir->getInt1Ty(), 2);
+                phi->addIncoming(context.ir->getTrue(), eraseBuilder.GetInsertBlock());
+                phi->addIncoming(context.ir->getFalse(), blockCurrent);
+
+                removed = phi;
+            }
+
+            return builder::Result {
+                builder::Result::FlagTemporary,
+                removed,
+                utils::PrimitiveTypename { utils::PrimitiveType::Bool },
+                context.accumulator,
+            };
+        }
+
+        Maybe<builder::Result> reserve(const Context &context, const Parameters &parameters) {
+            auto input = ops::matching::flatten(parameters);
+
+            if (input.size() != 2)
+                return std::nullopt;
+
+            auto mapValue = popMap(context, input);
+            if (!mapValue)
+                return std::nullopt;
+
+            auto [value, map] = *mapValue;
+
+            if (!named(input[1].first, "size"))
+                return std::nullopt;
+
+            auto ulongTypename = utils::PrimitiveTypename { utils::PrimitiveType::ULong };
+
+            auto converted = ops::makeConvert(context, input[1].second, ulongTypename);
+            if (!converted)
+                die("Size parameter must be converted to ulong.");
+
+            context.builder.makeMap(*map)->build();
+
+            if (context.ir) {
+                auto builderMap = context.builder.makeMap(*map);
+
+                auto ptr = ops::ref(context, value);
+
+                auto i64 = llvm::Type::getInt64Ty(context.builder.context);
+
+                auto size = ops::get(context, *converted);
+
+                // room for size entries under the 7/8 load factor, rounded up to a power of two
+                auto seven = llvm::ConstantInt::get(i64, 7);
+                auto minimum = llvm::ConstantInt::get(i64, 8);
+
+                auto slots = context.ir->CreateAdd(
+                    size, context.ir->CreateUDiv(context.ir->CreateAdd(size, llvm::ConstantInt::get(i64, 6)), seven));
+                slots = context.ir->CreateSelect(context.ir->CreateICmpULT(slots, minimum), minimum, slots);
+
+                auto leadingZeros = context.ir->CreateBinaryIntrinsic(llvm::Intrinsic::ctlz,
+                    context.ir->CreateSub(slots, llvm::ConstantInt::get(i64, 1)), context.ir->getTrue());
+                auto capacity = context.ir->CreateShl(
+                    llvm::ConstantInt::get(i64, 1), context.ir->CreateSub(llvm::ConstantInt::get(i64, 64), leadingZeros));
+
+                auto current = context.ir->CreateLoad(i64, context.ir->CreateStructGEP(builderMap->structType, ptr, 1));
+
+                auto blockCurrent = context.ir->GetInsertBlock();
+
+                auto blockResume = llvm::BasicBlock::Create(
+                    context.builder.context, "reserve_resume", blockCurrent->getParent(), blockCurrent->getNextNode());
+                auto blockGrow = llvm::BasicBlock::Create(
+                    context.builder.context, "reserve_grow", blockCurrent->getParent(), blockResume);
+
+                // never shrinks
+                context.ir->CreateCondBr(context.ir->CreateICmpUGT(capacity, current), blockGrow, blockResume);
+
+                llvm::IRBuilder<> growBuilder(blockGrow);
+
+                growBuilder.CreateCall(builderMap->rehash, { ptr, capacity });
+                growBuilder.CreateBr(blockResume);
+
+                context.ir->SetInsertPoint(blockResume);
+            }
+
+            return builder::Result {
+                builder::Result::FlagTemporary,
+                nullptr,
+                utils::PrimitiveTypename { utils::PrimitiveType::Nothing },
+                nullptr,
+            };
+        }
+
+        Maybe<builder::Result> clear(const Context &context, const Parameters &parameters) {
+            auto input = ops::matching::flatten(parameters);
+
+            if (input.size() != 1)
+                return std::nullopt;
+
+            auto mapValue = popMap(context, input);
+            if (!mapValue)
+                return std::nullopt;
+
+            auto [value, map] = *mapValue;
+
+            if (context.ir) {
+                auto builderMap = context.builder.makeMap(*map);
+
+                auto ptr = ops::ref(context, value);
+
+                ops::makeMapDestroyValues(context, ptr, *map);
+
+                auto i64 = llvm::Type::getInt64Ty(context.builder.context);
+                auto i8 = llvm::Type::getInt8Ty(context.builder.context);
+
+                auto sizePtr = context.ir->CreateStructGEP(builderMap->structType, ptr, 0); // 0 is size
+                auto capacityPtr = context.ir->CreateStructGEP(builderMap->structType, ptr, 1); // 1 is capacity
+                auto growthPtr = context.ir->CreateStructGEP(builderMap->structType, ptr, 2); // 2 is growth
+                auto controlPtr = context.ir->CreateStructGEP(builderMap->structType, ptr, 3); // 3 is control
+
+                auto capacity = context.ir->CreateLoad(i64, capacityPtr);
+                auto control = context.ir->CreateLoad(llvm::PointerType::get(i8, 0), controlPtr);
+
+                // keeps the table, every slot goes back to empty (0x80)
+                context.ir->CreateMemSet(control, llvm::ConstantInt::get(i8, 0x80), capacity, llvm::Align(8));
+
+                context.ir->CreateStore(llvm::ConstantInt::get(i64, 0), sizePtr);
+                context.ir->CreateStore(context.ir->CreateSub(capacity, context.ir->CreateLShr(capacity, 3)), growthPtr);
+            }
+
+            return builder::Result {
+                builder::Result::FlagTemporary,
+                nullptr,
+                utils::PrimitiveTypename { utils::PrimitiveType::Nothing },
+                nullptr,
+            };
+        }
+    }
+
     namespace unique {
         // not going to bother with real types cuz im not really concerned with ref to unique or something
         Maybe<builder::Result> get(const Context &context, const Parameters &parameters) {
@@ -9,6 +9,7 @@
 #include <parser/type.h>
 #include <parser/variable.h>
 
+#include <cctype>
 #include <cassert>
 
 namespace kara::builder::ops::handlers {
@@ -31,7 +32,8 @@ namespace kara::builder::ops::handlers {
         auto wrappedResult = ops::matching::call(context, { typeNode->type }, {}, input);
         auto returnResult = ops::matching::unwrap(wrappedResult, unresolved.from);
 
-        auto output = ops::nouns::makeNew(context, type);
+        // every field is stored below
+        auto output = ops::nouns::makeNew(context, type, false, newNode->isShared);
 
         if (context.ir)
             context.ir->CreateStore(ops::get(context, returnResult), ops::get(context, output));
@@ -75,6 +77,39 @@ namespace kara::builder::ops::handlers {
         return ops::matching::unwrap(ops::matching::call(context, *functionType, llvmReal, input), unresolved.from);
     }
 
+    Maybe<builder::Wrapped> makeDotForEnumCase(
+        const Context &context, const builder::Unresolved &value, const parser::Reference *node) {
+        auto isVariable = [](const hermes::Node *n) { return n->is(parser::Kind::Variable); };
+        auto isEnum = [](const hermes::Node *n) { return n->is(parser::Kind::Enum); };
+
+        // a variable with the same name hides the enum
+        if (std::any_of(value.references.begin(), value.references.end(), isVariable))
+            return std::nullopt;
+
+        auto iterator = std::find_if(value.references.begin(), value.references.end(), isEnum);
+
+        if (iterator == value.references.end())
+            return std::nullopt;
+
+        auto enumNode = (*iterator)->as<parser::Enum>();
+        auto cases = enumNode->cases();
+
+        auto match = [node](auto enumCase) { return enumCase->name == node->name; };
+        auto caseIterator = std::find_if(cases.begin(), cases.end(), match);
+
+        if (caseIterator == cases.end())
+            throw VerifyError(node, "Enum {} has no case {}.", enumNode->name, node->name);
+
+        auto builderEnum = context.builder.makeEnum(enumNode);
+
+        return builder::Result {
+            builder::Result::FlagTemporary,
+            context.ir ? builderEnum->values.at(*caseIterator) : nullptr,
+            utils::EnumTypename { enumNode->name, enumNode },
+            context.accumulator,
+        };
+    }
+
     Maybe<builder::Wrapped> makeDotForField(
         const Context &context, const builder::Result &value, const parser::Reference *node) {
         // :| might generate duplicate code here, but pretty sure it generated duplicate code in last system too
@@ -126,6 +161,54 @@ namespace kara::builder::ops::handlers {
         };
     }
 
+    Maybe<builder::Wrapped> makeDotForTupleElement(
+        const Context &context, const builder::Result &value, const parser::Reference *node) {
+        auto [parent, subtype] = ops::findRealTypePair(value.type);
+
+        auto tuple = std::get_if<utils::TupleTypename>(subtype);
+        if (!tuple)
+            return std::nullopt;
+
+        auto digit = [](char c) { return std::isdigit(c); };
+
+        // elements are named by position, tuple.0
+        if (node->name.empty() || !std::all_of(node->name.begin(), node->name.end(), digit))
+            return std::nullopt;
+
+        auto index = std::stoull(node->name);
+
+        if (index >= tuple->elements.size())
+            die("Tuple {} has no element {}.", toString(*tuple), index);
+
+        auto tupleRef = ops::makeRealType(context, value);
+
+        uint32_t flags = builder::Result::FlagReference | (value.flags & (builder::Result::FlagTemporary));
+
+        if (parent) {
+            auto refType = std::get_if<utils::ReferenceTypename>(parent);
+            assert(refType);
+
+            if (refType->isMutable)
+                flags |= (builder::Result::FlagMutable);
+        } else {
+            flags |= (value.flags & (builder::Result::FlagMutable));
+        }
+
+        llvm::Value *element = nullptr;
+
+        if (context.ir) {
+            element = context.ir->CreateStructGEP(
+                context.builder.makeTypename(*tuple), ops::ref(context, tupleRef), index, node->name);
+        }
+
+        return builder::Result {
+            flags,
+            element,
+            tuple->elements[index],
+            context.accumulator,
+        };
+    }
+
     Maybe<builder::Wrapped> makeDotForUFCS(
         const Context &context, const builder::Result &value, const parser::Reference *node) {
         const auto &global = context.builder.root->children;
@@ -177,10 +260,21 @@ namespace kara::builder::ops::handlers {
         return true;
     }
 
+    bool makeInitializeEnum(const Context &context, llvm::Value *ptr, const utils::Typename &type) {
+        auto enumType = std::get_if<utils::EnumTypename>(&type);
+
+        if (!enumType)
+            return false;
+
+        context.ir->CreateStore(context.builder.makeEnum(enumType->type)->initial, ptr);
+
+        return true;
+    }
+
     bool makeInitializeReference(const Context &context, llvm::Value *ptr, const utils::Typename &type) {
         auto reference = std::get_if<utils::ReferenceTypename>(&type);
 
-        if (!(reference && reference->kind != utils::ReferenceKind::Shared))
+        if (!reference)
             return false;
 
         auto llvmType = context.builder.makeTypename(type);
@@ -195,10 +289,22 @@ namespace kara::builder::ops::handlers {
         return true;
     }
 
+    bool makeInitializeClosure(const Context &context, llvm::Value *ptr, const utils::Typename &type) {
+        auto function = std::get_if<utils::FunctionTypename>(&type);
+
+        if (!(function && function->kind == utils::FunctionKind::Regular))
+            return false;
+
+        // a null environment is what makeDestroyClosure expects from a closure that was never assigned
+        context.ir->CreateStore(llvm::Constant::getNullValue(context.builder.makeTypename(type)), ptr);
+
+        return true;
+    }
+
     bool makeInitializeVariableArray(const Context &context, llvm::Value *ptr, const utils::Typename &type) {
         auto array = std::get_if<utils::ArrayTypename>(&type);
 
-        if (!(array && array->kind == utils::ArrayKind::VariableSize))
+        if (!(array && (array->kind == utils::ArrayKind::VariableSize || array->kind == utils::ArrayKind::Hybrid)))
             return false;
 
         auto llvmType = context.builder.makeTypename(type);
@@ -210,9 +316,22 @@ namespace kara::builder::ops::handlers {
         auto pointerType = context.builder.makeTypename(*array->value);
         auto llvmPointerType = llvm::PointerType::get(pointerType, 0);
 
-        auto zero = llvm::ConstantInt::get(llvm::Type::getInt64Ty(context.builder.context), 0);
+        auto sizeType = llvm::Type::getInt64Ty(context.builder.context);
+
+        auto zero = llvm::ConstantInt::get(sizeType, 0);
         auto null = llvm::ConstantPointerNull::get(llvmPointerType);
 
+        // storage is left undefined, only the header is written
+        if (array->kind == utils::ArrayKind::Hybrid) {
+            auto capacity = llvm::ConstantInt::get(sizeType, array->size);
+
+            context.ir->CreateStore(zero, context.ir->CreateStructGEP(llvmStructType, ptr, 0)); // 0 is size
+            context.ir->CreateStore(capacity, context.ir->CreateStructGEP(llvmStructType, ptr, 1)); // 1 is capacity
+            context.ir->CreateStore(null, context.ir->CreateStructGEP(llvmStructType, ptr, 2)); // 2 is data
+
+            return true;
+        }
+
         auto empty = llvm::ConstantStruct::ConstantStruct::get(llvmStructType, { zero, zero, null });
 
         context.ir->CreateStore(empty, ptr);
@@ -220,6 +339,36 @@ namespace kara::builder::ops::handlers {
         return true;
     }
 
+    bool makeInitializeFixedArray(const Context &context, llvm::Value *ptr, const utils::Typename &type) {
+        auto array = std::get_if<utils::ArrayTypename>(&type);
+
+        // elements that start out as zero are left to makeInitializeIgnore
+        if (!(array && array->kind == utils::ArrayKind::FixedSize) || context.builder.initializesToZero(*array->value))
+            return false;
+
+        if (array->size == 0)
+            return true;
+
+        auto sizeType = llvm::Type::getInt64Ty(context.builder.context);
+
+        auto data = context.ir->CreateConstInBoundsGEP2_64(context.builder.makeTypename(type), ptr, 0, 0);
+        ops::makeInitializeElements(context, data, llvm::ConstantInt::get(sizeType, array->size), *array->value);
+
+        return true;
+    }
+
+    bool makeInitializeMap(const Context &context, llvm::Value *ptr, const utils::Typename &type) {
+        auto map = std::get_if<utils::MapTypename>(&type);
+
+        if (!map)
+            return false;
+
+        // no table is allocated until the first insert
+        context.ir->CreateStore(llvm::Constant::getNullValue(context.builder.makeTypename(type)), ptr);
+
+        return true;
+    }
+
     bool makeInitializeStruct(const Context &context, llvm::Value *ptr, const utils::Typename &type) {
         auto named = std::get_if<utils::NamedTypename>(&type);
 
@@ -234,11 +383,86 @@ namespace kara::builder::ops::handlers {
             auto zero = llvm::ConstantInt::get(i8, 0);
 
             context.ir->CreateMemSet(ptr, zero, size, llvm::MaybeAlign());
+
+            if (!context.builder.initializesToZero(type)) {
+                auto builderType = context.builder.makeType(named->type);
+
+                for (auto field : named->type->fields()) {
+                    auto fieldType = context.builder.resolveTypename(field->fixedType());
+
+                    if (context.builder.initializesToZero(fieldType))
+                        continue;
+
+                    ops::makeInitialize(context,
+                        context.ir->CreateStructGEP(builderType->type, ptr, builderType->indices.at(field)), fieldType);
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool makeInitializeTuple(const Context &context, llvm::Value *ptr, const utils::Typename &type) {
+        auto tuple = std::get_if<utils::TupleTypename>(&type);
+
+        if (!tuple)
+            return false;
+
+        auto llvmType = context.builder.makeTypename(type);
+        auto size = context.builder.target.layout->getTypeAllocSize(llvmType);
+
+        if (context.ir) {
+            context.ir->CreateMemSet(ptr, context.ir->getInt8(0), size, llvm::MaybeAlign());
+
+            for (size_t a = 0; a < tuple->elements.size(); a++) {
+                if (context.builder.initializesToZero(tuple->elements[a]))
+                    continue;
+
+                ops::makeInitialize(context, context.ir->CreateStructGEP(llvmType, ptr, a), tuple->elements[a]);
+            }
         }
 
         return true;
     }
 
+    bool makeInitializeVariant(const Context &context, llvm::Value *ptr, const utils::Typename &type) {
+        auto variant = std::get_if<utils::VariantTypename>(&type);
+
+        if (!variant)
+            return false;
+
+        auto llvmType = context.builder.makeTypename(type);
+        auto size = context.builder.target.layout->getTypeAllocSize(llvmType);
+
+        // tag 0, or the niche value for a niche
+        if (context.ir) {
+            context.ir->CreateMemSet(ptr, context.ir->getInt8(0), size, llvm::MaybeAlign());
+
+            const auto &first = variant->alternatives.front();
+
+            if (auto niche = context.builder.variantNiche(*variant)) {
+                if (!context.builder.initializesToZero(type))
+                    ops::makeVariantStore(context, ptr, *variant, 1 - *niche, nullptr);
+            } else if (!context.builder.initializesToZero(first)) {
+                ops::makeInitialize(context, ops::makeVariantValue(context, ptr, *variant, 0), first);
+            }
+        }
+
+        return true;
+    }
+
+    bool makeInitializeOptional(const Context &context, llvm::Value *ptr, const utils::Typename &type) {
+        auto optional = std::get_if<utils::OptionalTypename>(&type);
+
+        if (!optional)
+            return false;
+
+        // empty, a niche that is not zero has to be written out
+        ops::makeOptionalStore(context, ptr, *optional, nullptr);
+
+        return true;
+    }
+
     bool makeInitializeIgnore(const Context &context, llvm::Value *, const utils::Typename &type) { return true; }
 
     bool makeDestroyReference(const Context &context, llvm::Value *, const utils::Typename &type) {
@@ -255,8 +479,17 @@ namespace kara::builder::ops::handlers {
             return false;
 
         auto pointerType = context.builder.makeTypename(*reference);
+        auto elementType = context.builder.makeTypename(*reference->value);
+
+        // [T:expr] and [T:] do not keep their length around, deallocate gets 0 for unknown
+        auto array = std::get_if<utils::ArrayTypename>(reference->value.get());
+        auto isUnknownSize = array
+            && (array->kind == utils::ArrayKind::UnboundedSized || array->kind == utils::ArrayKind::Unbounded);
+
+        auto sizeType = llvm::Type::getInt64Ty(context.builder.context);
+        auto size = llvm::ConstantInt::get(
+            sizeType, isUnknownSize ? 0 : context.builder.target.layout->getTypeStoreSize(elementType));
 
-        auto freeFunc = context.builder.getFree();
         auto dataType = llvm::Type::getInt8PtrTy(context.builder.context);
         auto value = context.ir->CreateLoad(pointerType, ptr);
 
@@ -287,7 +520,60 @@ namespace kara::builder::ops::handlers {
         context.ir->SetInsertPoint(blockResume);
 
         // but free it anyway idk
-        context.ir->CreateCall(freeFunc, { pointer });
+        ops::makeDeallocate(context, pointer, size, elementType);
+
+        return true;
+    }
+
+    bool makeDestroyShared(const Context &context, llvm::Value *ptr, const utils::Typename &type) {
+        auto reference = std::get_if<utils::ReferenceTypename>(&type);
+
+        if (!(reference && reference->kind == utils::ReferenceKind::Shared))
+            return false;
+
+        assert(context.ir);
+
+        auto pointerType = context.builder.makeTypename(*reference);
+        auto blockType = context.builder.makeSharedType(*reference->value);
+
+        auto sizeType = llvm::Type::getInt64Ty(context.builder.context);
+        auto size = llvm::ConstantInt::get(sizeType, context.builder.target.layout->getTypeStoreSize(blockType));
+
+        auto value = context.ir->CreateLoad(pointerType, ptr);
+
+        auto blockCurrent = context.ir->GetInsertBlock();
+
+        auto blockResume = llvm::BasicBlock::Create(
+            context.builder.context, "res", blockCurrent->getParent(), blockCurrent->getNextNode());
+        auto blockLast = llvm::BasicBlock::Create(
+            context.builder.context, "last", blockCurrent->getParent(), blockCurrent->getNextNode());
+        auto blockRelease = llvm::BasicBlock::Create(
+            context.builder.context, "rel", blockCurrent->getParent(), blockCurrent->getNextNode());
+
+        context.ir->CreateCondBr(context.ir->CreateIsNotNull(value), blockRelease, blockResume);
+
+        llvm::IRBuilder<> releaseBuilder(blockRelease);
+        auto releaseContext = context.move(&releaseBuilder);
+
+        auto before = ops::makeSharedCountAdd(releaseContext, value, *reference->value, -1);
+        auto isLast = releaseBuilder.CreateICmpEQ(before, llvm::ConstantInt::get(sizeType, 1));
+
+        releaseBuilder.CreateCondBr(isLast, blockLast, blockResume);
+
+        // the last owner destroys the value and frees the block the count lives in
+        llvm::IRBuilder<> lastBuilder(blockLast);
+        auto lastContext = context.move(&lastBuilder);
+
+        ops::makeDestroy(lastContext, value, *reference->value);
+
+        auto dataType = llvm::Type::getInt8PtrTy(context.builder.context);
+        auto block = ops::makeSharedBlock(lastContext, value, *reference->value);
+
+        ops::makeDeallocate(lastContext, lastBuilder.CreatePointerCast(block, dataType), size, blockType);
+
+        lastBuilder.CreateBr(blockResume);
+
+        context.ir->SetInsertPoint(blockResume);
 
         return true;
     }
@@ -297,10 +583,10 @@ namespace kara::builder::ops::handlers {
 
         auto array = std::get_if<utils::ArrayTypename>(baseType);
 
-        if (!(array && array->kind == utils::ArrayKind::VariableSize))
+        if (!(array && (array->kind == utils::ArrayKind::VariableSize || array->kind == utils::ArrayKind::Hybrid)))
             return false;
 
-        auto arrayStructType = context.builder.makeVariableArrayType(*array->value);
+        auto arrayStructType = context.builder.makeTypename(*array);
         auto elementType = context.builder.makeTypename(*array->value);
         auto elementPointer = llvm::PointerType::get(elementType, 0);
 
@@ -314,16 +600,124 @@ namespace kara::builder::ops::handlers {
 
         auto arrayResult = ops::makeRealType(context, decoy);
 
-        auto free = context.builder.getFree();
         auto dataType = llvm::Type::getInt8PtrTy(context.builder.context);
+        auto sizeType = llvm::Type::getInt64Ty(context.builder.context);
+
+        auto arrayPtr = ops::ref(context, arrayResult);
+
+        ops::makeArrayDestroyElements(context, arrayPtr, *array);
 
-        auto dataPtr = context.ir->CreateStructGEP(arrayStructType, ops::ref(context, arrayResult), 2); // 2 is data
+        auto capacityPtr = context.ir->CreateStructGEP(arrayStructType, arrayPtr, 1); // 1 is capacity
+        auto dataPtr = context.ir->CreateStructGEP(arrayStructType, arrayPtr, 2); // 2 is data
         auto dataPtrCasted = context.ir->CreatePointerCast(context.ir->CreateLoad(elementPointer, dataPtr), dataType);
 
-        context.ir->CreateCall(free, { dataPtrCasted });
+        auto elementSize
+            = llvm::ConstantInt::get(sizeType, context.builder.target.layout->getTypeAllocSize(elementType));
+        auto capacity = context.ir->CreateLoad(sizeType, capacityPtr);
+        auto dataSize = context.ir->CreateMul(capacity, elementSize);
+
+        if (array->kind == utils::ArrayKind::Hybrid) {
+            // only spilled arrays own heap memory
+            auto blockCurrent = context.ir->GetInsertBlock();
+
+            auto blockResume = llvm::BasicBlock::Create(
+                context.builder.context, "res", blockCurrent->getParent(), blockCurrent->getNextNode());
+            auto blockSpilled = llvm::BasicBlock::Create(
+                context.builder.context, "spilled", blockCurrent->getParent(), blockCurrent->getNextNode());
+
+            auto inlineSize = llvm::ConstantInt::get(sizeType, array->size);
+
+            context.ir->CreateCondBr(context.ir->CreateICmpUGT(capacity, inlineSize), blockSpilled, blockResume);
+
+            llvm::IRBuilder<> spilledBuilder(blockSpilled);
+            auto spilledContext = context.move(&spilledBuilder);
+
+            ops::makeDeallocate(spilledContext, dataPtrCasted, dataSize, elementType);
+
+            spilledBuilder.CreateBr(blockResume);
+
+            context.ir->SetInsertPoint(blockResume);
+        } else {
+            ops::makeDeallocate(context, dataPtrCasted, dataSize, elementType);
+        }
+
+        return true;
+    }
+
+    bool makeDestroyMap(const Context &context, llvm::Value *ptr, const utils::Typename &type) {
+        auto map = std::get_if<utils::MapTypename>(&type);
+
+        if (!map)
+            return false;
+
+        auto builderMap = context.builder.makeMap(*map);
+
+        auto dataType = llvm::Type::getInt8PtrTy(context.builder.context);
+        auto sizeType = llvm::Type::getInt64Ty(context.builder.context);
+
+        ops::makeMapDestroyValues(context, ptr, *map);
+
+        auto capacity = context.ir->CreateLoad(sizeType, context.ir->CreateStructGEP(builderMap->structType, ptr, 1));
+        auto control = context.ir->CreateLoad(dataType, context.ir->CreateStructGEP(builderMap->structType, ptr, 3));
+        auto slots = context.ir->CreateLoad(llvm::PointerType::get(builderMap->entryType, 0),
+            context.ir->CreateStructGEP(builderMap->structType, ptr, 4));
+
+        auto entrySize = llvm::ConstantInt::get(
+            sizeType, context.builder.target.layout->getTypeAllocSize(builderMap->entryType));
+
+        // both are null for a map that was never inserted into
+        ops::makeDeallocate(context, control, capacity, sizeType);
+        ops::makeDeallocate(context, context.ir->CreatePointerCast(slots, dataType),
+            context.ir->CreateMul(capacity, entrySize), builderMap->entryType);
+
+        return true;
+    }
+
+    bool makeDestroyTuple(const Context &context, llvm::Value *ptr, const utils::Typename &type) {
+        auto tuple = std::get_if<utils::TupleTypename>(&type);
+
+        if (!tuple)
+            return false;
+
+        auto llvmType = context.builder.makeTypename(type);
+
+        for (size_t a = 0; a < tuple->elements.size(); a++) {
+            if (!context.builder.needsDestroy(tuple->elements[a]))
+                continue;
+
+            ops::makeDestroy(context, context.ir->CreateStructGEP(llvmType, ptr, a), tuple->elements[a]);
+        }
+
+        return true;
+    }
+
+    bool makeDestroyVariant(const Context &context, llvm::Value *ptr, const utils::Typename &type) {
+        auto variant = std::get_if<utils::VariantTypename>(&type);
+
+        if (!variant)
+            return false;
+
+        // branches on the tag, so it lives in its own function instead of splitting the exit chain
+        if (auto destructor = context.builder.makeVariantDestructor(*variant))
+            context.ir->CreateCall(destructor, { ptr });
+
+        return true;
+    }
+
+    bool makeDestroyClosure(const Context &context, llvm::Value *ptr, const utils::Typename &type) {
+        auto function = std::get_if<utils::FunctionTypename>(&type);
+
+        if (!(function && function->kind == utils::FunctionKind::Regular))
+            return false;
+
+        // loaded whole, promote() can follow the environment through the closure value but not through a field
+        auto closure = context.ir->CreateLoad(context.builder.makeTypename(type), ptr);
+        auto environment = context.ir->CreateExtractValue(closure, 1);
+
+        // captured values need no destroy, the environment size is not kept so deallocate gets 0
+        auto size = llvm::ConstantInt::get(llvm::Type::getInt64Ty(context.builder.context), 0);
 
-        // TODO: this is scary but make destroy has to loop over the elements in the array...
-        //  ... and call ops::makeDestroy for each
+        ops::makeDeallocate(context, environment, size, llvm::Type::getInt8Ty(context.builder.context));
 
         return true;
     }
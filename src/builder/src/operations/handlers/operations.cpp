@@ -235,6 +235,22 @@ namespace kara::builder::ops::handlers {
         };
     }
 
+    Maybe<builder::Result> handlerEnumToBoolBase(
+        const Context &context, const builder::Result &left, const builder::Result &right, SimpleBaseImpl f) {
+        auto a = ops::makeRealType(context, left);
+        auto b = ops::makeRealType(context, right);
+
+        if (!std::holds_alternative<utils::EnumTypename>(a.type) || a.type != b.type)
+            return std::nullopt;
+
+        return builder::Result {
+            builder::Result::FlagTemporary,
+            context.ir ? f(*context.ir, ops::get(context, a), ops::get(context, b)) : nullptr,
+            utils::PrimitiveTypename { utils::PrimitiveType::Bool },
+            context.accumulator,
+        };
+    }
+
     Maybe<builder::Result> handlerBooleanBase(
         const Context &context, const builder::Result &left, const builder::Result &right, SimpleBaseImpl f) {
         auto bin = toBinary(context, left, right);
@@ -403,6 +419,44 @@ namespace kara::builder::ops::handlers {
         };
     }
 
+    Maybe<builder::Result> makeConvertForcedEnumToInt(
+        const Context &context, const builder::Result &result, const utils::Typename &type, bool force) {
+        auto from = std::get_if<utils::EnumTypename>(&result.type);
+        auto to = std::get_if<utils::PrimitiveTypename>(&type);
+
+        if (!(force && from && to && to->isInteger()))
+            return std::nullopt;
+
+        auto isSigned = context.builder.makeEnum(from->type)->underlying.isSigned();
+        auto llvmType = context.builder.makeTypename(type);
+
+        return builder::Result {
+            builder::Result::FlagTemporary,
+            context.ir ? context.ir->CreateIntCast(ops::get(context, result), llvmType, isSigned) : nullptr,
+            type,
+            context.accumulator,
+        };
+    }
+
+    // no check that the value is one of the cases, matching on it without an else arm is undefined if it is not
+    Maybe<builder::Result> makeConvertForcedIntToEnum(
+        const Context &context, const builder::Result &result, const utils::Typename &type, bool force) {
+        auto from = std::get_if<utils::PrimitiveTypename>(&result.type);
+        auto to = std::get_if<utils::EnumTypename>(&type);
+
+        if (!(force && from && to && from->isInteger()))
+            return std::nullopt;
+
+        auto llvmType = context.builder.makeTypename(type);
+
+        return builder::Result {
+            builder::Result::FlagTemporary,
+            context.ir ? context.ir->CreateIntCast(ops::get(context, result), llvmType, from->isSigned()) : nullptr,
+            type,
+            context.accumulator,
+        };
+    }
+
     Maybe<builder::Result> makeConvertForcedFuncPtrToFuncPtr(
         const Context &context, const builder::Result &result, const utils::Typename &type, bool force) {
         auto resultFunc = std::get_if<utils::FunctionTypename>(&result.type);
@@ -428,8 +482,7 @@ namespace kara::builder::ops::handlers {
         auto resultRef = asRef(result.type);
 
         auto check = [typeRef, resultRef]() {
-            auto validConvert
-                = typeRef->kind == utils::ReferenceKind::Regular && resultRef->kind != utils::ReferenceKind::Shared;
+            auto validConvert = typeRef->kind == utils::ReferenceKind::Regular;
             auto mutabilityOk = !typeRef->isMutable || resultRef->isMutable;
 
             return validConvert && mutabilityOk;
@@ -527,6 +580,138 @@ namespace kara::builder::ops::handlers {
         };
     }
 
+    Maybe<builder::Result> makeConvertArrayToIterable(
+        const Context &context, const builder::Result &result, const utils::Typename &type, bool force) {
+        auto iterable = std::get_if<utils::ArrayTypename>(&type);
+        if (!(iterable && iterable->kind == utils::ArrayKind::Iterable))
+            return std::nullopt;
+
+        auto array = std::get_if<utils::ArrayTypename>(ops::findRealType(result.type));
+        auto arrayIsUsable = [&]() {
+            return array->kind != utils::ArrayKind::Unbounded && array->kind != utils::ArrayKind::Iterable;
+        };
+        if (!(array && arrayIsUsable() && *array->value == *iterable->value))
+            return std::nullopt;
+
+        auto llvmValue = ops::makeAlloca(context, type);
+
+        if (context.ir) {
+            auto span = ops::makeArraySpan(context, ops::makeRealType(context, result));
+            assert(span);
+
+            auto [data, size] = *span;
+
+            auto iterableStructType = context.builder.makeIterableArrayType(*iterable->value);
+
+            context.ir->CreateStore(size, context.ir->CreateStructGEP(iterableStructType, llvmValue, 0));
+            context.ir->CreateStore(data, context.ir->CreateStructGEP(iterableStructType, llvmValue, 1));
+        }
+
+        // only a view, whatever result points to keeps ownership
+        return builder::Result {
+            builder::Result::FlagTemporary | builder::Result::FlagReference,
+            llvmValue,
+            type,
+            context.accumulator,
+        };
+    }
+
+    Maybe<builder::Result> makeConvertTupleElements(
+        const Context &context, const builder::Result &result, const utils::Typename &type, bool force) {
+        auto from = std::get_if<utils::TupleTypename>(&result.type);
+        auto to = std::get_if<utils::TupleTypename>(&type);
+
+        if (!from || !to || from->elements.size() != to->elements.size())
+            return std::nullopt;
+
+        // elements are taken out of the tuple, a variable would be left half moved
+        if (!result.isSet(builder::Result::FlagTemporary) && context.builder.needsDestroy(result.type))
+            return std::nullopt;
+
+        // check every element first, so a failed conversion leaves nothing behind
+        auto check = context.noIR();
+        check.accumulator = nullptr;
+
+        for (size_t a = 0; a < from->elements.size(); a++) {
+            auto element = builder::Result { builder::Result::FlagTemporary, nullptr, from->elements[a], nullptr };
+
+            if (!ops::makeConvert(check, element, to->elements[a], force))
+                return std::nullopt;
+        }
+
+        llvm::Value *aggregate = context.ir ? ops::get(context, ops::makePass(context, result)) : nullptr;
+
+        std::vector<builder::Result> elements;
+        elements.reserve(from->elements.size());
+
+        for (size_t a = 0; a < from->elements.size(); a++) {
+            auto element = builder::Result {
+                builder::Result::FlagTemporary,
+                aggregate ? context.ir->CreateExtractValue(aggregate, a) : nullptr,
+                from->elements[a],
+                context.accumulator,
+            };
+
+            auto converted = ops::makeConvert(context, element, to->elements[a], force);
+            assert(converted);
+
+            elements.push_back(*converted);
+        }
+
+        return ops::nouns::makeTuple(context, elements);
+    }
+
+    Maybe<builder::Result> makeConvertTypeToVariant(
+        const Context &context, const builder::Result &result, const utils::Typename &type, bool force) {
+        auto variant = std::get_if<utils::VariantTypename>(&type);
+
+        if (!variant)
+            return std::nullopt;
+
+        const auto &alternatives = variant->alternatives;
+
+        // an exact match wins, otherwise the value has to convert to exactly one alternative
+        auto index = static_cast<size_t>(
+            std::find(alternatives.begin(), alternatives.end(), result.type) - alternatives.begin());
+
+        if (index == alternatives.size()) {
+            auto check = context.noIR();
+            check.accumulator = nullptr;
+
+            for (size_t a = 0; a < alternatives.size(); a++) {
+                if (!ops::makeConvert(check, result, alternatives[a], force))
+                    continue;
+
+                if (index != alternatives.size())
+                    return std::nullopt;
+
+                index = a;
+            }
+
+            if (index == alternatives.size())
+                return std::nullopt;
+        }
+
+        llvm::Value *value = nullptr;
+
+        if (context.ir) {
+            auto converted = ops::makeConvert(context, result, alternatives[index], force);
+            assert(converted);
+
+            value = ops::makeAlloca(context, type);
+
+            ops::makeVariantStore(
+                context, value, *variant, index, ops::get(context, ops::makePass(context, *converted)));
+        }
+
+        return builder::Result {
+            builder::Result::FlagTemporary | builder::Result::FlagReference,
+            value,
+            type,
+            context.accumulator,
+        };
+    }
+
     Maybe<builder::Result> makeConvertExprArrayToUnboundedRef(
         const Context &context, const builder::Result &result, const utils::Typename &type, bool force) {
         auto lhs = std::get_if<utils::ReferenceTypename>(&result.type);
@@ -650,9 +835,7 @@ namespace kara::builder::ops::handlers {
 
         if (context.ir) {
             value = ops::makeAlloca(context, type);
-            auto llvmType = context.builder.makeTypename(type);
-            auto holdsPtr = context.ir->CreateStructGEP(llvmType, value, 0);
-            context.ir->CreateStore(context.ir->getInt1(false), holdsPtr);
+            ops::makeOptionalStore(context, value, *optional, nullptr);
         }
 
         return builder::Result {
@@ -683,11 +866,9 @@ namespace kara::builder::ops::handlers {
         if (!(optional && asPrimTo(type, utils::PrimitiveType::Bool)))
             return std::nullopt;
 
-        auto sourceType = context.builder.makeTypename(result.type);
-
         return builder::Result {
-            builder::Result::FlagTemporary | builder::Result::FlagReference,
-            context.ir ? context.ir->CreateStructGEP(sourceType, ops::ref(context, result), 0) : nullptr,
+            builder::Result::FlagTemporary,
+            context.ir ? ops::makeOptionalHolds(context, ops::ref(context, result), *optional) : nullptr,
             type,
             context.accumulator,
         };
@@ -710,13 +891,7 @@ namespace kara::builder::ops::handlers {
 
             value = ops::makeAlloca(context, type);
 
-            auto llvmType = context.builder.makeTypename(type);
-
-            auto holdsPtr = context.ir->CreateStructGEP(llvmType, value, 0);
-            auto valuePtr = context.ir->CreateStructGEP(llvmType, value, 1);
-
-            context.ir->CreateStore(context.ir->getInt1(true), holdsPtr);
-            context.ir->CreateStore(ops::get(context, *converted), valuePtr);
+            ops::makeOptionalStore(context, value, *optional, ops::get(context, *converted));
         }
 
         return builder::Result {
@@ -884,7 +1059,13 @@ namespace kara::builder::ops::handlers {
 
         // never captures builtins
 
-        auto function = context.builder.makeFunction((*iterator)->as<parser::Function>());
+        auto node = (*iterator)->as<parser::Function>();
+
+        // nothing to infer ^T from without a call
+        if (!node->generics.empty())
+            return std::nullopt;
+
+        auto function = context.builder.makeFunction(node);
 
         return builder::Result {
             builder::Result::FlagTemporary | builder::Result::FlagExplicit,
@@ -914,11 +1095,9 @@ namespace kara::builder::ops::handlers {
         if (!optional)
             return std::nullopt;
 
-        auto llvmType = context.builder.makeTypename(value.type);
-
         return builder::Result {
             builder::Result::FlagReference | (value.flags & builder::Result::FlagMutable),
-            context.ir ? context.ir->CreateStructGEP(llvmType, ops::ref(context, value), 1) : nullptr,
+            context.ir ? ops::makeOptionalValue(context, ops::ref(context, value), *optional) : nullptr,
             *optional->value,
             context.accumulator,
         };
@@ -935,7 +1114,8 @@ namespace kara::builder::ops::handlers {
 
         auto ref = std::get_if<utils::ReferenceTypename>(&value.type);
 
-        if (!ref || ref->kind != utils::ReferenceKind::Unique)
+        // moving a *shared T hands over the count it already holds, nothing to increment
+        if (!ref || ref->kind == utils::ReferenceKind::Regular)
             return std::nullopt;
 
         auto elementType = context.builder.makeTypename(*ref->value);
@@ -968,10 +1148,10 @@ namespace kara::builder::ops::handlers {
 
         auto array = std::get_if<utils::ArrayTypename>(&value.type);
 
-        if (!array || array->kind != utils::ArrayKind::VariableSize)
+        if (!array || (array->kind != utils::ArrayKind::VariableSize && array->kind != utils::ArrayKind::Hybrid))
             return std::nullopt;
 
-        auto arrayStructType = context.builder.makeVariableArrayType(*array->value);
+        auto arrayStructType = context.builder.makeTypename(*array);
 
         llvm::Value *movedValue = nullptr;
 
@@ -989,8 +1169,11 @@ namespace kara::builder::ops::handlers {
             auto pointerType = llvm::PointerType::get(elementType, 0);
             auto nullValue = llvm::ConstantPointerNull::get(pointerType);
 
+            // a hybrid array left behind still owns its inline storage
+            auto capacity = array->kind == utils::ArrayKind::Hybrid ? llvm::ConstantInt::get(i64, array->size) : zero;
+
             context.ir->CreateStore(zero, sizePtr);
-            context.ir->CreateStore(zero, capacityPtr);
+            context.ir->CreateStore(capacity, capacityPtr);
             context.ir->CreateStore(nullValue, dataPtr);
         }
 
@@ -1002,6 +1185,108 @@ namespace kara::builder::ops::handlers {
         };
     }
 
+    Maybe<builder::Result> makeMoveWithMap(const Context &context, const builder::Result &value) {
+        if (!value.isSet(builder::Result::FlagReference) || !value.isSet(builder::Result::FlagMutable))
+            return std::nullopt;
+
+        auto map = std::get_if<utils::MapTypename>(&value.type);
+
+        if (!map)
+            return std::nullopt;
+
+        auto mapStructType = context.builder.makeTypename(*map);
+
+        llvm::Value *movedValue = nullptr;
+
+        if (context.ir) {
+            movedValue = context.ir->CreateLoad(mapStructType, value.value);
+
+            context.ir->CreateStore(llvm::Constant::getNullValue(mapStructType), value.value);
+        }
+
+        return builder::Result {
+            builder::Result::FlagTemporary,
+            movedValue,
+            value.type,
+            context.accumulator,
+        };
+    }
+
+    Maybe<builder::Result> makeMoveWithTuple(const Context &context, const builder::Result &value) {
+        if (!value.isSet(builder::Result::FlagReference) || !value.isSet(builder::Result::FlagMutable))
+            return std::nullopt;
+
+        if (!std::holds_alternative<utils::TupleTypename>(value.type))
+            return std::nullopt;
+
+        llvm::Value *movedValue = nullptr;
+
+        if (context.ir) {
+            movedValue = context.ir->CreateLoad(context.builder.makeTypename(value.type), value.value);
+
+            // leaves every element the way a fresh tuple starts, so destroying the source is harmless
+            ops::makeInitialize(context, value.value, value.type);
+        }
+
+        return builder::Result {
+            builder::Result::FlagTemporary,
+            movedValue,
+            value.type,
+            context.accumulator,
+        };
+    }
+
+    Maybe<builder::Result> makeMoveWithVariant(const Context &context, const builder::Result &value) {
+        if (!value.isSet(builder::Result::FlagReference) || !value.isSet(builder::Result::FlagMutable))
+            return std::nullopt;
+
+        if (!std::holds_alternative<utils::VariantTypename>(value.type))
+            return std::nullopt;
+
+        llvm::Value *movedValue = nullptr;
+
+        if (context.ir) {
+            movedValue = context.ir->CreateLoad(context.builder.makeTypename(value.type), value.value);
+
+            // back to the first alternative, which owns nothing until it is assigned
+            ops::makeInitialize(context, value.value, value.type);
+        }
+
+        return builder::Result {
+            builder::Result::FlagTemporary,
+            movedValue,
+            value.type,
+            context.accumulator,
+        };
+    }
+
+    Maybe<builder::Result> makeMoveWithClosure(const Context &context, const builder::Result &value) {
+        if (!value.isSet(builder::Result::FlagReference) || !value.isSet(builder::Result::FlagMutable))
+            return std::nullopt;
+
+        auto function = std::get_if<utils::FunctionTypename>(&value.type);
+
+        if (!(function && function->kind == utils::FunctionKind::Regular))
+            return std::nullopt;
+
+        llvm::Value *movedValue = nullptr;
+
+        if (context.ir) {
+            movedValue = context.ir->CreateLoad(context.builder.makeTypename(value.type), value.value);
+
+            // the source keeps a null environment, destroying it frees nothing
+            ops::makeInitialize(context, value.value, value.type);
+        }
+
+        // explicit like the lambda it came from, so it is passed on instead of called
+        return builder::Result {
+            builder::Result::FlagTemporary | builder::Result::FlagExplicit,
+            movedValue,
+            value.type,
+            context.accumulator,
+        };
+    }
+
     Maybe<builder::Result> makeAddNumber(
         const Context &context, const builder::Result &left, const builder::Result &right) {
         return handlerNumberToNumberBase(context, left, right, [](auto &ir, auto a, auto b, auto &prim) {
@@ -1072,6 +1357,12 @@ namespace kara::builder::ops::handlers {
             context, left, right, [](auto &ir, auto a, auto b) { return ir.CreateICmpEQ(a, b); });
     }
 
+    Maybe<builder::Result> makeEQEnum(
+        const Context &context, const builder::Result &left, const builder::Result &right) {
+        return handlerEnumToBoolBase(
+            context, left, right, [](auto &ir, auto a, auto b) { return ir.CreateICmpEQ(a, b); });
+    }
+
     Maybe<builder::Result> makeNENumber(
         const Context &context, const builder::Result &left, const builder::Result &right) {
         return handlerNumberToBoolBase(context, left, right, [](auto &ir, auto a, auto b, auto &prim) {
@@ -1088,6 +1379,12 @@ namespace kara::builder::ops::handlers {
             context, left, right, [](auto &ir, auto a, auto b) { return ir.CreateICmpNE(a, b); });
     }
 
+    Maybe<builder::Result> makeNEEnum(
+        const Context &context, const builder::Result &left, const builder::Result &right) {
+        return handlerEnumToBoolBase(
+            context, left, right, [](auto &ir, auto a, auto b) { return ir.CreateICmpNE(a, b); });
+    }
+
     Maybe<builder::Result> makeGTNumber(
         const Context &context, const builder::Result &left, const builder::Result &right) {
         return handlerNumberToBoolBase(context, left, right, [](auto &ir, auto a, auto b, auto &prim) {
@@ -1179,17 +1476,16 @@ namespace kara::builder::ops::handlers {
             auto destType = context.builder.makeTypename(*optional->value);
             auto fallbackTemp = context.function->entry.CreateAlloca(destType, 0, nullptr, "fallback_temp");
 
-            auto boolType = llvm::Type::getInt1Ty(context.builder.context);
-            auto llvmType = context.builder.makeTypename(optionalValue.type);
             auto elementType = context.builder.makeTypename(*optional->value);
 
             // before branching
             auto leftRef = ops::ref(context, optionalValue);
-            auto holds = context.ir->CreateLoad(boolType, context.ir->CreateStructGEP(llvmType, leftRef, 0));
+            auto holds = ops::makeOptionalHolds(context, leftRef, *optional);
             context.ir->CreateCondBr(holds, holdsTrue, holdsFalse);
 
             // true block
-            auto leftValue = trueBuilder.CreateLoad(elementType, trueBuilder.CreateStructGEP(llvmType, leftRef, 1));
+            auto leftValue
+                = trueBuilder.CreateLoad(elementType, ops::makeOptionalValue(trueContext, leftRef, *optional));
             trueBuilder.CreateStore(leftValue, fallbackTemp);
             trueBuilder.CreateBr(next);
 
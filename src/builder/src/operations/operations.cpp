@@ -2,6 +2,7 @@
 #include <builder/operations.h>
 
 #include <builder/handlers.h>
+#include <builder/target.h>
 
 #include <fmt/format.h>
 
@@ -9,6 +10,292 @@
 #include <variant>
 
 namespace kara::builder::ops {
+    namespace {
+        // Helpers for interpolated strings, generated once per module.
+        // Numbers are written without any runtime format parsing, digits are counted first so one allocation fits all.
+
+        llvm::Function *makeFormatFunction(Builder &builder, const char *name, llvm::FunctionType *type) {
+            auto function = llvm::Function::Create(type, llvm::GlobalVariable::InternalLinkage, name, *builder.module);
+
+            function->addFnAttr(llvm::Attribute::NoUnwind);
+
+            return function;
+        }
+
+        // u64 -> decimal digits in value, at least 1
+        llvm::Function *getFormatDigits(Builder &builder) {
+            if (auto existing = builder.module->getFunction("format.digits"))
+                return existing;
+
+            auto i64 = llvm::Type::getInt64Ty(builder.context);
+
+            auto function = makeFormatFunction(builder, "format.digits", llvm::FunctionType::get(i64, { i64 }, false));
+
+            auto entry = llvm::BasicBlock::Create(builder.context, "entry", function);
+            auto loop = llvm::BasicBlock::Create(builder.context, "loop", function);
+            auto done = llvm::BasicBlock::Create(builder.context, "done", function);
+
+            llvm::IRBuilder<>(entry).CreateBr(loop);
+
+            llvm::IRBuilder<> loopBuilder(loop);
+
+            auto count = loopBuilder.CreatePHI(i64, 2, "count");
+            auto value = loopBuilder.CreatePHI(i64, 2, "value");
+
+            auto nextCount = loopBuilder.CreateAdd(count, loopBuilder.getInt64(1));
+            auto nextValue = loopBuilder.CreateUDiv(value, loopBuilder.getInt64(10));
+
+            count->addIncoming(loopBuilder.getInt64(1), entry);
+            count->addIncoming(nextCount, loop);
+            value->addIncoming(function->getArg(0), entry);
+            value->addIncoming(nextValue, loop);
+
+            loopBuilder.CreateCondBr(loopBuilder.CreateICmpUGT(value, loopBuilder.getInt64(9)), loop, done);
+
+            llvm::IRBuilder<>(done).CreateRet(count);
+
+            return function;
+        }
+
+        // (i8 *end, u64 value), writes the digits of value backwards from end
+        llvm::Function *getFormatWrite(Builder &builder) {
+            if (auto existing = builder.module->getFunction("format.write"))
+                return existing;
+
+            auto i8 = llvm::Type::getInt8Ty(builder.context);
+            auto i64 = llvm::Type::getInt64Ty(builder.context);
+            auto i8Pointer = llvm::Type::getInt8PtrTy(builder.context);
+
+            auto function = makeFormatFunction(builder, "format.write",
+                llvm::FunctionType::get(llvm::Type::getVoidTy(builder.context), { i8Pointer, i64 }, false));
+
+            auto entry = llvm::BasicBlock::Create(builder.context, "entry", function);
+            auto loop = llvm::BasicBlock::Create(builder.context, "loop", function);
+            auto done = llvm::BasicBlock::Create(builder.context, "done", function);
+
+            llvm::IRBuilder<>(entry).CreateBr(loop);
+
+            llvm::IRBuilder<> loopBuilder(loop);
+
+            auto end = loopBuilder.CreatePHI(i8Pointer, 2, "end");
+            auto value = loopBuilder.CreatePHI(i64, 2, "value");
+
+            auto nextValue = loopBuilder.CreateUDiv(value, loopBuilder.getInt64(10));
+            auto digit = loopBuilder.CreateSub(value, loopBuilder.CreateMul(nextValue, loopBuilder.getInt64(10)));
+
+            auto nextEnd = loopBuilder.CreateConstInBoundsGEP1_64(i8, end, -1);
+            auto character = loopBuilder.CreateAdd(loopBuilder.CreateTrunc(digit, i8), loopBuilder.getInt8('0'));
+            loopBuilder.CreateStore(character, nextEnd);
+
+            end->addIncoming(function->getArg(0), entry);
+            end->addIncoming(nextEnd, loop);
+            value->addIncoming(function->getArg(1), entry);
+            value->addIncoming(nextValue, loop);
+
+            loopBuilder.CreateCondBr(loopBuilder.CreateICmpUGT(value, loopBuilder.getInt64(9)), loop, done);
+
+            llvm::IRBuilder<>(done).CreateRetVoid();
+
+            return function;
+        }
+
+        // i8 * -> bytes before the first null
+        llvm::Function *getFormatLength(Builder &builder) {
+            if (auto existing = builder.module->getFunction("format.length"))
+                return existing;
+
+            auto i8 = llvm::Type::getInt8Ty(builder.context);
+            auto i64 = llvm::Type::getInt64Ty(builder.context);
+            auto i8Pointer = llvm::Type::getInt8PtrTy(builder.context);
+
+            auto function
+                = makeFormatFunction(builder, "format.length", llvm::FunctionType::get(i64, { i8Pointer }, false));
+
+            function->addFnAttr(llvm::Attribute::ReadOnly);
+
+            auto entry = llvm::BasicBlock::Create(builder.context, "entry", function);
+            auto loop = llvm::BasicBlock::Create(builder.context, "loop", function);
+            auto done = llvm::BasicBlock::Create(builder.context, "done", function);
+
+            llvm::IRBuilder<>(entry).CreateBr(loop);
+
+            llvm::IRBuilder<> loopBuilder(loop);
+
+            auto index = loopBuilder.CreatePHI(i64, 2, "index");
+
+            auto character = loopBuilder.CreateLoad(i8, loopBuilder.CreateInBoundsGEP(i8, function->getArg(0), index));
+            auto nextIndex = loopBuilder.CreateAdd(index, loopBuilder.getInt64(1));
+
+            index->addIncoming(loopBuilder.getInt64(0), entry);
+            index->addIncoming(nextIndex, loop);
+
+            loopBuilder.CreateCondBr(loopBuilder.CreateIsNotNull(character), loop, done);
+
+            llvm::IRBuilder<>(done).CreateRet(index);
+
+            return function;
+        }
+
+        // an insert measured in the first pass, either bytes to copy or a number to write
+        struct FormatPiece {
+            llvm::Value *length = nullptr;
+
+            llvm::Value *text = nullptr; // i8 *
+
+            llvm::Value *number = nullptr; // u64 magnitude
+            llvm::Value *negative = nullptr; // i1, null for unsigned
+        };
+
+        bool isTextElement(const utils::Typename &type) {
+            auto prim = std::get_if<utils::PrimitiveTypename>(&type);
+
+            return prim && (prim->type == utils::PrimitiveType::Byte || prim->type == utils::PrimitiveType::UByte);
+        }
+
+        FormatPiece makeFormatPiece(const Context &context, const builder::Result &insert) {
+            auto &builder = context.builder;
+            auto &ir = *context.ir;
+
+            auto value = ops::makeRealType(context, insert);
+
+            auto i64 = llvm::Type::getInt64Ty(builder.context);
+
+            if (auto prim = std::get_if<utils::PrimitiveTypename>(&value.type)) {
+                if (prim->type == utils::PrimitiveType::Bool) {
+                    auto condition = ops::get(context, value);
+
+                    return FormatPiece {
+                        ir.CreateSelect(condition, ir.getInt64(4), ir.getInt64(5)),
+                        ir.CreateSelect(
+                            condition, builder.makeStringConstant("true"), builder.makeStringConstant("false")),
+                    };
+                }
+
+                if (prim->isInteger()) {
+                    auto raw = ops::get(context, value);
+
+                    if (prim->isUnsigned()) {
+                        auto number = ir.CreateZExt(raw, i64);
+
+                        return FormatPiece { ir.CreateCall(getFormatDigits(builder), { number }), nullptr, number };
+                    }
+
+                    auto extended = ir.CreateSExt(raw, i64);
+
+                    // 0 - INT64_MIN wraps back to itself, which is still the right magnitude as a u64
+                    auto negative = ir.CreateICmpSLT(extended, ir.getInt64(0));
+                    auto number = ir.CreateSelect(negative, ir.CreateNeg(extended), extended);
+
+                    auto digits = ir.CreateCall(getFormatDigits(builder), { number });
+
+                    auto length = ir.CreateAdd(digits, ir.CreateZExt(negative, i64));
+
+                    return FormatPiece { length, nullptr, number, negative };
+                }
+            }
+
+            if (auto array = std::get_if<utils::ArrayTypename>(&value.type); array && isTextElement(*array->value)) {
+                auto i8Pointer = llvm::Type::getInt8PtrTy(builder.context);
+
+                if (array->kind == utils::ArrayKind::Unbounded) {
+                    auto text = ir.CreatePointerCast(ops::ref(context, value), i8Pointer);
+
+                    return FormatPiece { ir.CreateCall(getFormatLength(builder), { text }), text };
+                }
+
+                auto [data, size] = ops::makeArraySpan(context, value).value();
+
+                return FormatPiece { size, ir.CreatePointerCast(data, i8Pointer) };
+            }
+
+            die("Value of type {} cannot be inserted into a string.", toString(insert.type));
+        }
+
+        builder::Result makeFormat(const Context &context, const std::string &text,
+            const std::vector<std::pair<size_t, builder::Result>> &inserts) {
+            auto stringType = utils::ReferenceTypename {
+                std::make_shared<utils::Typename>(utils::ArrayTypename {
+                    utils::ArrayKind::Unbounded,
+                    std::make_shared<utils::Typename>(utils::PrimitiveTypename { utils::PrimitiveType::Byte }),
+                }),
+                true,
+                utils::ReferenceKind::Unique,
+            };
+
+            llvm::Value *result = nullptr;
+
+            if (context.ir) {
+                auto &builder = context.builder;
+                auto &ir = *context.ir;
+
+                auto i8 = llvm::Type::getInt8Ty(builder.context);
+                auto one = llvm::MaybeAlign(1);
+
+                std::vector<FormatPiece> pieces;
+                pieces.reserve(inserts.size());
+
+                // constant parts plus the null, inserts are added as they are measured
+                llvm::Value *total = ir.getInt64(text.size() + 1);
+
+                for (const auto &insert : inserts) {
+                    pieces.push_back(makeFormatPiece(context, insert.second));
+
+                    total = ir.CreateAdd(total, pieces.back().length);
+                }
+
+                auto constant = builder.makeStringConstant(text);
+
+                result = ops::makeAllocate(context, total, i8);
+
+                llvm::Value *cursor = result;
+                size_t written = 0;
+
+                auto writeText = [&](size_t until) {
+                    if (until == written)
+                        return;
+
+                    auto source = ir.CreateConstInBoundsGEP1_64(i8, constant, written);
+
+                    ir.CreateMemCpy(cursor, one, source, one, until - written);
+
+                    cursor = ir.CreateConstInBoundsGEP1_64(i8, cursor, until - written);
+                    written = until;
+                };
+
+                for (size_t a = 0; a < inserts.size(); a++) {
+                    const auto &piece = pieces[a];
+
+                    writeText(inserts[a].first);
+
+                    if (piece.text) {
+                        ir.CreateMemCpy(cursor, one, piece.text, one, piece.length);
+                    } else {
+                        // overwritten by the last digit when the number is not negative
+                        if (piece.negative)
+                            ir.CreateStore(ir.getInt8('-'), cursor);
+
+                        auto end = ir.CreateInBoundsGEP(i8, cursor, piece.length);
+
+                        ir.CreateCall(getFormatWrite(builder), { end, piece.number });
+                    }
+
+                    cursor = ir.CreateInBoundsGEP(i8, cursor, piece.length);
+                }
+
+                writeText(text.size());
+
+                ir.CreateStore(ir.getInt8(0), cursor);
+            }
+
+            return builder::Result {
+                builder::Result::FlagTemporary,
+                result,
+                stringType,
+                context.accumulator,
+            };
+        }
+    }
+
     namespace nouns {
         builder::Result makeSpecial(const Context &context, utils::SpecialType type) {
             switch (type) { // NOLINT(hicpp-multiway-paths-covered)
@@ -70,24 +357,14 @@ namespace kara::builder::ops {
         }
 
         builder::Result makeString(const Context &context, const std::string &text,
-            const std::unordered_map<size_t, builder::Result> &inserts) {
-            assert(inserts.empty());
+            const std::vector<std::pair<size_t, builder::Result>> &inserts) {
+            if (!inserts.empty())
+                return makeFormat(context, text, inserts);
 
             llvm::Value *ptr = nullptr;
 
-            if (context.ir) {
-                llvm::Constant *initial = llvm::ConstantDataArray::getString(context.builder.context, text);
-
-                std::string convertedText(text.size(), '.');
-
-                std::transform(text.begin(), text.end(), convertedText.begin(),
-                    [](char c) { return (std::isalpha(c) || std::isdigit(c)) ? c : '_'; });
-
-                auto variable = new llvm::GlobalVariable(*context.builder.module, initial->getType(), true,
-                    llvm::GlobalVariable::LinkageTypes::PrivateLinkage, initial, fmt::format("str_{}", convertedText));
-
-                ptr = context.ir->CreateStructGEP(initial->getType(), variable, 0);
-            }
+            if (context.ir)
+                ptr = context.builder.makeStringConstant(text);
 
             auto stringType = utils::ReferenceTypename {
                 std::make_shared<utils::Typename>(utils::ArrayTypename {
@@ -150,10 +427,73 @@ namespace kara::builder::ops {
             };
         }
 
-        builder::Result makeNew(const Context &context, const utils::Typename &type) {
-            auto ptr = ops::makeMalloc(context, type);
+        builder::Result makeTuple(const Context &context, const std::vector<builder::Result> &values) {
+            utils::TupleTypename type;
+            type.elements.reserve(values.size());
+
+            for (const auto &result : values)
+                type.elements.push_back(result.type);
+
+            llvm::Value *value = nullptr;
+
+            if (context.ir) {
+                value = llvm::UndefValue::get(context.builder.makeTypename(type));
+
+                for (size_t a = 0; a < values.size(); a++) {
+                    auto element = ops::makePass(context, values[a]);
+
+                    value = context.ir->CreateInsertValue(value, ops::get(context, element), a);
+                }
+            }
+
+            return builder::Result {
+                builder::Result::FlagTemporary,
+                value,
+                type,
+                context.accumulator,
+            };
+        }
+
+        builder::Result makeNew(const Context &context, const utils::Typename &type, bool initialize, bool shared) {
+            // zeroing is left to calloc when that is all initializing would do
+            auto zeroed = initialize && context.builder.initializesToZero(type);
+
+            llvm::Value *ptr = nullptr;
+
+            if (!shared) {
+                ptr = ops::makeMalloc(context, type, "", zeroed);
+
+                if (ptr && context.function) {
+                    if (auto call = llvm::dyn_cast<llvm::CallInst>(ptr->stripPointerCasts()))
+                        context.function->heapAllocations.emplace_back(call, context.builder.makeTypename(type));
+                }
+            } else {
+                auto array = std::get_if<utils::ArrayTypename>(&type);
+
+                if (array
+                    && (array->kind == utils::ArrayKind::Unbounded || array->kind == utils::ArrayKind::UnboundedSized))
+                    die("Type {} cannot be allocated as shared, its size is not known.", toString(type));
+
+                // not added to heapAllocations, other owners can keep the block alive past this function
+                if (context.ir) {
+                    auto sizeType = llvm::Type::getInt64Ty(context.builder.context);
+                    auto blockType = context.builder.makeSharedType(type);
+                    auto bytes
+                        = llvm::ConstantInt::get(sizeType, context.builder.target.layout->getTypeStoreSize(blockType));
 
-            ops::makeInitialize(context, ptr, type);
+                    auto memory = zeroed ? ops::makeAllocateZeroed(context, bytes, blockType)
+                                         : ops::makeAllocate(context, bytes, blockType);
+                    auto block = context.ir->CreatePointerCast(memory, llvm::PointerType::get(blockType, 0));
+
+                    context.ir->CreateStore(
+                        llvm::ConstantInt::get(sizeType, 1), context.ir->CreateStructGEP(blockType, block, 0));
+
+                    ptr = context.ir->CreateStructGEP(blockType, block, 1);
+                }
+            }
+
+            if (initialize && !zeroed)
+                ops::makeInitialize(context, ptr, type);
 
             return builder::Result {
                 builder::Result::FlagTemporary,
@@ -161,11 +501,74 @@ namespace kara::builder::ops {
                 utils::ReferenceTypename {
                     std::make_shared<utils::Typename>(type),
                     true,
-                    utils::ReferenceKind::Unique,
+                    shared ? utils::ReferenceKind::Shared : utils::ReferenceKind::Unique,
                 },
                 context.accumulator,
             };
         }
+
+        builder::Result makeClosure(const Context &context, const parser::Lambda *node) {
+            assert(context.cache);
+
+            auto function = context.builder.makeLambda(node, context.function, *context.cache);
+
+            if (!context.ir) {
+                return builder::Result {
+                    builder::Result::FlagTemporary | builder::Result::FlagExplicit,
+                    nullptr,
+                    function->type,
+                    context.accumulator,
+                };
+            }
+
+            auto closureType = context.builder.makeTypename(function->type);
+            auto functionType = llvm::PointerType::get(context.builder.makeClosureFunctionType(function->type), 0);
+
+            auto dataType = llvm::Type::getInt8PtrTy(context.builder.context);
+
+            llvm::Value *environment = llvm::ConstantPointerNull::get(dataType);
+
+            if (function->environment) {
+                auto bytes = context.builder.target.layout->getTypeStoreSize(function->environment);
+                auto size = llvm::ConstantInt::get(llvm::Type::getInt64Ty(context.builder.context), bytes);
+
+                environment = ops::makeAllocate(context, size, function->environment);
+
+                // same as new, stays on the stack if the closure never leaves this function
+                if (context.function) {
+                    if (auto call = llvm::dyn_cast<llvm::CallInst>(environment))
+                        context.function->heapAllocations.emplace_back(call, function->environment);
+                }
+
+                auto pointer
+                    = context.ir->CreatePointerCast(environment, llvm::PointerType::get(function->environment, 0));
+
+                for (size_t a = 0; a < function->captures.size(); a++) {
+                    auto &[capture, captureType] = function->captures[a];
+
+                    auto variable = context.cache->find(&Cache::variables, capture);
+                    assert(variable);
+
+                    auto value = context.ir->CreateLoad(context.builder.makeTypename(captureType), variable->value);
+
+                    context.ir->CreateStore(value, context.ir->CreateStructGEP(function->environment, pointer, a));
+                }
+            }
+
+            llvm::Value *value = llvm::UndefValue::get(closureType);
+
+            value = context.ir->CreateInsertValue(
+                value, context.ir->CreatePointerCast(function->function, functionType), 0);
+            value = context.ir->CreateInsertValue(value, environment, 1);
+
+            // explicit so it is passed around instead of being called like a function name
+            return builder::Result {
+                builder::Result::FlagTemporary | builder::Result::FlagExplicit,
+                value,
+                function->type,
+                context.accumulator,
+            };
+        }
     }
 
     namespace unary {
@@ -232,6 +635,10 @@ namespace kara::builder::ops {
                 std::array {
                     handlers::makeMoveWithUnique,
                     handlers::makeMoveWithVariableArray,
+                    handlers::makeMoveWithMap,
+                    handlers::makeMoveWithTuple,
+                    handlers::makeMoveWithVariant,
+                    handlers::makeMoveWithClosure,
                 },
                 context, infer);
 
@@ -286,6 +693,7 @@ namespace kara::builder::ops {
                            std::array {
                                handlers::makeEQNumber,
                                handlers::makeEQRef,
+                               handlers::makeEQEnum,
                            },
                            context, left, right),
                 "Cannot use operator on ls of type {} and rs of type {}.", toString(left.type), toString(right.type));
@@ -295,6 +703,7 @@ namespace kara::builder::ops {
                            std::array {
                                handlers::makeNENumber,
                                handlers::makeNERef,
+                               handlers::makeNEEnum,
                            },
                            context, left, right),
                 "Cannot use operator on ls of type {} and rs of type {}.", toString(left.type), toString(right.type));
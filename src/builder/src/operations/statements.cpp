@@ -7,6 +7,8 @@
 #include <parser/variable.h>
 
 #include <cassert>
+#include <algorithm>
+#include <unordered_set>
 
 namespace kara::builder::ops::statements {
     void exit(const Context &context, ExitPoint point) {
@@ -143,7 +145,71 @@ namespace kara::builder::ops::statements {
 
             jumpBuilder.CreateCondBr(ops::get(jumpContext, conditionResult), scope, nextBlock);
         } else if (condition->is(parser::Kind::ForIn)) {
-            throw;
+            auto forIn = condition->as<parser::ForIn>();
+            auto variable = forIn->name();
+
+            auto arrayResult = ops::makeRealType(context, ops::expression::make(context, forIn->expression()));
+            auto array = std::get_if<utils::ArrayTypename>(&arrayResult.type);
+
+            if (!array || array->kind == utils::ArrayKind::Unbounded) {
+                throw VerifyError(forIn->expression(),
+                    "For in loop must iterate over an array with a known size, got {}.", toString(arrayResult.type));
+            }
+
+            const utils::Typename &elementType = *array->value;
+
+            if (variable->hasFixedType && context.builder.resolveTypename(variable->fixedType()) != elementType) {
+                throw VerifyError(variable, "Loop variable must have element type {}, got {}.", toString(elementType),
+                    toString(context.builder.resolveTypename(variable->fixedType())));
+            }
+
+            if (variable->isMutable && !arrayResult.isSet(builder::Result::FlagMutable)) {
+                throw VerifyError(
+                    variable, "Loop variable cannot be mutable, array {} is not.", toString(arrayResult.type));
+            }
+
+            // size and data are read once, the body must not resize the array
+            auto [data, size] = ops::makeArraySpan(context, arrayResult).value();
+
+            auto elementLLVMType = context.builder.makeTypename(elementType);
+            auto end = context.ir->CreateInBoundsGEP(elementLLVMType, data, size, "end");
+
+            auto blockCurrent = context.ir->GetInsertBlock();
+            auto after = blockCurrent->getNextNode();
+
+            auto checkBlock
+                = llvm::BasicBlock::Create(context.builder.context, "check", context.function->function, after);
+            auto jumpBlock
+                = llvm::BasicBlock::Create(context.builder.context, "jump", context.function->function, after);
+
+            auto nextBlock = llvm::BasicBlock::Create(context.builder.context, "", context.function->function, after);
+
+            llvm::IRBuilder<> checkBuilder(checkBlock);
+
+            auto cursor = checkBuilder.CreatePHI(data->getType(), 2, "cursor");
+            cursor->addIncoming(data, blockCurrent);
+
+            llvm::IRBuilder<> jumpBuilder(jumpBlock);
+
+            cursor->addIncoming(jumpBuilder.CreateConstInBoundsGEP1_64(elementLLVMType, cursor, 1), jumpBlock);
+            jumpBuilder.CreateBr(checkBlock);
+
+            Context loopContext = context;
+            loopContext.cache = context.cache->create();
+
+            loopContext.cache->variables[variable] = std::make_unique<builder::Variable>(variable, elementType, cursor);
+
+            auto scope = ops::statements::makeScope(loopContext, code,
+                {
+                    { ExitPoint::Break, nextBlock },
+                    { ExitPoint::Regular, jumpBlock },
+                    { ExitPoint::Continue, jumpBlock },
+                });
+
+            context.ir->CreateBr(checkBlock);
+            context.ir->SetInsertPoint(nextBlock);
+
+            checkBuilder.CreateCondBr(checkBuilder.CreateICmpNE(cursor, end), scope, nextBlock);
         }
     }
 
@@ -303,6 +369,302 @@ namespace kara::builder::ops::statements {
         }
     }
 
+    std::vector<std::unique_ptr<builder::Variable>> makeUnpack(const Context &context, const parser::Unpack *node) {
+        assert(context.function);
+
+        auto result = ops::expression::make(context, node->value());
+
+        auto tuple = std::get_if<utils::TupleTypename>(&result.type);
+
+        if (!tuple)
+            throw VerifyError(node->value(), "Cannot unpack type {}, expected a tuple.", toString(result.type));
+
+        auto names = node->names();
+
+        if (names.size() != tuple->elements.size()) {
+            throw VerifyError(node, "Cannot unpack tuple {} with {} elements into {} names.", toString(*tuple),
+                tuple->elements.size(), names.size());
+        }
+
+        result = ops::makePass(context, result);
+
+        // the elements come straight out of the value, the tuple itself is never spilled
+        llvm::Value *aggregate = context.ir ? ops::get(context, result) : nullptr;
+
+        std::vector<std::unique_ptr<builder::Variable>> variables;
+        variables.reserve(names.size());
+
+        for (size_t a = 0; a < names.size(); a++) {
+            const auto &type = tuple->elements[a];
+
+            llvm::Value *value = nullptr;
+
+            if (context.ir) {
+                value = ops::makeAlloca(context, type, names[a]->name);
+
+                context.ir->CreateStore(context.ir->CreateExtractValue(aggregate, a), value);
+            }
+
+            variables.push_back(std::make_unique<builder::Variable>(names[a], type, value));
+        }
+
+        return variables;
+    }
+
+    namespace {
+        // name Type => { ... } arms, a switch on the tag
+        void makeMatchVariant(const Context &context, const parser::Match *node, const builder::Result &result) {
+            auto variant = std::get_if<utils::VariantTypename>(&result.type);
+            assert(variant);
+
+            const auto &alternatives = variant->alternatives;
+
+            const parser::MatchArm *defaultArm = nullptr;
+            std::vector<std::pair<size_t, const parser::MatchArm *>> cases;
+
+            std::vector<bool> handled(alternatives.size());
+
+            for (auto arm : node->arms()) {
+                if (arm->isDefault) {
+                    if (defaultArm)
+                        throw VerifyError(arm, "Match can only have one else arm.");
+
+                    defaultArm = arm;
+
+                    continue;
+                }
+
+                auto binding = arm->binding();
+
+                if (!binding)
+                    throw VerifyError(arm->pattern(), "Match on variant {} takes name Type arms.", toString(*variant));
+
+                auto type = context.builder.resolveTypename(binding->fixedType());
+
+                auto index = static_cast<size_t>(
+                    std::find(alternatives.begin(), alternatives.end(), type) - alternatives.begin());
+
+                if (index == alternatives.size())
+                    throw VerifyError(binding, "Variant {} cannot hold {}.", toString(*variant), toString(type));
+
+                if (handled[index])
+                    throw VerifyError(arm, "Alternative {} is matched more than once.", toString(type));
+
+                if (binding->isMutable && !result.isSet(builder::Result::FlagMutable))
+                    throw VerifyError(binding, "Binding cannot be mutable, {} is not.", toString(result.type));
+
+                handled[index] = true;
+                cases.emplace_back(index, arm);
+            }
+
+            if (!defaultArm) {
+                auto missing = std::find(handled.begin(), handled.end(), false);
+
+                if (missing != handled.end()) {
+                    throw VerifyError(node, "Match does not handle alternative {}, add an arm for it or an else arm.",
+                        toString(alternatives[missing - handled.begin()]));
+                }
+            }
+
+            // read before branching, every arm binds straight to the storage of the matched value
+            auto ptr = ops::ref(context, result);
+            auto tag = ops::makeVariantTag(context, ptr, *variant);
+            auto tagType = context.builder.makeVariantTagType(*variant);
+
+            std::vector<llvm::Value *> values(cases.size());
+
+            for (size_t a = 0; a < cases.size(); a++)
+                values[a] = ops::makeVariantValue(context, ptr, *variant, cases[a].first);
+
+            auto after = context.ir->GetInsertBlock()->getNextNode();
+
+            auto nextBlock = llvm::BasicBlock::Create(context.builder.context, "", context.function->function, after);
+
+            llvm::BasicBlock *defaultBlock = nullptr;
+
+            if (defaultArm) {
+                defaultBlock
+                    = ops::statements::makeScope(context, defaultArm->body(), { { ExitPoint::Regular, nextBlock } });
+            } else {
+                // every alternative has an arm, no other tag can show up
+                defaultBlock = llvm::BasicBlock::Create(
+                    context.builder.context, "unreachable", context.function->function, nextBlock);
+
+                llvm::IRBuilder<>(defaultBlock).CreateUnreachable();
+            }
+
+            auto inst = context.ir->CreateSwitch(tag, defaultBlock, cases.size());
+
+            for (size_t a = 0; a < cases.size(); a++) {
+                auto [index, arm] = cases[a];
+                auto binding = arm->binding();
+
+                Context armContext = context;
+                armContext.cache = context.cache->create();
+
+                armContext.cache->variables[binding]
+                    = std::make_unique<builder::Variable>(binding, alternatives[index], values[a]);
+
+                auto scope = ops::statements::makeScope(armContext, arm->body(), { { ExitPoint::Regular, nextBlock } });
+
+                inst->addCase(llvm::ConstantInt::get(tagType, index), scope);
+            }
+
+            context.ir->SetInsertPoint(nextBlock);
+        }
+
+        // value => { ... } arms, a switch when every value folds to an integer constant, == checks in order otherwise
+        void makeMatchValue(const Context &context, const parser::Match *node, const builder::Result &result) {
+            const parser::MatchArm *defaultArm = nullptr;
+            std::vector<const parser::MatchArm *> arms;
+
+            for (auto arm : node->arms()) {
+                if (arm->isDefault) {
+                    if (defaultArm)
+                        throw VerifyError(arm, "Match can only have one else arm.");
+
+                    defaultArm = arm;
+
+                    continue;
+                }
+
+                if (!arm->pattern())
+                    throw VerifyError(arm->binding(), "Cannot match {} by type.", toString(result.type));
+
+                arms.push_back(arm);
+            }
+
+            auto function = context.function->function;
+
+            // read once, every arm compares against the same value
+            auto value = builder::Result {
+                builder::Result::FlagTemporary,
+                ops::get(context, result),
+                result.type,
+                nullptr,
+            };
+
+            auto after = context.ir->GetInsertBlock()->getNextNode();
+
+            auto nextBlock = llvm::BasicBlock::Create(context.builder.context, "", function, after);
+            auto destinations = Destinations { { ExitPoint::Regular, nextBlock } };
+
+            std::vector<llvm::BasicBlock *> checks(arms.size()); // first block of each check
+            std::vector<llvm::BasicBlock *> ends(arms.size()); // where each check continues after its value
+            std::vector<builder::Result> patterns;
+            std::vector<llvm::ConstantInt *> constants(arms.size());
+
+            // temporaries of a pattern are destroyed in its own check, later checks are not always reached
+            std::vector<Accumulator> accumulators(arms.size());
+
+            patterns.reserve(arms.size());
+
+            auto primitive = std::get_if<utils::PrimitiveTypename>(&result.type);
+            auto isEnum = std::holds_alternative<utils::EnumTypename>(result.type);
+
+            auto isIntegral = primitive && (primitive->isInteger() || primitive->type == utils::PrimitiveType::Bool);
+
+            bool isSwitch = isEnum || isIntegral;
+
+            for (size_t a = 0; a < arms.size(); a++) {
+                checks[a] = llvm::BasicBlock::Create(context.builder.context, "match_check", function, nextBlock);
+
+                llvm::IRBuilder<> checkBuilder(checks[a]);
+                auto checkContext = context.move(&checkBuilder);
+                checkContext.accumulator = &accumulators[a];
+
+                auto pattern = ops::expression::make(checkContext, arms[a]->pattern());
+
+                if (auto converted = ops::makeConvert(checkContext, pattern, result.type)) {
+                    pattern = *converted;
+
+                    if (!pattern.isSet(builder::Result::FlagReference))
+                        constants[a] = llvm::dyn_cast_or_null<llvm::ConstantInt>(pattern.value);
+                }
+
+                // a value that folded to a constant left nothing behind in its check
+                isSwitch = isSwitch && constants[a] && checks[a]->empty() && checkBuilder.GetInsertBlock() == checks[a];
+
+                ends[a] = checkBuilder.GetInsertBlock();
+                patterns.push_back(pattern);
+            }
+
+            if (isSwitch) {
+                for (auto check : checks)
+                    check->eraseFromParent();
+
+                std::unordered_set<uint64_t> seen;
+
+                for (size_t a = 0; a < arms.size(); a++) {
+                    if (!seen.insert(constants[a]->getZExtValue()).second)
+                        throw VerifyError(arms[a]->pattern(), "Value is matched more than once.");
+                }
+
+                // every case of the enum has an arm, no other value can show up
+                auto isExhaustive = isEnum && [&]() {
+                    auto builderEnum = context.builder.makeEnum(std::get<utils::EnumTypename>(result.type).type);
+
+                    return std::all_of(builderEnum->values.begin(), builderEnum->values.end(),
+                        [&seen](const auto &pair) { return seen.find(pair.second->getZExtValue()) != seen.end(); });
+                }();
+
+                llvm::BasicBlock *defaultBlock = nextBlock;
+
+                if (defaultArm) {
+                    defaultBlock = ops::statements::makeScope(context, defaultArm->body(), destinations);
+                } else if (isExhaustive) {
+                    defaultBlock = llvm::BasicBlock::Create(context.builder.context, "", function, nextBlock);
+
+                    llvm::IRBuilder<>(defaultBlock).CreateUnreachable();
+                }
+
+                // dense values become a jump table when LLVM lowers the switch
+                auto inst = context.ir->CreateSwitch(value.value, defaultBlock, arms.size());
+
+                for (size_t a = 0; a < arms.size(); a++) {
+                    auto scope = ops::statements::makeScope(context, arms[a]->body(), destinations);
+
+                    inst->addCase(constants[a], scope);
+                }
+            } else {
+                auto defaultBlock
+                    = defaultArm ? ops::statements::makeScope(context, defaultArm->body(), destinations) : nextBlock;
+
+                context.ir->CreateBr(arms.empty() ? defaultBlock : checks.front());
+
+                for (size_t a = 0; a < arms.size(); a++) {
+                    llvm::IRBuilder<> checkBuilder(ends[a]);
+                    auto checkContext = context.move(&checkBuilder);
+                    checkContext.accumulator = &accumulators[a];
+
+                    auto equal = ops::blame(arms[a]->pattern(), ops::binary::makeEQ, checkContext, value, patterns[a]);
+                    auto condition = ops::get(checkContext, equal);
+
+                    accumulators[a].commit(checkContext);
+
+                    auto scope = ops::statements::makeScope(context, arms[a]->body(), destinations);
+                    auto otherwise = a + 1 < arms.size() ? checks[a + 1] : defaultBlock;
+
+                    checkBuilder.CreateCondBr(condition, scope, otherwise);
+                }
+            }
+
+            context.ir->SetInsertPoint(nextBlock);
+        }
+    }
+
+    void makeMatch(const Context &context, const parser::Match *node) {
+        assert(context.ir);
+        assert(context.function);
+
+        auto result = ops::makeRealType(context, ops::expression::make(context, node->value()));
+
+        if (std::holds_alternative<utils::VariantTypename>(result.type))
+            makeMatchVariant(context, node, result);
+        else
+            makeMatchValue(context, node, result);
+    }
+
     llvm::BasicBlock *makeScope(const Context &parent, const parser::Code *node, const Destinations &destinations) {
         assert(node);
 
@@ -356,6 +718,20 @@ namespace kara::builder::ops::statements {
                     break;
                 }
 
+                case parser::Kind::Unpack: {
+                    auto variables = ops::statements::makeUnpack(context, child->as<parser::Unpack>());
+
+                    llvm::IRBuilder<> exitBuilder(exitInfo.exitChainBegin, exitInfo.exitChainBegin->begin());
+
+                    for (auto &var : variables) {
+                        ops::makeDestroy(context.move(&exitBuilder), var->value, var->type);
+
+                        cache->variables[var->node] = std::move(var);
+                    }
+
+                    break;
+                }
+
                 case parser::Kind::Assign:
                     ops::statements::makeAssign(context, child->as<parser::Assign>());
                     break;
@@ -377,6 +753,10 @@ namespace kara::builder::ops::statements {
                     ops::statements::makeFor(context, child->as<parser::For>());
                     break;
 
+                case parser::Kind::Match:
+                    ops::statements::makeMatch(context, child->as<parser::Match>());
+                    break;
+
                 case parser::Kind::Expression:
                     ops::expression::make(context, child->as<parser::Expression>());
                     break;
@@ -70,45 +70,205 @@ namespace kara::builder::ops {
                 throw std::runtime_error(fmt::format("Attempt to allocate type {} on stack.", toString(type)));
 
             if (array->kind == utils::ArrayKind::UnboundedSized)
-                throw std::runtime_error(
-                    fmt::format("VLA unsupported for type {0}. Use *{0} for allocation instead.", toString(type)));
+                throw std::runtime_error(fmt::format(
+                    "Type {0} can only be placed on the stack by a variable without a value. Use *{0} instead.",
+                    toString(type)));
         }
 
         return context.function->entry.CreateAlloca(context.builder.makeTypename(type), nullptr, name);
     }
 
-    llvm::Value *makeMalloc(const Context &context, const utils::Typename &type, const std::string &name) {
-        llvm::Value *arraySize = nullptr;
+    namespace {
+        // evaluates the expression of a [T:expr] once, later uses (size, allocation) read it from the cache
+        llvm::Value *makeUnboundedLength(const Context &context, const utils::ArrayTypename &array) {
+            assert(array.expression && context.cache);
 
-        if (auto array = std::get_if<utils::ArrayTypename>(&type)) {
-            if (array->kind == utils::ArrayKind::Unbounded)
-                throw std::runtime_error(fmt::format("Attempt to allocate type {} on heap.", toString(type)));
+            auto it = context.cache->find(&Cache::expressions, array.expression);
+            if (it)
+                return ops::get(context, *it);
 
-            if (array->kind == utils::ArrayKind::UnboundedSized) {
-                assert(array->expression && context.cache);
+            auto length = ops::expression::make(context, array.expression);
+            auto ulongTypename = utils::PrimitiveTypename { utils::PrimitiveType::ULong };
 
-                auto it = context.cache->find(&Cache::expressions, array->expression);
-                if (it) {
-                    arraySize = ops::get(context, *it);
-                } else {
-                    auto length = ops::expression::make(context, array->expression);
-                    auto ulongTypename = utils::PrimitiveTypename { utils::PrimitiveType::ULong };
+            auto converted = ops::makeConvert(context, length, ulongTypename);
 
-                    auto converted = ops::makeConvert(context, length, ulongTypename);
+            if (!converted) {
+                die("Expression cannot be converted to ulong for size for array.");
+            }
 
-                    if (!converted) {
-                        die("Expression cannot be converted to ulong for size for array.");
-                    }
+            auto &result = *converted;
 
-                    auto &result = *converted;
+            context.cache->expressions.insert({
+                array.expression,
+                std::make_unique<builder::Result>(result), // guaranteed to be ulong?
+            });
 
-                    context.cache->expressions.insert({
-                        array->expression,
-                        std::make_unique<builder::Result>(result), // guaranteed to be ulong?
-                    });
+            return ops::get(context, result);
+        }
+    }
 
-                    arraySize = ops::get(context, result);
-                }
+    llvm::Value *makeStackArray(const Context &context, const utils::ArrayTypename &type, const std::string &name) {
+        assert(context.function && context.exitInfo);
+        assert(type.kind == utils::ArrayKind::UnboundedSized);
+
+        auto length = makeUnboundedLength(context, type);
+
+        if (!context.ir)
+            return nullptr;
+
+        auto &builder = context.builder;
+
+        auto elementType = builder.makeTypename(*type.value);
+        auto elementPointer = llvm::PointerType::get(elementType, 0);
+
+        auto sizeType = llvm::Type::getInt64Ty(builder.context);
+        auto dataType = llvm::Type::getInt8PtrTy(builder.context);
+
+        auto elementSize = llvm::ConstantInt::get(sizeType, builder.target.layout->getTypeAllocSize(elementType));
+        auto limit = llvm::ConstantInt::get(sizeType, builder.options.stackArrayLimit);
+
+        // a wrapped byte count would pass the limit, so an overflow goes down the heap path and traps there
+        auto product = context.ir->CreateIntrinsic(
+            llvm::Intrinsic::umul_with_overflow, { sizeType }, { length, elementSize });
+
+        auto bytes = context.ir->CreateExtractValue(product, 0);
+        auto overflow = context.ir->CreateExtractValue(product, 1);
+
+        auto fits = context.ir->CreateAnd(context.ir->CreateICmpULE(bytes, limit), context.ir->CreateNot(overflow));
+
+        // saved on both paths so the release does not have to branch
+        auto saved = context.ir->CreateIntrinsic(llvm::Intrinsic::stacksave, {}, {});
+
+        auto blockCurrent = context.ir->GetInsertBlock();
+
+        auto blockDone = llvm::BasicBlock::Create(
+            builder.context, "vla_done", blockCurrent->getParent(), blockCurrent->getNextNode());
+        auto blockOverflow = llvm::BasicBlock::Create(
+            builder.context, "vla_overflow", blockCurrent->getParent(), blockCurrent->getNextNode());
+        auto blockHeap = llvm::BasicBlock::Create(
+            builder.context, "vla_heap", blockCurrent->getParent(), blockCurrent->getNextNode());
+        auto blockCheck = llvm::BasicBlock::Create(
+            builder.context, "vla_check", blockCurrent->getParent(), blockCurrent->getNextNode());
+        auto blockStack = llvm::BasicBlock::Create(
+            builder.context, "vla_stack", blockCurrent->getParent(), blockCurrent->getNextNode());
+
+        context.ir->CreateCondBr(fits, blockStack, blockCheck);
+
+        llvm::IRBuilder<> checkBuilder(blockCheck);
+        checkBuilder.CreateCondBr(overflow, blockOverflow, blockHeap);
+
+        llvm::IRBuilder<> overflowBuilder(blockOverflow);
+        overflowBuilder.CreateIntrinsic(llvm::Intrinsic::trap, {}, {});
+        overflowBuilder.CreateUnreachable();
+
+        llvm::IRBuilder<> stackBuilder(blockStack);
+
+        auto stackData = stackBuilder.CreateAlloca(elementType, length);
+        stackData->setAlignment(builder.target.layout->getPrefTypeAlign(elementType));
+
+        stackBuilder.CreateBr(blockDone);
+
+        llvm::IRBuilder<> heapBuilder(blockHeap);
+
+        auto heapData = heapBuilder.CreatePointerCast(
+            ops::makeAllocate(context.move(&heapBuilder), bytes, elementType), elementPointer);
+
+        heapBuilder.CreateBr(blockDone);
+
+        context.ir->SetInsertPoint(blockDone);
+
+        auto data = context.ir->CreatePHI(elementPointer, 2, name);
+        data->addIncoming(stackData, blockStack);
+        data->addIncoming(heapData, blockHeap);
+
+        makeInitializeElements(context, data, length, *type.value);
+
+        // goes in front of the exit chain, exits taken before this point never reach it
+        auto exitChain = context.exitInfo->exitChainBegin;
+        auto function = context.function->function;
+
+        auto blockRelease = llvm::BasicBlock::Create(builder.context, "vla_release", function, exitChain);
+        auto blockFree = llvm::BasicBlock::Create(builder.context, "vla_free", function, exitChain);
+
+        llvm::IRBuilder<> releaseBuilder(blockRelease);
+
+        // same per type loop as [T] elements, nothing to call if T needs no destroy
+        if (auto destructor = builder.makeElementDestructor(*type.value))
+            releaseBuilder.CreateCall(destructor, { data, length });
+
+        releaseBuilder.CreateIntrinsic(llvm::Intrinsic::stackrestore, {}, { saved });
+
+        // only the heap path deallocates, deallocate hooks do not have to accept null
+        releaseBuilder.CreateCondBr(fits, exitChain, blockFree);
+
+        llvm::IRBuilder<> freeBuilder(blockFree);
+
+        ops::makeDeallocate(
+            context.move(&freeBuilder), freeBuilder.CreatePointerCast(data, dataType), bytes, elementType);
+
+        freeBuilder.CreateBr(exitChain);
+
+        context.exitInfo->exitChainBegin = blockRelease;
+
+        return data;
+    }
+
+    void makeInitializeElements(
+        const Context &context, llvm::Value *data, llvm::Value *size, const utils::Typename &type) {
+        assert(context.ir);
+
+        auto &builder = context.builder;
+
+        auto elementType = builder.makeTypename(type);
+        auto sizeType = llvm::Type::getInt64Ty(builder.context);
+
+        if (builder.initializesToZero(type)) {
+            auto elementSize = llvm::ConstantInt::get(sizeType, builder.target.layout->getTypeAllocSize(elementType));
+
+            context.ir->CreateMemSet(data, context.ir->getInt8(0), context.ir->CreateMul(size, elementSize),
+                builder.target.layout->getPrefTypeAlign(elementType));
+
+            return;
+        }
+
+        auto zero = llvm::ConstantInt::get(sizeType, 0);
+        auto one = llvm::ConstantInt::get(sizeType, 1);
+
+        auto blockCurrent = context.ir->GetInsertBlock();
+        auto function = blockCurrent->getParent();
+
+        auto blockNext = blockCurrent->getNextNode();
+
+        auto blockDone = llvm::BasicBlock::Create(builder.context, "initialize_done", function, blockNext);
+        auto blockLoop = llvm::BasicBlock::Create(builder.context, "initialize_element", function, blockDone);
+
+        context.ir->CreateCondBr(context.ir->CreateICmpEQ(size, zero), blockDone, blockLoop);
+
+        llvm::IRBuilder<> loop(blockLoop);
+
+        auto index = loop.CreatePHI(sizeType, 2);
+        index->addIncoming(zero, blockCurrent);
+
+        ops::makeInitialize(context.move(&loop), loop.CreateInBoundsGEP(elementType, data, index), type);
+
+        // initializing an element can leave loop in a later block
+        auto next = loop.CreateNUWAdd(index, one);
+        index->addIncoming(next, loop.GetInsertBlock());
+
+        loop.CreateCondBr(loop.CreateICmpEQ(next, size), blockDone, blockLoop);
+
+        context.ir->SetInsertPoint(blockDone);
+    }
+
+    llvm::Value *makeMalloc(const Context &context, const utils::Typename &type, const std::string &name, bool zeroed) {
+        llvm::Value *arraySize = nullptr;
+
+        if (auto array = std::get_if<utils::ArrayTypename>(&type)) {
+            if (array->kind == utils::ArrayKind::Unbounded)
+                throw std::runtime_error(fmt::format("Attempt to allocate type {} on heap.", toString(type)));
+
+            if (array->kind == utils::ArrayKind::UnboundedSized) {
+                arraySize = makeUnboundedLength(context, *array);
 
                 // TODO: needs recursive implementation of sizes to account for
                 // [[int:50]:50] ^ probably would be done in the great refactor
@@ -133,14 +293,496 @@ namespace kara::builder::ops {
         auto pointerType = llvm::PointerType::get(llvmType, 0);
 
         size_t bytes = context.builder.target.layout->getTypeStoreSize(llvmType);
-        auto malloc = context.builder.getMalloc();
 
         // if statement above can adjust size...
         if (!arraySize) {
             arraySize = llvm::ConstantInt::get(llvm::Type::getInt64Ty(context.builder.context), bytes);
         }
 
-        return context.ir->CreatePointerCast(context.ir->CreateCall(malloc, { arraySize }), pointerType, name);
+        auto memory
+            = zeroed ? makeAllocateZeroed(context, arraySize, llvmType) : makeAllocate(context, arraySize, llvmType);
+
+        return context.ir->CreatePointerCast(memory, pointerType, name);
+    }
+
+    llvm::Value *makeAllocate(const Context &context, llvm::Value *size, llvm::Type *type) {
+        assert(context.ir);
+
+        auto &builder = context.builder;
+
+        if (builder.options.allocator.empty())
+            return context.ir->CreateCall(builder.getMalloc(), { size });
+
+        auto sizeType = llvm::Type::getInt64Ty(builder.context);
+        auto align = llvm::ConstantInt::get(sizeType, builder.target.layout->getPrefTypeAlign(type).value());
+
+        return context.ir->CreateCall(builder.getAllocate(), { size, align });
+    }
+
+    llvm::Value *makeAllocateZeroed(const Context &context, llvm::Value *size, llvm::Type *type) {
+        assert(context.ir);
+
+        auto &builder = context.builder;
+
+        if (builder.options.allocator.empty()) {
+            auto one = llvm::ConstantInt::get(llvm::Type::getInt64Ty(builder.context), 1);
+
+            // size first so promote() finds the byte count in the same operand as malloc
+            return context.ir->CreateCall(builder.getCalloc(), { size, one });
+        }
+
+        auto memory = makeAllocate(context, size, type);
+
+        context.ir->CreateMemSet(
+            memory, context.ir->getInt8(0), size, builder.target.layout->getPrefTypeAlign(type));
+
+        return memory;
+    }
+
+    void makeDeallocate(const Context &context, llvm::Value *pointer, llvm::Value *size, llvm::Type *type) {
+        assert(context.ir);
+
+        auto &builder = context.builder;
+
+        if (builder.options.allocator.empty()) {
+            context.ir->CreateCall(builder.getFree(), { pointer });
+
+            return;
+        }
+
+        auto sizeType = llvm::Type::getInt64Ty(builder.context);
+        auto align = llvm::ConstantInt::get(sizeType, builder.target.layout->getPrefTypeAlign(type).value());
+
+        context.ir->CreateCall(builder.getDeallocate(), { pointer, size, align });
+    }
+
+    llvm::Value *makeReallocate(
+        const Context &context, llvm::Value *pointer, llvm::Value *oldSize, llvm::Value *newSize, llvm::Type *type) {
+        assert(context.ir);
+
+        auto &builder = context.builder;
+
+        if (builder.options.allocator.empty())
+            return context.ir->CreateCall(builder.getRealloc(), { pointer, newSize });
+
+        auto sizeType = llvm::Type::getInt64Ty(builder.context);
+        auto align = llvm::ConstantInt::get(sizeType, builder.target.layout->getPrefTypeAlign(type).value());
+
+        return context.ir->CreateCall(builder.getReallocate(), { pointer, oldSize, newSize, align });
+    }
+
+    llvm::Value *makeSharedBlock(const Context &context, llvm::Value *pointer, const utils::Typename &type) {
+        assert(context.ir);
+
+        auto blockType = context.builder.makeSharedType(type);
+        auto offset = context.builder.target.layout->getStructLayout(blockType)->getElementOffset(1);
+
+        auto dataType = llvm::Type::getInt8PtrTy(context.builder.context);
+        auto data = context.ir->CreatePointerCast(pointer, dataType);
+
+        auto start = context.ir->CreateConstInBoundsGEP1_64(
+            llvm::Type::getInt8Ty(context.builder.context), data, -static_cast<int64_t>(offset));
+
+        return context.ir->CreatePointerCast(start, llvm::PointerType::get(blockType, 0));
+    }
+
+    llvm::Value *makeSharedCountAdd(
+        const Context &context, llvm::Value *pointer, const utils::Typename &type, int64_t delta) {
+        assert(context.ir);
+
+        auto blockType = context.builder.makeSharedType(type);
+        auto count = context.ir->CreateStructGEP(blockType, makeSharedBlock(context, pointer, type), 0);
+
+        auto sizeType = llvm::Type::getInt64Ty(context.builder.context);
+        auto amount = llvm::ConstantInt::get(sizeType, delta, true);
+
+        if (context.builder.options.nonAtomicShared) {
+            auto before = context.ir->CreateLoad(sizeType, count);
+
+            context.ir->CreateStore(context.ir->CreateAdd(before, amount), count);
+
+            return before;
+        }
+
+        // like std::shared_ptr, taking an owner needs no ordering but dropping one has to see the other owners writes
+        auto ordering = delta > 0 ? llvm::AtomicOrdering::Monotonic : llvm::AtomicOrdering::AcquireRelease;
+
+        return context.ir->CreateAtomicRMW(llvm::AtomicRMWInst::Add, count, amount,
+            context.builder.target.layout->getABITypeAlign(sizeType), ordering);
+    }
+
+    llvm::Value *makeSharedRetain(const Context &context, llvm::Value *pointer, const utils::Typename &type) {
+        assert(context.ir);
+
+        auto blockCurrent = context.ir->GetInsertBlock();
+
+        auto blockResume = llvm::BasicBlock::Create(
+            context.builder.context, "res", blockCurrent->getParent(), blockCurrent->getNextNode());
+        auto blockRetain = llvm::BasicBlock::Create(
+            context.builder.context, "ret", blockCurrent->getParent(), blockCurrent->getNextNode());
+
+        context.ir->CreateCondBr(context.ir->CreateIsNotNull(pointer), blockRetain, blockResume);
+
+        llvm::IRBuilder<> retainBuilder(blockRetain);
+        makeSharedCountAdd(context.move(&retainBuilder), pointer, type, 1);
+        retainBuilder.CreateBr(blockResume);
+
+        context.ir->SetInsertPoint(blockResume);
+
+        return pointer;
+    }
+
+    llvm::Value *makeArrayData(const Context &context, llvm::Value *ptr, const utils::ArrayTypename &type) {
+        assert(context.ir);
+        assert(type.kind == utils::ArrayKind::VariableSize || type.kind == utils::ArrayKind::Hybrid
+            || type.kind == utils::ArrayKind::Iterable);
+
+        auto structType = context.builder.makeTypename(type);
+        auto elementType = context.builder.makeTypename(*type.value);
+        auto elementPointer = llvm::PointerType::get(elementType, 0);
+
+        auto dataIndex = type.kind == utils::ArrayKind::Iterable ? 1 : 2;
+        auto data = context.ir->CreateLoad(elementPointer, context.ir->CreateStructGEP(structType, ptr, dataIndex));
+
+        if (type.kind != utils::ArrayKind::Hybrid)
+            return data;
+
+        auto sizeType = llvm::Type::getInt64Ty(context.builder.context);
+        auto storageType = llvm::ArrayType::get(elementType, type.size);
+
+        auto capacity = context.ir->CreateLoad(sizeType, context.ir->CreateStructGEP(structType, ptr, 1));
+        auto spilled = context.ir->CreateICmpUGT(capacity, llvm::ConstantInt::get(sizeType, type.size));
+
+        auto storage = context.ir->CreateConstInBoundsGEP2_64(
+            storageType, context.ir->CreateStructGEP(structType, ptr, 3), 0, 0);
+
+        return context.ir->CreateSelect(spilled, data, storage);
+    }
+
+    std::optional<std::pair<llvm::Value *, llvm::Value *>> makeArraySpan(
+        const Context &context, const builder::Result &value) {
+        assert(context.ir);
+
+        auto array = std::get_if<utils::ArrayTypename>(&value.type);
+        assert(array);
+
+        auto sizeType = llvm::Type::getInt64Ty(context.builder.context);
+
+        switch (array->kind) {
+        case utils::ArrayKind::FixedSize: {
+            auto zero = llvm::ConstantInt::get(sizeType, 0);
+            auto arrayType = context.builder.makeTypename(*array);
+
+            auto data = context.ir->CreateInBoundsGEP(arrayType, ops::ref(context, value), { zero, zero });
+
+            return std::make_pair(data, llvm::ConstantInt::get(sizeType, array->size));
+        }
+
+        case utils::ArrayKind::UnboundedSized: {
+            assert(array->expression && context.cache);
+
+            auto cached = context.cache->find(&Cache::expressions, array->expression);
+
+            if (!cached)
+                die("Attempting to access size of {} but size has not yet been calculated.", toString(value.type));
+
+            return std::make_pair(ops::ref(context, value), ops::get(context, *cached));
+        }
+
+        case utils::ArrayKind::VariableSize:
+        case utils::ArrayKind::Hybrid:
+        case utils::ArrayKind::Iterable: {
+            auto ptr = ops::ref(context, value);
+            auto structType = context.builder.makeTypename(*array);
+
+            auto size = context.ir->CreateLoad(sizeType, context.ir->CreateStructGEP(structType, ptr, 0));
+
+            return std::make_pair(ops::makeArrayData(context, ptr, *array), size);
+        }
+
+        default:
+            return std::nullopt;
+        }
+    }
+
+    void makeArrayReserve(
+        const Context &context, llvm::Value *ptr, const utils::ArrayTypename &type, llvm::Value *capacity) {
+        assert(context.ir);
+        assert(type.kind == utils::ArrayKind::VariableSize || type.kind == utils::ArrayKind::Hybrid);
+
+        auto &builder = context.builder;
+
+        auto structType = builder.makeTypename(type);
+        auto elementType = builder.makeTypename(*type.value);
+        auto elementPointer = llvm::PointerType::get(elementType, 0);
+
+        auto sizeType = llvm::Type::getInt64Ty(builder.context);
+        auto dataType = llvm::Type::getInt8PtrTy(builder.context);
+
+        auto elementSize = llvm::ConstantInt::get(sizeType, builder.target.layout->getTypeAllocSize(elementType));
+
+        auto sizePtr = context.ir->CreateStructGEP(structType, ptr, 0); // 0 is size
+        auto capacityPtr = context.ir->CreateStructGEP(structType, ptr, 1); // 1 is capacity
+        auto dataPtr = context.ir->CreateStructGEP(structType, ptr, 2); // 2 is data
+
+        auto oldCapacity = context.ir->CreateLoad(sizeType, capacityPtr);
+        auto oldData = context.ir->CreatePointerCast(context.ir->CreateLoad(elementPointer, dataPtr), dataType);
+
+        if (type.kind == utils::ArrayKind::VariableSize) {
+            auto newData = ops::makeReallocate(context, oldData, context.ir->CreateMul(oldCapacity, elementSize),
+                context.ir->CreateMul(capacity, elementSize), elementType);
+
+            context.ir->CreateStore(context.ir->CreatePointerCast(newData, elementPointer), dataPtr);
+            context.ir->CreateStore(capacity, capacityPtr);
+
+            return;
+        }
+
+        /*
+         * capacity <= N holds elements in storage, so four moves are possible:
+         *   heap -> heap (reallocate), heap -> storage (copy back and deallocate),
+         *   storage -> heap (allocate and copy), storage -> storage (capacity back to N)
+         */
+        auto inlineSize = llvm::ConstantInt::get(sizeType, type.size);
+        auto storageType = llvm::ArrayType::get(elementType, type.size);
+        auto align = builder.target.layout->getPrefTypeAlign(elementType);
+
+        auto storage = context.ir->CreatePointerCast(context.ir->CreateConstInBoundsGEP2_64(storageType,
+                                                         context.ir->CreateStructGEP(structType, ptr, 3), 0, 0),
+            dataType);
+
+        auto spilled = context.ir->CreateICmpUGT(oldCapacity, inlineSize);
+        auto fits = context.ir->CreateICmpULE(capacity, inlineSize);
+
+        auto blockCurrent = context.ir->GetInsertBlock();
+        auto function = blockCurrent->getParent();
+
+        auto blockDone = llvm::BasicBlock::Create(builder.context, "reserve_done", function, blockCurrent->getNextNode());
+        auto blockToHeap = llvm::BasicBlock::Create(builder.context, "reserve_spill", function, blockDone);
+        auto blockStorage = llvm::BasicBlock::Create(builder.context, "reserve_storage", function, blockToHeap);
+        auto blockHeapGrow = llvm::BasicBlock::Create(builder.context, "reserve_grow", function, blockStorage);
+        auto blockToStorage = llvm::BasicBlock::Create(builder.context, "reserve_unspill", function, blockHeapGrow);
+        auto blockHeap = llvm::BasicBlock::Create(builder.context, "reserve_heap", function, blockToStorage);
+
+        context.ir->CreateCondBr(spilled, blockHeap, blockStorage);
+
+        llvm::IRBuilder<> heapBuilder(blockHeap);
+        heapBuilder.CreateCondBr(fits, blockToStorage, blockHeapGrow);
+
+        {
+            llvm::IRBuilder<> toStorage(blockToStorage);
+            auto toStorageContext = context.move(&toStorage);
+
+            auto size = toStorage.CreateLoad(sizeType, sizePtr);
+            auto kept = toStorage.CreateSelect(toStorage.CreateICmpULT(size, capacity), size, capacity);
+
+            toStorage.CreateMemCpy(storage, align, oldData, align, toStorage.CreateMul(kept, elementSize));
+
+            ops::makeDeallocate(
+                toStorageContext, oldData, toStorage.CreateMul(oldCapacity, elementSize), elementType);
+
+            toStorage.CreateStore(llvm::ConstantPointerNull::get(elementPointer), dataPtr);
+            toStorage.CreateStore(inlineSize, capacityPtr);
+            toStorage.CreateBr(blockDone);
+        }
+
+        {
+            llvm::IRBuilder<> heapGrow(blockHeapGrow);
+            auto heapGrowContext = context.move(&heapGrow);
+
+            auto newData = ops::makeReallocate(heapGrowContext, oldData, heapGrow.CreateMul(oldCapacity, elementSize),
+                heapGrow.CreateMul(capacity, elementSize), elementType);
+
+            heapGrow.CreateStore(heapGrow.CreatePointerCast(newData, elementPointer), dataPtr);
+            heapGrow.CreateStore(capacity, capacityPtr);
+            heapGrow.CreateBr(blockDone);
+        }
+
+        // every path stores the capacity, an inline array always reports N even if nothing has written it yet
+        llvm::IRBuilder<> storageBuilder(blockStorage);
+        storageBuilder.CreateStore(inlineSize, capacityPtr);
+        storageBuilder.CreateCondBr(fits, blockDone, blockToHeap);
+
+        {
+            llvm::IRBuilder<> toHeap(blockToHeap);
+            auto toHeapContext = context.move(&toHeap);
+
+            auto size = toHeap.CreateLoad(sizeType, sizePtr);
+            auto newData = ops::makeAllocate(toHeapContext, toHeap.CreateMul(capacity, elementSize), elementType);
+
+            toHeap.CreateMemCpy(newData, align, storage, align, toHeap.CreateMul(size, elementSize));
+
+            toHeap.CreateStore(toHeap.CreatePointerCast(newData, elementPointer), dataPtr);
+            toHeap.CreateStore(capacity, capacityPtr);
+            toHeap.CreateBr(blockDone);
+        }
+
+        context.ir->SetInsertPoint(blockDone);
+    }
+
+    void makeArrayDestroyElements(const Context &context, llvm::Value *ptr, const utils::ArrayTypename &type) {
+        assert(context.ir);
+
+        auto destructor = context.builder.makeElementDestructor(*type.value);
+
+        if (!destructor)
+            return;
+
+        auto structType = context.builder.makeTypename(type);
+        auto sizeType = llvm::Type::getInt64Ty(context.builder.context);
+
+        auto size = context.ir->CreateLoad(sizeType, context.ir->CreateStructGEP(structType, ptr, 0));
+
+        context.ir->CreateCall(destructor, { ops::makeArrayData(context, ptr, type), size });
+    }
+
+    void makeMapDestroyValues(const Context &context, llvm::Value *ptr, const utils::MapTypename &type) {
+        assert(context.ir);
+
+        auto &builder = context.builder;
+
+        if (!builder.needsDestroy(*type.value))
+            return;
+
+        auto map = builder.makeMap(type);
+
+        auto i8 = llvm::Type::getInt8Ty(builder.context);
+        auto i64 = llvm::Type::getInt64Ty(builder.context);
+
+        auto zero = llvm::ConstantInt::get(i64, 0);
+
+        auto capacity = context.ir->CreateLoad(i64, context.ir->CreateStructGEP(map->structType, ptr, 1));
+        auto control = context.ir->CreateLoad(
+            llvm::PointerType::get(i8, 0), context.ir->CreateStructGEP(map->structType, ptr, 3));
+        auto slots = context.ir->CreateLoad(
+            llvm::PointerType::get(map->entryType, 0), context.ir->CreateStructGEP(map->structType, ptr, 4));
+
+        auto blockCurrent = context.ir->GetInsertBlock();
+        auto function = blockCurrent->getParent();
+
+        auto blockDone = llvm::BasicBlock::Create(builder.context, "each_done", function, blockCurrent->getNextNode());
+        auto blockAdvance = llvm::BasicBlock::Create(builder.context, "each_advance", function, blockDone);
+        auto blockDestroy = llvm::BasicBlock::Create(builder.context, "each_destroy", function, blockAdvance);
+        auto blockLoop = llvm::BasicBlock::Create(builder.context, "each", function, blockDestroy);
+
+        context.ir->CreateCondBr(context.ir->CreateICmpEQ(capacity, zero), blockDone, blockLoop);
+
+        llvm::IRBuilder<> loop(blockLoop);
+
+        auto index = loop.CreatePHI(i64, 2);
+        index->addIncoming(zero, blockCurrent);
+
+        // control bytes with the high bit clear are full
+        auto full = loop.CreateICmpSGE(
+            loop.CreateLoad(i8, loop.CreateGEP(i8, control, index)), llvm::ConstantInt::get(i8, 0));
+
+        loop.CreateCondBr(full, blockDestroy, blockAdvance);
+
+        llvm::IRBuilder<> destroy(blockDestroy);
+        auto destroyContext = context.move(&destroy);
+
+        auto entry = destroy.CreateGEP(map->entryType, slots, index);
+        ops::makeDestroy(destroyContext, destroy.CreateStructGEP(map->entryType, entry, 1), *type.value);
+
+        destroy.CreateBr(blockAdvance);
+
+        llvm::IRBuilder<> advance(blockAdvance);
+
+        auto next = advance.CreateAdd(index, llvm::ConstantInt::get(i64, 1));
+        index->addIncoming(next, blockAdvance);
+
+        advance.CreateCondBr(advance.CreateICmpEQ(next, capacity), blockDone, blockLoop);
+
+        context.ir->SetInsertPoint(blockDone);
+    }
+
+    llvm::Value *makeOptionalHolds(const Context &context, llvm::Value *ptr, const utils::OptionalTypename &type) {
+        assert(context.ir);
+
+        auto llvmType = context.builder.makeTypename(type);
+
+        if (auto niche = context.builder.makeNiche(*type.value))
+            return context.ir->CreateICmpNE(context.ir->CreateLoad(llvmType, ptr), niche);
+
+        return context.ir->CreateLoad(context.ir->getInt1Ty(), context.ir->CreateStructGEP(llvmType, ptr, 0));
+    }
+
+    llvm::Value *makeOptionalValue(const Context &context, llvm::Value *ptr, const utils::OptionalTypename &type) {
+        assert(context.ir);
+
+        if (context.builder.makeNiche(*type.value))
+            return ptr;
+
+        return context.ir->CreateStructGEP(context.builder.makeTypename(type), ptr, 1);
+    }
+
+    void makeOptionalStore(
+        const Context &context, llvm::Value *ptr, const utils::OptionalTypename &type, llvm::Value *value) {
+        assert(context.ir);
+
+        auto llvmType = context.builder.makeTypename(type);
+
+        if (auto niche = context.builder.makeNiche(*type.value)) {
+            context.ir->CreateStore(value ? value : niche, ptr);
+
+            return;
+        }
+
+        context.ir->CreateStore(context.ir->getInt1(value != nullptr), context.ir->CreateStructGEP(llvmType, ptr, 0));
+
+        if (value)
+            context.ir->CreateStore(value, context.ir->CreateStructGEP(llvmType, ptr, 1));
+    }
+
+    llvm::Value *makeVariantTag(const Context &context, llvm::Value *ptr, const utils::VariantTypename &type) {
+        assert(context.ir);
+
+        auto llvmType = context.builder.makeTypename(type);
+        auto tagType = context.builder.makeVariantTagType(type);
+
+        if (auto niche = context.builder.variantNiche(type)) {
+            auto empty = context.builder.makeNiche(type.alternatives[*niche]);
+            auto isEmpty = context.ir->CreateICmpEQ(context.ir->CreateLoad(llvmType, ptr), empty);
+
+            return context.ir->CreateSelect(
+                isEmpty, llvm::ConstantInt::get(tagType, 1 - *niche), llvm::ConstantInt::get(tagType, *niche));
+        }
+
+        return context.ir->CreateLoad(tagType, context.ir->CreateStructGEP(llvmType, ptr, 1));
+    }
+
+    llvm::Value *makeVariantValue(
+        const Context &context, llvm::Value *ptr, const utils::VariantTypename &type, size_t index) {
+        assert(context.ir);
+
+        auto pointerType = llvm::PointerType::get(context.builder.makeTypename(type.alternatives[index]), 0);
+
+        if (context.builder.variantNiche(type))
+            return context.ir->CreatePointerCast(ptr, pointerType);
+
+        auto payload = context.ir->CreateStructGEP(context.builder.makeTypename(type), ptr, 0);
+
+        return context.ir->CreatePointerCast(payload, pointerType);
+    }
+
+    void makeVariantStore(const Context &context, llvm::Value *ptr, const utils::VariantTypename &type, size_t index,
+        llvm::Value *value) {
+        assert(context.ir);
+
+        auto llvmType = context.builder.makeTypename(type);
+        auto tagType = context.builder.makeVariantTagType(type);
+
+        // null is the only other alternative, storing it writes the niche
+        if (auto niche = context.builder.variantNiche(type)) {
+            auto empty = context.builder.makeNiche(type.alternatives[*niche]);
+
+            context.ir->CreateStore(index == *niche ? value : empty, ptr);
+
+            return;
+        }
+
+        context.ir->CreateStore(value, makeVariantValue(context, ptr, type, index));
+        context.ir->CreateStore(llvm::ConstantInt::get(tagType, index), context.ir->CreateStructGEP(llvmType, ptr, 1));
     }
 
     // remove from statement scope or call move operator
@@ -150,14 +792,30 @@ namespace kara::builder::ops {
 
         auto isTemporary = result.isSet(builder::Result::FlagTemporary);
         auto isRegularReference = reference && reference->kind == utils::ReferenceKind::Regular;
+        auto isMap = std::holds_alternative<utils::MapTypename>(result.type);
+        auto isAggregate = std::holds_alternative<utils::TupleTypename>(result.type)
+            || std::holds_alternative<utils::VariantTypename>(result.type);
+        auto isOwningAggregate = isAggregate && context.builder.needsDestroy(result.type);
+        auto function = std::get_if<utils::FunctionTypename>(&result.type);
+        auto isClosure = function && function->kind == utils::FunctionKind::Regular;
 
         if (isTemporary) {
             if (context.accumulator && !isRegularReference) {
                 context.accumulator->avoidDestroy.insert(result.uid);
             }
+        } else if (reference && reference->kind == utils::ReferenceKind::Shared) {
+            // a copy is one more owner, the receiver is responsible for it so it is not put in the accumulator
+            return builder::Result {
+                builder::Result::FlagTemporary,
+                context.ir ? makeSharedRetain(context, ops::get(context, result), *reference->value) : nullptr,
+                result.type,
+                nullptr,
+            };
         } else {
             if ((reference && !isRegularReference)
-                || (array && array->kind == utils::ArrayKind::VariableSize)) { // unique or shared and not temporary
+                || (array
+                    && (array->kind == utils::ArrayKind::VariableSize || array->kind == utils::ArrayKind::Hybrid))
+                || isMap || isOwningAggregate || isClosure) { // unique and not temporary
                 throw std::runtime_error(fmt::format(
                     "Passing non-temporary of type {} is prohibited. May require a move or copy.",
                     toString(result.type)));
@@ -175,7 +833,8 @@ namespace kara::builder::ops {
                 if (!result.isSet(builder::Result::FlagExplicit)) {
                     auto func = std::get_if<utils::FunctionTypename>(&result.type);
 
-                    if (func && !func->isLocked) {
+                    // a function that takes parameters cannot be called with none, it is kept as a value
+                    if (func && !func->isLocked && func->parameters.empty()) {
                         ops::matching::MatchInput input; // no parameters
                         auto wrapper = ops::matching::call(context, *func, ops::get(context, result), input);
                         return ops::matching::unwrap(wrapper, nullptr);
@@ -223,8 +882,10 @@ namespace kara::builder::ops {
                 auto newIterator = std::find_if(result.references.begin(), result.references.end(), isNew);
 
                 if (newIterator != result.references.end()) {
-                    auto type = context.builder.resolveTypename((*newIterator)->as<parser::New>()->type());
-                    return ops::nouns::makeNew(context, type);
+                    auto newNode = (*newIterator)->as<parser::New>();
+                    auto type = context.builder.resolveTypename(newNode->type());
+
+                    return ops::nouns::makeNew(context, type, true, newNode->isShared);
                 }
 
                 std::vector<const hermes::Node *> functions;
@@ -317,9 +978,13 @@ namespace kara::builder::ops {
                 handlers::makeConvertForcedULongToRef,
                 handlers::makeConvertForcedRefToULong,
                 handlers::makeConvertForcedIntToBool,
+                handlers::makeConvertForcedEnumToInt,
+                handlers::makeConvertForcedIntToEnum,
                 handlers::makeConvertForcedFuncPtrToFuncPtr,
                 handlers::makeConvertUniqueOrMutableToRef,
                 handlers::makeConvertUniqueToVariableArray,
+                handlers::makeConvertArrayToIterable,
+                handlers::makeConvertTupleElements,
                 handlers::makeConvertExprArrayToUnboundedRef,
                 handlers::makeConvertRefToAnyRef,
                 handlers::makeConvertRefToUnboundedRef,
@@ -329,6 +994,7 @@ namespace kara::builder::ops {
                 handlers::makeConvertRefToBool,
                 handlers::makeConvertOptionalToBool,
                 handlers::makeConvertTypeToOptional,
+                handlers::makeConvertTypeToVariant,
                 handlers::makeConvertIntToFloat,
                 handlers::makeConvertFloatToInt,
                 handlers::makeConvertPrimitiveExtend,
@@ -364,9 +1030,16 @@ namespace kara::builder::ops {
         bool status = handlers::resolve(
             std::array {
                 handlers::makeInitializeNumber,
+                handlers::makeInitializeEnum,
                 handlers::makeInitializeReference,
+                handlers::makeInitializeClosure,
                 handlers::makeInitializeVariableArray,
+                handlers::makeInitializeFixedArray,
+                handlers::makeInitializeMap,
                 handlers::makeInitializeStruct,
+                handlers::makeInitializeTuple,
+                handlers::makeInitializeVariant,
+                handlers::makeInitializeOptional,
                 handlers::makeInitializeIgnore,
             },
             context, value, type);
@@ -382,7 +1055,12 @@ namespace kara::builder::ops {
             std::array {
                 handlers::makeDestroyReference,
                 handlers::makeDestroyUnique,
+                handlers::makeDestroyShared,
                 handlers::makeDestroyVariableArray,
+                handlers::makeDestroyMap,
+                handlers::makeDestroyTuple,
+                handlers::makeDestroyVariant,
+                handlers::makeDestroyClosure,
                 handlers::makeDestroyRegular,
             },
             context, value, type);
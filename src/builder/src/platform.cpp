@@ -7,7 +7,9 @@
 #include <llvm/Support/Host.h>
 #include <llvm/Support/TargetSelect.h>
 
+#include <array>
 #include <cassert>
+#include <algorithm>
 
 namespace kara::builder {
     std::vector<llvm::Type *> FormatArgumentsPackage::parameterTypes() const {
@@ -99,127 +101,88 @@ namespace kara::builder {
 
 #pragma clang diagnostic push
 #pragma ide diagnostic ignored "misc-no-recursion"
-    std::optional<std::vector<llvm::Type *>> flattenLLVMType(llvm::Type *type) {
+    // Scalars that make up type with their byte offset, taken from the data layout so padding is accounted for.
+    bool flattenLLVMType(const builder::Target &target, llvm::Type *type, uint64_t offset,
+        std::vector<std::pair<uint64_t, llvm::Type *>> &result) {
         // make sure array isnt something giant, check llvm type size before calling
 
-        std::vector<llvm::Type *> result;
-
         if (type->isIntegerTy() || type->isFloatTy() || type->isDoubleTy() || type->isPointerTy()) {
-            result.push_back(type);
+            result.emplace_back(offset, type);
         } else if (type->isStructTy()) {
             auto structType = reinterpret_cast<llvm::StructType *>(type);
+            auto layout = target.layout->getStructLayout(structType);
 
-            for (auto element : structType->elements()) {
-                auto flattened = flattenLLVMType(element);
-
-                if (!flattened)
-                    return std::nullopt;
+            for (unsigned a = 0; a < structType->getNumElements(); a++) {
+                auto element = structType->getElementType(a);
 
-                result.insert(result.end(), flattened->begin(), flattened->end());
+                if (!flattenLLVMType(target, element, offset + layout->getElementOffset(a), result))
+                    return false;
             }
         } else if (type->isArrayTy()) {
             auto arrayType = reinterpret_cast<llvm::ArrayType *>(type);
 
             auto elementType = arrayType->getElementType();
-            auto numElements = arrayType->getNumElements();
-
-            auto base = flattenLLVMType(elementType);
-
-            if (!base)
-                return std::nullopt;
-
-            result.reserve(result.size() + numElements * base->size());
+            auto stride = target.layout->getTypeAllocSize(elementType);
 
-            for (size_t a = 0; a < numElements; a++)
-                result.insert(result.end(), base->begin(), base->end()); // insert many?
+            for (uint64_t a = 0; a < arrayType->getNumElements(); a++) {
+                if (!flattenLLVMType(target, elementType, offset + a * stride, result))
+                    return false;
+            }
         } else {
-            return std::nullopt;
+            return false;
         }
 
-        assert(!result.empty());
-        assert(std::all_of(result.begin(), result.end(), [](auto type) {
-            return type->isIntegerTy() || type->isFloatTy() || type->isDoubleTy() || type->isPointerTy();
-        }));
-
-        return result;
+        return true;
     }
 #pragma clang diagnostic pop
 
-    std::optional<std::vector<llvm::Type *>> combineSysVLLVMTypes(
-        const builder::Target &target, const std::vector<llvm::Type *> &types) {
-        assert(!types.empty());
+    // Every eightbyte is classified on its own like a C struct would be.
+    // Only floats make it SSE, anything else in it makes it INTEGER.
+    std::optional<std::vector<llvm::Type *>> combineSysVLLVMTypes(const builder::Target &target, uint64_t size,
+        const std::vector<std::pair<uint64_t, llvm::Type *>> &scalars) {
+        assert(!scalars.empty());
 
-        if (types.size() == 1)
-            return types;
+        constexpr uint64_t dwordSize = 8;
+        constexpr std::array<uint64_t, 4> intSizes = { 1, 2, 4, 8 };
 
         std::vector<llvm::Type *> result;
 
-        size_t bytesSoFar = 0;
-        bool allFloats = true;
-        bool allDoubles = true;
-
-        constexpr size_t dwordSize = 8;
-        constexpr size_t maxTypeCount = 2;
-
-        auto push = [&]() {
-            assert(bytesSoFar > 0);
-
-            if (allFloats) {
-                assert(bytesSoFar % 4 == 0);
+        auto scalar = scalars.begin();
 
-                size_t numFloats = bytesSoFar / 4;
+        for (uint64_t start = 0; start < size; start += dwordSize) {
+            auto end = std::min(start + dwordSize, size);
+            auto first = scalar;
 
-                llvm::Type *baseType = llvm::Type::getFloatTy(*target.context);
-
-                if (numFloats > 1)
-                    baseType = llvm::VectorType::get(baseType, numFloats, false);
-
-                result.push_back(baseType);
-            } else if (allDoubles) {
-                assert(bytesSoFar == 8);
-
-                result.push_back(llvm::Type::getDoubleTy(*target.context));
-            } else {
-                // ints
-                std::set<size_t> sizes = { 1, 2, 3, 4, 8 };
-
-                auto bound = sizes.lower_bound(bytesSoFar);
-                auto intType = llvm::IntegerType::get(*target.context, *bound * 8);
-
-                result.push_back(intType);
+            for (; scalar != scalars.end() && scalar->first < end; scalar++) {
+                // packed layouts can leave a scalar split across two eightbytes
+                if (scalar->first + target.layout->getTypeStoreSize(scalar->second) > end)
+                    return std::nullopt;
             }
 
-            bytesSoFar = 0;
-            allFloats = true;
-            allDoubles = true;
-        };
-
-        for (auto type : types) {
-            auto size = target.layout->getTypeStoreSize(type);
+            if (first == scalar) { // padding only
+                result.push_back(llvm::Type::getInt64Ty(*target.context));
+                continue;
+            }
 
-            // too big to fit in a register, somehow
-            if (size > dwordSize)
-                return std::nullopt;
+            // one scalar keeps its own type, a pointer stays a pointer
+            if (std::next(first) == scalar && first->first == start) {
+                result.push_back(first->second);
+                continue;
+            }
 
-            // need to align this
-            if (bytesSoFar + size > dwordSize)
-                push();
+            if (std::all_of(first, scalar, [](const auto &p) { return p.second->isFloatTy(); })) {
+                result.push_back(llvm::VectorType::get(llvm::Type::getFloatTy(*target.context), 2, false));
+                continue;
+            }
 
-            bytesSoFar += size;
+            auto last = std::prev(scalar);
+            auto used = last->first + target.layout->getTypeStoreSize(last->second) - start;
 
-            if (!type->isFloatTy())
-                allFloats = false;
+            auto bytes = *std::lower_bound(intSizes.begin(), intSizes.end(), used);
 
-            if (!type->isDoubleTy())
-                allDoubles = false;
+            result.push_back(llvm::IntegerType::get(*target.context, bytes * 8));
         }
 
-        if (bytesSoFar > 0)
-            push();
-
-        if (result.size() > maxTypeCount)
-            return std::nullopt;
-
         return result;
     }
 
@@ -232,12 +195,12 @@ namespace kara::builder {
         if (size > maxInPlaceSize)
             return std::nullopt;
 
-        auto types = flattenLLVMType(root);
+        std::vector<std::pair<uint64_t, llvm::Type *>> scalars;
 
-        if (!types)
+        if (!flattenLLVMType(target, root, 0, scalars) || scalars.empty())
             return std::nullopt;
 
-        return combineSysVLLVMTypes(target, *types);
+        return combineSysVLLVMTypes(target, size, scalars);
     }
 
     FormatArgumentsResult SysVPlatform::formatArguments(const Target &target, const FormatArgumentsPackage &package) {
@@ -0,0 +1,241 @@
+#include <builder/builder.h>
+
+#include <builder/target.h>
+
+#include <llvm/IR/CFG.h>
+#include <llvm/IR/IntrinsicInst.h>
+
+#include <vector>
+#include <algorithm>
+#include <unordered_set>
+
+namespace kara::builder {
+    namespace {
+        // true if block can be reached from itself, promoting an allocation in a loop would share one slot
+        bool isCyclic(llvm::BasicBlock *block) {
+            std::unordered_set<llvm::BasicBlock *> visited;
+            std::vector<llvm::BasicBlock *> pending(llvm::succ_begin(block), llvm::succ_end(block));
+
+            while (!pending.empty()) {
+                auto next = pending.back();
+                pending.pop_back();
+
+                if (next == block)
+                    return true;
+
+                if (!visited.insert(next).second)
+                    continue;
+
+                pending.insert(pending.end(), llvm::succ_begin(next), llvm::succ_end(next));
+            }
+
+            return false;
+        }
+
+        // Follows every value that can hold the address of one `new` allocation.
+        // Anything the walker does not understand counts as an escape.
+        struct EscapeWalker {
+            llvm::Function *free = nullptr;
+            const std::unordered_set<llvm::Function *> &nonCapturing;
+
+            std::unordered_set<const llvm::Value *> aliases;
+            std::unordered_set<llvm::AllocaInst *> slots;
+
+            std::vector<llvm::CallInst *> frees;
+
+            bool walkSlot(llvm::AllocaInst *slot) {
+                if (!slots.insert(slot).second)
+                    return true;
+
+                for (auto user : slot->users()) {
+                    if (auto store = llvm::dyn_cast<llvm::StoreInst>(user)) {
+                        if (store->getValueOperand() == slot)
+                            return false;
+
+                        continue; // stored values are checked once every alias is known
+                    }
+
+                    if (auto load = llvm::dyn_cast<llvm::LoadInst>(user)) {
+                        if (!walk(load))
+                            return false;
+
+                        continue;
+                    }
+
+                    if (auto intrinsic = llvm::dyn_cast<llvm::IntrinsicInst>(user)) {
+                        if (intrinsic->isLifetimeStartOrEnd())
+                            continue;
+                    }
+
+                    return false;
+                }
+
+                return true;
+            }
+
+            bool walk(llvm::Value *value) {
+                if (!aliases.insert(value).second)
+                    return true;
+
+                for (auto user : value->users()) {
+                    if (llvm::isa<llvm::BitCastInst>(user) || llvm::isa<llvm::GetElementPtrInst>(user)) {
+                        if (llvm::cast<llvm::Instruction>(user)->getOperand(0) != value)
+                            return false;
+
+                        if (!walk(user))
+                            return false;
+
+                        continue;
+                    }
+
+                    if (llvm::isa<llvm::LoadInst>(user) || llvm::isa<llvm::ICmpInst>(user))
+                        continue;
+
+                    // closures carry the environment in a {function, environment} value, every field counts
+                    if (llvm::isa<llvm::InsertValueInst>(user) || llvm::isa<llvm::ExtractValueInst>(user)) {
+                        if (!walk(user))
+                            return false;
+
+                        continue;
+                    }
+
+                    if (auto store = llvm::dyn_cast<llvm::StoreInst>(user)) {
+                        if (store->getValueOperand() != value)
+                            continue;
+
+                        auto slot = llvm::dyn_cast<llvm::AllocaInst>(store->getPointerOperand());
+
+                        if (!slot || !walkSlot(slot))
+                            return false;
+
+                        continue;
+                    }
+
+                    if (llvm::isa<llvm::MemIntrinsic>(user))
+                        continue;
+
+                    if (auto call = llvm::dyn_cast<llvm::CallInst>(user)) {
+                        auto callee = call->getCalledFunction();
+
+                        if (callee && callee == free) {
+                            frees.push_back(call);
+
+                            continue;
+                        }
+
+                        if (callee && nonCapturing.find(callee) != nonCapturing.end())
+                            continue;
+
+                        if (isNotCaptured(call, value))
+                            continue;
+                    }
+
+                    return false;
+                }
+
+                return true;
+            }
+
+            // true if value is only called through or passed as nocapture, like a closure environment
+            static bool isNotCaptured(llvm::CallInst *call, const llvm::Value *value) {
+                for (unsigned a = 0; a < call->arg_size(); a++) {
+                    if (call->getArgOperand(a) == value && !call->doesNotCapture(a))
+                        return false;
+                }
+
+                return true;
+            }
+
+            bool slotsHoldOnlyAliases() const {
+                for (auto slot : slots) {
+                    for (auto user : slot->users()) {
+                        auto store = llvm::dyn_cast<llvm::StoreInst>(user);
+
+                        if (!store)
+                            continue;
+
+                        auto stored = store->getValueOperand();
+
+                        auto constant = llvm::dyn_cast<llvm::Constant>(stored);
+
+                        // null pointers, or a closure with a null environment
+                        if (aliases.find(stored) == aliases.end() && !(constant && constant->isNullValue()))
+                            return false;
+                    }
+                }
+
+                return true;
+            }
+        };
+    }
+
+    void Function::promote() {
+        if (heapAllocations.empty() || !entryBlock)
+            return;
+
+        // implicit destructors only load fields, so passing the allocation to them does not capture it
+        std::unordered_set<llvm::Function *> nonCapturing;
+
+        for (const auto &destructor : builder.implicitDestructors) {
+            if (destructor.second && destructor.second->function)
+                nonCapturing.insert(destructor.second->function);
+        }
+
+        auto free = builder.options.allocator.empty() ? builder.getFree() : builder.getDeallocate();
+        auto calloc = builder.options.allocator.empty() ? builder.getCalloc() : nullptr;
+
+        for (auto [call, type] : heapAllocations) {
+            if (!llvm::isa<llvm::ConstantInt>(call->getArgOperand(0)) || isCyclic(call->getParent()))
+                continue;
+
+            // same cap as [T:expr] locals, a big allocation stays on the heap instead of risking the stack
+            if (builder.target.layout->getTypeAllocSize(type) > builder.options.stackArrayLimit)
+                continue;
+
+            EscapeWalker walker { free, nonCapturing };
+
+            if (!walker.walk(call) || !walker.slotsHoldOnlyAliases())
+                continue;
+
+            llvm::IRBuilder<> head(entryBlock, entryBlock->getFirstInsertionPt());
+
+            auto slot = head.CreateAlloca(type, nullptr, "promoted");
+            slot->setAlignment(builder.target.layout->getPrefTypeAlign(type));
+
+            for (auto freeCall : walker.frees)
+                freeCall->eraseFromParent();
+
+            auto pointer = head.CreatePointerCast(slot, call->getType());
+
+            // calloc handed out zeroed memory, the slot has to start out the same
+            if (calloc && call->getCalledFunction() == calloc) {
+                llvm::IRBuilder<>(call).CreateMemSet(
+                    pointer, head.getInt8(0), call->getArgOperand(0), slot->getAlign());
+            }
+
+            call->replaceAllUsesWith(pointer);
+            call->eraseFromParent();
+        }
+
+        heapAllocations.clear();
+    }
+
+    void Function::markEnvironment() {
+        if (!entryBlock)
+            return;
+
+        // an sret pointer can come first, the environment keeps the name formatArguments gave it
+        auto argument = std::find_if(function->arg_begin(), function->arg_end(),
+            [](const llvm::Argument &value) { return value.getName() == "environment"; });
+
+        if (argument == function->arg_end())
+            return;
+
+        // returning or storing anything derived from the environment outlives the call, promote() must not see it
+        std::unordered_set<llvm::Function *> nonCapturing;
+        EscapeWalker walker { nullptr, nonCapturing };
+
+        if (walker.walk(argument) && walker.slotsHoldOnlyAliases())
+            argument->addAttr(llvm::Attribute::NoCapture);
+    }
+}
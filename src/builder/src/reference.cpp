@@ -5,6 +5,7 @@
 
 #include <parser/function.h>
 #include <parser/literals.h>
+#include <parser/scope.h>
 #include <parser/search.h>
 #include <parser/type.h>
 #include <parser/variable.h>
@@ -39,14 +40,33 @@ namespace kara::builder {
     }
 
     std::vector<const hermes::Node *> Builder::findAll(const parser::Reference *node) {
-        auto matchVariable = [node](const hermes::Node *value) -> bool {
-            return (value->is(parser::Kind::Variable) && value->as<parser::Variable>()->name == node->name);
+        // unpacked names sit inside the Unpack, it is matched as a sibling and mapped to the name after
+        auto findUnpacked = [node](const hermes::Node *value) -> const parser::Variable * {
+            for (auto name : value->as<parser::Unpack>()->names()) {
+                if (name->name == node->name)
+                    return name;
+            }
+
+            return nullptr;
+        };
+
+        // a for in variable sits inside the ForIn, so the ForIn is matched as the body's sibling instead
+        auto matchVariable = [node, &findUnpacked](const hermes::Node *value) -> bool {
+            if (value->is(parser::Kind::ForIn))
+                return value->as<parser::ForIn>()->name()->name == node->name;
+
+            if (value->is(parser::Kind::Unpack))
+                return findUnpacked(value) != nullptr;
+
+            return (value->is(parser::Kind::Variable) && !value->parent->is(parser::Kind::ForIn)
+                && !value->parent->is(parser::Kind::Unpack) && value->as<parser::Variable>()->name == node->name);
         };
 
         auto match = [node](const hermes::Node *value) -> bool {
             return (value->is(parser::Kind::Variable) && value->as<parser::Variable>()->name == node->name)
                 || (value->is(parser::Kind::Function) && value->as<parser::Function>()->name == node->name)
-                || (value->is(parser::Kind::Type) && value->as<parser::Type>()->name == node->name);
+                || (value->is(parser::Kind::Type) && value->as<parser::Type>()->name == node->name)
+                || (value->is(parser::Kind::Enum) && value->as<parser::Enum>()->name == node->name);
         };
 
         std::unordered_set<const hermes::Node *> unique;
@@ -64,6 +84,14 @@ namespace kara::builder {
         };
 
         std::vector<const hermes::Node *> result = parser::search::scopeFrom(node, matchVariable);
+
+        for (auto &k : result) {
+            if (k->is(parser::Kind::ForIn))
+                k = k->as<parser::ForIn>()->name();
+
+            if (k->is(parser::Kind::Unpack))
+                k = findUnpacked(k);
+        }
         std::vector<const hermes::Node *> more = searchAllDependencies(match);
 
         add(result);
@@ -2,10 +2,14 @@
 
 #include <builder/error.h>
 
+#include <parser/literals.h>
 #include <parser/type.h>
 #include <parser/variable.h>
 
+#include <array>
 #include <cassert>
+#include <limits>
+#include <unordered_set>
 
 namespace kara::builder {
     void Type::build() {
@@ -53,4 +57,115 @@ namespace kara::builder {
 
         auto fields = node->fields();
     }
+
+    namespace {
+        constexpr std::array<utils::PrimitiveType, 4> unsignedTypes = {
+            utils::PrimitiveType::UByte,
+            utils::PrimitiveType::UShort,
+            utils::PrimitiveType::UInt,
+            utils::PrimitiveType::ULong,
+        };
+
+        constexpr std::array<utils::PrimitiveType, 4> signedTypes = {
+            utils::PrimitiveType::Byte,
+            utils::PrimitiveType::Short,
+            utils::PrimitiveType::Int,
+            utils::PrimitiveType::Long,
+        };
+
+        bool fitsIn(const utils::PrimitiveTypename &type, int64_t value) {
+            auto bits = type.size() * 8;
+
+            if (type.isUnsigned())
+                return value >= 0 && (bits == 64 || value < (int64_t(1) << bits));
+
+            return bits == 64 || (value >= -(int64_t(1) << (bits - 1)) && value < (int64_t(1) << (bits - 1)));
+        }
+    }
+
+    Enum::Enum(const parser::Enum *node, builder::Builder &builder)
+        : node(node)
+        , builder(builder) {
+        auto cases = node->cases();
+
+        if (cases.empty())
+            throw VerifyError(node, "Enum {} must have at least one case.", node->name);
+
+        std::unordered_set<std::string> names;
+        std::vector<int64_t> numbers;
+        numbers.reserve(cases.size());
+
+        for (auto enumCase : cases) {
+            if (!names.insert(enumCase->name).second)
+                throw VerifyError(enumCase, "Enum {} has more than one case named {}.", node->name, enumCase->name);
+
+            if (auto number = enumCase->value()) {
+                if (auto value = std::get_if<int64_t>(&number->value))
+                    numbers.push_back(*value);
+                else if (auto unsignedValue = std::get_if<uint64_t>(&number->value);
+                         unsignedValue && *unsignedValue <= uint64_t(std::numeric_limits<int64_t>::max()))
+                    numbers.push_back(static_cast<int64_t>(*unsignedValue));
+                else
+                    throw VerifyError(number, "Enum case {} must be an integer that fits in a long.", enumCase->name);
+            } else if (numbers.empty()) {
+                numbers.push_back(0);
+            } else {
+                if (numbers.back() == std::numeric_limits<int64_t>::max())
+                    throw VerifyError(enumCase, "Enum case {} is out of range.", enumCase->name);
+
+                numbers.push_back(numbers.back() + 1);
+            }
+        }
+
+        auto [min, max] = std::minmax_element(numbers.begin(), numbers.end());
+
+        if (node->hasFixedType) {
+            auto fixed = builder.resolveTypename(node->fixedType());
+            auto primitive = std::get_if<utils::PrimitiveTypename>(&fixed);
+
+            if (!primitive || !primitive->isInteger())
+                throw VerifyError(node->fixedType(), "Enum {} must be based on an integer type.", node->name);
+
+            underlying = *primitive;
+
+            for (size_t a = 0; a < cases.size(); a++) {
+                if (!fitsIn(underlying, numbers[a])) {
+                    throw VerifyError(cases[a], "Enum case {} with value {} does not fit in {}.", cases[a]->name,
+                        numbers[a], toString(underlying));
+                }
+            }
+        } else {
+            for (auto candidate : *min >= 0 ? unsignedTypes : signedTypes) {
+                underlying = utils::PrimitiveTypename { candidate };
+
+                if (fitsIn(underlying, *min) && fitsIn(underlying, *max))
+                    break;
+            }
+        }
+
+        type = llvm::IntegerType::get(builder.context, underlying.size() * 8);
+
+        for (size_t a = 0; a < cases.size(); a++)
+            values[cases[a]] = llvm::ConstantInt::get(type, numbers[a], underlying.isSigned());
+
+        initial = values[cases.front()];
+
+        std::unordered_set<int64_t> used(numbers.begin(), numbers.end());
+
+        // zero first so empty stays all zero bytes, then just past either end of the cases
+        std::vector<int64_t> candidates = { 0 };
+
+        if (*max < std::numeric_limits<int64_t>::max())
+            candidates.push_back(*max + 1);
+        if (*min > std::numeric_limits<int64_t>::min())
+            candidates.push_back(*min - 1);
+
+        for (auto candidate : candidates) {
+            if (used.find(candidate) == used.end() && fitsIn(underlying, candidate)) {
+                niche = llvm::ConstantInt::get(type, candidate, underlying.isSigned());
+
+                break;
+            }
+        }
+    }
 }
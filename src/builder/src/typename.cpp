@@ -2,6 +2,8 @@
 
 #include <builder/error.h>
 
+#include <parser/expression.h>
+#include <parser/function.h>
 #include <parser/literals.h>
 #include <parser/search.h>
 #include <parser/type.h>
@@ -17,21 +19,51 @@ namespace kara::builder {
         case parser::Kind::NamedTypename: {
             auto e = node->as<parser::NamedTypename>();
 
+            // T inside a generic function means whatever the innermost instantiation of that function bound it to
+            if (!instantiating.empty()) {
+                auto owner = parser::search::exclusive::parents(
+                    node, [](const hermes::Node *n) { return n->is(parser::Kind::Function); });
+
+                for (auto it = instantiating.rbegin(); it != instantiating.rend(); ++it) {
+                    if (it->first != owner)
+                        continue;
+
+                    auto bound = std::find_if(it->second.begin(), it->second.end(),
+                        [e](const auto &generic) { return generic.first == e->name; });
+
+                    if (bound != it->second.end())
+                        return bound->second;
+
+                    break;
+                }
+            }
+
+            if (e->isGeneric)
+                throw VerifyError(node, "Type ^{} can only be inferred from the parameters of a call.", e->name);
+
             auto match = [e](const hermes::Node *node) {
+                if (node->is(parser::Kind::Enum))
+                    return node->as<parser::Enum>()->name == e->name;
+
                 if (!node->is(parser::Kind::Type))
                     return false;
 
                 return node->as<parser::Type>()->name == e->name;
             };
 
-            auto *type = parser::search::exclusive::scope(node, match)->as<parser::Type>();
+            auto found = parser::search::exclusive::scope(node, match);
 
-            if (!type)
-                type = searchDependencies(match)->as<parser::Type>();
+            if (!found)
+                found = searchDependencies(match);
 
-            if (!type)
+            if (!found)
                 throw VerifyError(node, "Cannot find type {}.", e->name);
 
+            if (found->is(parser::Kind::Enum))
+                return utils::EnumTypename { e->name, found->as<parser::Enum>() };
+
+            auto type = found->as<parser::Type>();
+
             if (auto alias = type->alias())
                 return resolveTypename(alias);
 
@@ -51,8 +83,6 @@ namespace kara::builder {
         case parser::Kind::ReferenceTypename: {
             auto e = node->as<parser::ReferenceTypename>();
 
-            assert(!e->isShared);
-
             if (e->isCPointer) {
                 assert(e->kind == utils::ReferenceKind::Regular);
 
@@ -85,16 +115,90 @@ namespace kara::builder {
                 uint64_t operator()(double v) { throw; }
             } visitor;
 
+            auto size = e->fixedSize() ? std::visit(visitor, e->fixedSize()->value) : 0;
+
+            // [T:N] where N only names constants is as fixed as [T:4]
+            if (e->type == utils::ArrayKind::UnboundedSized && isConstant(e->variableSize())) {
+                auto folded = makeConstant(e->variableSize());
+
+                auto primitive = std::get_if<utils::PrimitiveTypename>(&folded.type);
+                auto constant = llvm::dyn_cast<llvm::ConstantInt>(folded.value);
+
+                auto isInteger = primitive && primitive->isInteger() && constant;
+
+                if (!isInteger || (primitive->isSigned() && constant->isNegative()))
+                    throw VerifyError(e->variableSize(), "Array size must be a non-negative integer.");
+
+                return utils::ArrayTypename {
+                    utils::ArrayKind::FixedSize,
+                    std::make_shared<utils::Typename>(resolveTypename(e->body())),
+                    constant->getZExtValue(),
+                };
+            }
+
+            if (e->type == utils::ArrayKind::Hybrid && size == 0)
+                throw VerifyError(e, "Hybrid array must be able to hold at least one element inline.");
+
             return utils::ArrayTypename {
                 e->type,
 
                 std::make_shared<utils::Typename>(resolveTypename(e->body())),
 
-                e->type == utils::ArrayKind::FixedSize ? std::visit(visitor, e->fixedSize()->value) : 0,
+                size,
                 e->type == utils::ArrayKind::UnboundedSized ? e->variableSize() : nullptr,
             };
         }
 
+        case parser::Kind::MapTypename: {
+            auto e = node->as<parser::MapTypename>();
+
+            return utils::MapTypename {
+                std::make_shared<utils::Typename>(resolveTypename(e->key())),
+                std::make_shared<utils::Typename>(resolveTypename(e->value())),
+            };
+        }
+
+        case parser::Kind::TupleTypename: {
+            auto e = node->as<parser::TupleTypename>();
+
+            auto elements = e->elements();
+
+            utils::TupleTypename result;
+            result.elements.reserve(elements.size());
+
+            for (auto element : elements)
+                result.elements.push_back(resolveTypename(element));
+
+            return result;
+        }
+
+        case parser::Kind::VariantTypename: {
+            auto e = node->as<parser::VariantTypename>();
+
+            auto alternatives = e->alternatives();
+
+            utils::VariantTypename result;
+            result.alternatives.reserve(alternatives.size());
+
+            for (auto alternative : alternatives) {
+                auto type = resolveTypename(alternative);
+
+                // nothing has no storage to switch on, null is the empty alternative
+                auto primitive = std::get_if<utils::PrimitiveTypename>(&type);
+
+                if (primitive && primitive->type == utils::PrimitiveType::Nothing)
+                    throw VerifyError(alternative, "Variant cannot hold nothing, use null instead.");
+
+                if (std::find(result.alternatives.begin(), result.alternatives.end(), type)
+                    != result.alternatives.end())
+                    throw VerifyError(alternative, "Variant lists type {} twice.", toString(type));
+
+                result.alternatives.push_back(std::move(type));
+            }
+
+            return result;
+        }
+
         case parser::Kind::FunctionTypename: {
             auto e = node->as<parser::FunctionTypename>();
 
@@ -131,6 +235,149 @@ namespace kara::builder {
         }
     }
 
+    namespace {
+        // walks a parameter typename next to the type passed for it, binding each ^T the first time it is reached
+        struct Inference {
+            const std::vector<std::string> &names;
+            std::vector<std::optional<utils::Typename>> types;
+
+            bool operator()(const hermes::Node *node, const utils::Typename &type) {
+                switch (node->is<parser::Kind>()) {
+                case parser::Kind::NamedTypename: {
+                    auto e = node->as<parser::NamedTypename>();
+
+                    // plain names are left to matching, it can convert once every ^T is known
+                    if (!e->isGeneric)
+                        return true;
+
+                    auto index = std::distance(names.begin(), std::find(names.begin(), names.end(), e->name));
+                    auto &bound = types[index];
+
+                    if (!bound)
+                        bound = type;
+
+                    return *bound == type;
+                }
+
+                case parser::Kind::ReferenceTypename: {
+                    auto e = node->as<parser::ReferenceTypename>();
+
+                    // values are referenced implicitly when passed to &T
+                    auto reference = std::get_if<utils::ReferenceTypename>(&type);
+                    const auto &value = reference ? *reference->value : type;
+
+                    if (e->isCPointer) {
+                        auto array = std::get_if<utils::ArrayTypename>(&value);
+
+                        if (array && array->kind == utils::ArrayKind::Unbounded)
+                            return (*this)(e->body(), *array->value);
+                    }
+
+                    return (*this)(e->body(), value);
+                }
+
+                case parser::Kind::OptionalTypename: {
+                    auto optional = std::get_if<utils::OptionalTypename>(&type);
+
+                    return (*this)(node->as<parser::OptionalTypename>()->body(), optional ? *optional->value : type);
+                }
+
+                case parser::Kind::ArrayTypename: {
+                    auto array = std::get_if<utils::ArrayTypename>(&type);
+
+                    return array && (*this)(node->as<parser::ArrayTypename>()->body(), *array->value);
+                }
+
+                case parser::Kind::MapTypename: {
+                    auto e = node->as<parser::MapTypename>();
+                    auto map = std::get_if<utils::MapTypename>(&type);
+
+                    return map && (*this)(e->key(), *map->key) && (*this)(e->value(), *map->value);
+                }
+
+                case parser::Kind::TupleTypename: {
+                    auto elements = node->as<parser::TupleTypename>()->elements();
+                    auto tuple = std::get_if<utils::TupleTypename>(&type);
+
+                    if (!tuple || tuple->elements.size() != elements.size())
+                        return false;
+
+                    for (size_t a = 0; a < elements.size(); a++) {
+                        if (!(*this)(elements[a], tuple->elements[a]))
+                            return false;
+                    }
+
+                    return true;
+                }
+
+                case parser::Kind::VariantTypename: {
+                    auto alternatives = node->as<parser::VariantTypename>()->alternatives();
+                    auto variant = std::get_if<utils::VariantTypename>(&type);
+
+                    if (!variant || variant->alternatives.size() != alternatives.size())
+                        return false;
+
+                    for (size_t a = 0; a < alternatives.size(); a++) {
+                        if (!(*this)(alternatives[a], variant->alternatives[a]))
+                            return false;
+                    }
+
+                    return true;
+                }
+
+                case parser::Kind::FunctionTypename: {
+                    auto e = node->as<parser::FunctionTypename>();
+                    auto parameters = e->parameters();
+
+                    auto function = std::get_if<utils::FunctionTypename>(&type);
+
+                    if (!function || function->parameters.size() != parameters.size())
+                        return false;
+
+                    for (size_t a = 0; a < parameters.size(); a++) {
+                        auto parameter = parameters[a];
+
+                        if (parameter->is(parser::Kind::Variable))
+                            parameter = parameter->as<parser::Variable>()->fixedType();
+
+                        if (parameter && !(*this)(parameter, function->parameters[a].second))
+                            return false;
+                    }
+
+                    return (*this)(e->returnType(), *function->returnType);
+                }
+
+                default:
+                    return true;
+                }
+            }
+        };
+    }
+
+    std::optional<Generics> Builder::inferGenerics(
+        const parser::Function *node, const std::vector<std::optional<utils::Typename>> &types) {
+        auto parameters = node->parameters();
+
+        Inference inference { node->generics, std::vector<std::optional<utils::Typename>>(node->generics.size()) };
+
+        for (size_t a = 0; a < parameters.size() && a < types.size(); a++) {
+            if (types[a] && parameters[a]->hasFixedType && !inference(parameters[a]->fixedType(), *types[a]))
+                return std::nullopt;
+        }
+
+        Generics result;
+        result.reserve(node->generics.size());
+
+        for (size_t a = 0; a < node->generics.size(); a++) {
+            if (!inference.types[a])
+                return std::nullopt;
+
+            result.emplace_back(node->generics[a], *inference.types[a]);
+        }
+
+        return result;
+    }
+
     llvm::Type *Builder::makePrimitiveType(utils::PrimitiveType type) const {
         switch (type) {
         case utils::PrimitiveType::Any:
@@ -178,6 +425,8 @@ namespace kara::builder {
 
             llvm::Type *operator()(const utils::NamedTypename &type) const { return builder.makeType(type.type)->type; }
 
+            llvm::Type *operator()(const utils::EnumTypename &type) const { return builder.makeEnum(type.type)->type; }
+
             llvm::Type *operator()(const utils::OptionalTypename &type) const {
                 return builder.makeOptionalType(*type.value);
             }
@@ -196,14 +445,36 @@ namespace kara::builder {
                     return builder.makeTypename(*type.value);
                 case utils::ArrayKind::VariableSize:
                     return builder.makeVariableArrayType(*type.value);
+                case utils::ArrayKind::Hybrid:
+                    return builder.makeHybridArrayType(*type.value, type.size);
+                case utils::ArrayKind::Iterable:
+                    return builder.makeIterableArrayType(*type.value);
                 default:
                     throw std::runtime_error(fmt::format("Type {} is unimplemented.", toString(type)));
                 }
             }
 
+            llvm::Type *operator()(const utils::MapTypename &type) const { return builder.makeMap(type)->structType; }
+
+            // a literal struct, SysVPlatform classifies it like the equivalent C struct
+            llvm::Type *operator()(const utils::TupleTypename &type) const {
+                std::vector<llvm::Type *> elements(type.elements.size());
+
+                std::transform(type.elements.begin(), type.elements.end(), elements.begin(),
+                    [this](const auto &element) { return builder.makeTypename(element); });
+
+                return llvm::StructType::get(builder.context, elements);
+            }
+
+            llvm::Type *operator()(const utils::VariantTypename &type) const { return builder.makeVariantType(type); }
+
             llvm::Type *operator()(const utils::FunctionTypename &type) const {
-                if (type.kind != utils::FunctionKind::Pointer)
-                    throw std::runtime_error("Function typename must be pointer type.");
+                if (type.kind == utils::FunctionKind::Regular) {
+                    auto function = llvm::PointerType::get(builder.makeClosureFunctionType(type), 0);
+                    auto environment = llvm::Type::getInt8PtrTy(builder.context);
+
+                    return llvm::StructType::get(builder.context, { function, environment });
+                }
 
                 auto &paramIn = type.parameters;
 
@@ -226,4 +497,17 @@ namespace kara::builder {
 
         return std::visit(visitor, type);
     }
+
+    llvm::FunctionType *Builder::makeClosureFunctionType(const utils::FunctionTypename &type) {
+        std::vector<std::pair<std::string, llvm::Type *>> parameters = {
+            { "environment", llvm::Type::getInt8PtrTy(context) },
+        };
+
+        for (const auto &parameter : type.parameters)
+            parameters.emplace_back(parameter.first, makeTypename(parameter.second));
+
+        auto formattedResult = platform->formatArguments(target, { makeTypename(*type.returnType), parameters });
+
+        return llvm::FunctionType::get(formattedResult.returnType, formattedResult.parameterTypes(), false);
+    }
 }
@@ -18,19 +18,24 @@ namespace kara::builder {
         if (node->isMutable && !builder.options.mutableGlobals)
             throw VerifyError(node, "Global variables cannot be mutable.");
 
-        if (!node->hasFixedType)
+        if (!node->hasFixedType && !node->hasInitialValue)
             throw VerifyError(node, "Global variables must have a fixed type.");
 
-        if (node->value())
-            throw VerifyError(node, "Global variables cannot be initialized.");
+        using L = llvm::GlobalVariable::LinkageTypes;
 
-        type = builder.resolveTypename(node->fixedType());
+        llvm::Constant *defaultValue = nullptr;
 
-        using L = llvm::GlobalVariable::LinkageTypes;
+        if (node->hasFixedType)
+            type = builder.resolveTypename(node->fixedType());
 
-        assert(!node->hasInitialValue);
+        // folded here, nothing runs at startup to fill in a global
+        if (node->hasInitialValue) {
+            auto folded = builder.makeConstant(
+                node->value(), node->hasFixedType ? std::optional<utils::Typename>(type) : std::nullopt);
 
-        llvm::Constant *defaultValue = nullptr;
+            type = folded.type;
+            defaultValue = llvm::cast<llvm::Constant>(folded.value);
+        }
 
         if (node->hasConstantValue) {
             assert(node->hasFixedType);
@@ -104,6 +109,14 @@ namespace kara::builder {
             type = context.function->builder.resolveTypename(node->fixedType());
         }
 
+        auto array = std::get_if<utils::ArrayTypename>(&type);
+
+        if (array && array->kind == utils::ArrayKind::UnboundedSized && !possibleDefault) {
+            value = ops::makeStackArray(context, *array, node->name);
+
+            return;
+        }
+
         if (context.ir) {
             value = ops::makeAlloca(context, type, node->name);
 
@@ -133,4 +146,10 @@ namespace kara::builder {
             context.function->entry.CreateStore(argument, value);
         }
     }
+
+    // loop or unpacked variable, the value was already set up by the caller
+    Variable::Variable(const parser::Variable *node, utils::Typename type, llvm::Value *value)
+        : node(node)
+        , type(std::move(type))
+        , value(value) { }
 }
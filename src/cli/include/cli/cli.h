@@ -60,9 +60,13 @@ namespace kara::cli {
     struct CLIRunOptions : public CLIHook {
         std::string target;
         std::string triple;
-        std::string linkerType = "macho";
+        std::string linkerType; // empty for the default of the platform
         std::string projectFile = "project.yaml";
 
+        kara::options::Overrides overrides; // -O, lto and pgo flags, applied over the options of every target
+
+        bool jit = false;
+
         void execute() override;
         void connect() override;
     };
@@ -70,9 +74,11 @@ namespace kara::cli {
     struct CLIBuildOptions : public CLIHook {
         std::string target;
         std::string triple;
-        std::string linkerType = "macho";
+        std::string linkerType; // empty for the default of the platform
         std::string projectFile = "project.yaml";
 
+        kara::options::Overrides overrides; // -O, lto and pgo flags, applied over the options of every target
+
         bool printIr = false;
 
         void execute() override;
@@ -9,6 +9,7 @@
 #include <builder/manager.h>
 
 #include <llvm/IR/Module.h>
+#include <llvm/Support/MemoryBuffer.h>
 
 #include <string>
 #include <vector>
@@ -32,6 +33,9 @@ namespace kara::cli {
         const TargetInfo &info;
 
         std::unique_ptr<llvm::Module> module;
+
+        // object code emitted for the target, one per thin lto task, empty for interfaces and bitcode libraries
+        std::vector<std::unique_ptr<llvm::MemoryBuffer>> objects;
     };
 
     // or database?
@@ -61,6 +65,14 @@ namespace kara::cli {
 
         TargetCache targetCache; // after pm in initialization
 
+        // merged over the options of every target, for flags passed on the command line
+        kara::options::Overrides overrides;
+
+        // false when the caller only wants TargetResult::objects, like running main in a jit
+        bool linksExecutables = true;
+        // true when objects are loaded wherever there is room, like a jit above 4 GiB, code is then emitted as pic
+        bool positionIndependent = false;
+
         std::unordered_map<const TargetConfig *, std::unique_ptr<TargetInfo>> targetInfos;
         std::unordered_map<const TargetConfig *, std::unique_ptr<TargetResult>> updatedTargets;
 
@@ -18,8 +18,17 @@ namespace kara::cli {
         virtual std::vector<std::string> parseLinkerDriverArgument(std::string_view argument);
         virtual std::vector<std::string> parseDirectoriesFromCompileArgument(std::string_view argument);
 
+        // lld flavour used when none is given, picked by the object format of triple
+        virtual std::string defaultLinkerType();
         virtual std::vector<std::string> defaultLinkerArguments();
 
+        // objects that have to surround the objects of an executable in link order, like crt1.o and crtn.o
+        virtual std::vector<std::string> startFiles();
+        virtual std::vector<std::string> endFiles();
+
+        // linker arguments that pull in the compiler-rt profile library, empty if none is found
+        virtual std::vector<std::string> profileRuntime();
+
         static std::unique_ptr<Platform> byNative(std::string root, BuildLockFile &lock);
         static std::unique_ptr<Platform> byTriple(std::string root, std::string name, BuildLockFile &lock);
 
@@ -32,4 +41,22 @@ namespace kara::cli {
 
         explicit MacOSPlatform(std::string root, std::string triple, BuildLockFile &lock);
     };
+
+    struct LinuxPlatform : public Platform {
+        // the host cc and loader only describe the host, a cross triple skips discovery
+        bool matchesHost();
+        // absolute path the host toolchain prints for argument (like -print-file-name=crt1.o), empty if not found
+        std::string findToolchainFile(const std::string &key, const std::string &argument);
+        // program interpreter for dynamically linked executables, empty if not found
+        std::string dynamicLoader();
+
+        std::vector<std::string> defaultLinkerArguments() override;
+
+        std::vector<std::string> startFiles() override;
+        std::vector<std::string> endFiles() override;
+
+        std::vector<std::string> profileRuntime() override;
+
+        explicit LinuxPlatform(std::string root, std::string triple, BuildLockFile &lock);
+    };
 }
@@ -19,6 +19,7 @@ namespace kara::cli {
         }
 
         ProjectManager manager(*config, triple, root);
+        manager.overrides = overrides;
 
         std::string targetToBuild = target;
 
@@ -5,6 +5,8 @@
 #include <cli/manager.h>
 #include <cli/exposer.h>
 
+#include <builder/manager.h>
+
 #include <interfaces/interfaces.h>
 
 #include <yaml-cpp/yaml.h>
@@ -19,6 +21,32 @@ namespace kara::cli {
     void CLIExposeOptions::execute() {
         try {
             setLogging(false, [this]() {
+                auto localType = type;
+
+                if (localType.empty())
+                    localType = "kara";
+
+                std::transform(
+                    localType.begin(), localType.end(), localType.begin(), [](char c) { return std::tolower(c); });
+
+                // kara files are parsed on their own, imports are not followed
+                if (localType == "kara") {
+                    builder::SourceFile file(fs::absolute(fs::path(filePath)).string(), localType);
+
+                    YAML::Emitter emitter;
+
+                    emitter << YAML::BeginMap;
+
+                    emitter << YAML::Key << "root" << YAML::Value;
+                    expose(file.root.get(), emitter);
+
+                    emitter << YAML::EndMap;
+
+                    setLogging(true, [&emitter]() { fmt::print("{}\n", emitter.c_str()); });
+
+                    return;
+                }
+
                 auto config = TargetConfig::loadFrom(projectFile);
 
                 if (!config) {
@@ -32,14 +60,6 @@ namespace kara::cli {
                 // this &config should work, TargetCache will trust the pointer you pass it stays alive
                 auto targetInfo = manager.readTarget(&*config);
 
-                auto localType = type;
-
-                if (localType.empty())
-                    localType = "kara";
-
-                std::transform(
-                    localType.begin(), localType.end(), localType.begin(), [](char c) { return std::tolower(c); });
-
                 if (localType == "c") {
                     for (const auto &library : targetInfo.includes) {
                         if (auto path = library.match(filePath)) {
@@ -4,6 +4,9 @@
 #include <cli/config.h>
 #include <cli/manager.h>
 
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+
 #include <unistd.h>
 #include <sys/wait.h>
 
@@ -12,6 +15,77 @@
 namespace fs = std::filesystem;
 
 namespace kara::cli {
+    namespace {
+        int runInProcess(const ProjectManager &manager, const TargetResult &result) {
+            auto expectedJit = llvm::orc::LLJITBuilder().create();
+
+            if (!expectedJit) {
+                throw std::runtime_error(
+                    fmt::format("Could not create jit instance. {}", llvm::toString(expectedJit.takeError())));
+            }
+
+            auto &jit = expectedJit.get();
+            auto &library = jit->getMainJITDylib();
+
+            auto prefix = manager.builderTarget.layout->getGlobalPrefix();
+
+            // the result keeps owning the objects, the jit gets views into them
+            for (const auto &object : result.objects) {
+                auto view = llvm::MemoryBuffer::getMemBuffer(object->getMemBufferRef(), false);
+
+                if (auto error = jit->addObjectFile(std::move(view))) {
+                    throw std::runtime_error(
+                        fmt::format("Could not add object to jit instance. {}", llvm::toString(std::move(error))));
+                }
+            }
+
+            auto &linkingLayer = jit->getObjLinkingLayer();
+
+            for (const auto &path : result.info.libraries) {
+                auto loader = llvm::orc::StaticLibraryDefinitionGenerator::Load(linkingLayer, path.c_str());
+
+                if (!loader) {
+                    throw std::runtime_error(
+                        fmt::format("Failed to load library {}. {}", path, llvm::toString(loader.takeError())));
+                }
+
+                library.addGenerator(std::move(loader.get()));
+            }
+
+            for (const auto &path : result.info.dynamicLibraries) {
+                auto loader = llvm::orc::DynamicLibrarySearchGenerator::Load(path.c_str(), prefix);
+
+                if (!loader) {
+                    throw std::runtime_error(
+                        fmt::format("Failed to load dynamic library {}. {}", path, llvm::toString(loader.takeError())));
+                }
+
+                library.addGenerator(std::move(loader.get()));
+            }
+
+            // libc and anything else this process already has
+            auto process = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(prefix);
+
+            if (!process) {
+                throw std::runtime_error(
+                    fmt::format("Could not search current process. {}", llvm::toString(process.takeError())));
+            }
+
+            library.addGenerator(std::move(process.get()));
+
+            auto expectedMain = jit->lookup("main");
+
+            if (!expectedMain) {
+                throw std::runtime_error(
+                    fmt::format("Could not find main symbol. {}", llvm::toString(expectedMain.takeError())));
+            }
+
+            auto entry = reinterpret_cast<int (*)()>(expectedMain.get().getAddress());
+
+            return entry();
+        }
+    }
+
     void CLIRunOptions::execute() {
         auto config = TargetConfig::loadFrom(projectFile);
 
@@ -22,6 +96,7 @@ namespace kara::cli {
         }
 
         ProjectManager manager(*config, triple, root); // massive copy here :(
+        manager.overrides = overrides;
 
         std::string targetToBuild = target;
 
@@ -36,7 +111,21 @@ namespace kara::cli {
         if (targetConfig->type != TargetType::Executable)
             throw std::runtime_error(fmt::format("Target {} does not have executable type.", targetToBuild));
 
-        manager.makeTarget(targetConfig, root, linkerType);
+        if (jit) {
+            manager.overrides.inMemoryObjects = true;
+            manager.linksExecutables = false;
+            manager.positionIndependent = true;
+        }
+
+        auto &result = manager.makeTarget(targetConfig, root, linkerType);
+
+        if (jit) {
+            log(LogSource::target, "Running {} in process", targetToBuild);
+
+            log(LogSource::target, "Returned {}", runInProcess(manager, result));
+
+            return;
+        }
 
         auto directory = manager.createTargetDirectory(targetToBuild);
         auto executable = fs::path(directory) / targetToBuild; // ?
@@ -56,5 +145,12 @@ namespace kara::cli {
         waitpid(process, &status, 0);
 
         log(LogSource::target, "Finished");
+
+        if (manager.readTarget(targetConfig).defaultOptions.pgoInstrument) {
+            auto profile = fs::path(directory) / fmt::format("{}.profraw", targetToBuild);
+
+            log(LogSource::target, "Wrote profile {}, index it with llvm-profdata merge and pass it to --pgo-use.",
+                profile.string());
+        }
     }
 }
@@ -30,8 +30,12 @@ namespace kara::cli {
         app->add_option("target", target, "Target to build.");
 
         app->add_option("--triple", triple, "Triple to build for.");
-        app->add_option("-l,--linker", linkerType, "Name of linker flavour to use.");
+        app->add_option("-l,--linker", linkerType, "Name of linker flavour to use (elf, macho, coff, mingw, wasm).");
         app->add_option("-p,--project", projectFile, "Project file to use.");
+
+        overrides.connect(*app);
+
+        app->add_flag("--jit", jit, "Run main in process from the objects in memory instead of linking.");
     }
 
     void CLICleanOptions::connect() { app->add_option("-p,--project", projectFile, "Project file to use."); }
@@ -42,9 +46,11 @@ namespace kara::cli {
         app->add_option("target", target, "Target to build.");
 
         app->add_option("--triple", triple, "Triple to build for.");
-        app->add_option("-l,--linker", linkerType, "Name of linker flavour to use.");
+        app->add_option("-l,--linker", linkerType, "Name of linker flavour to use (elf, macho, coff, mingw, wasm).");
         app->add_option("-p,--project", projectFile, "Project file to use.");
 
+        overrides.connect(*app);
+
         app->add_flag("--print-ir", printIr, "Whether or not to print generated IR.");
     }
 
@@ -107,11 +107,38 @@ namespace kara::cli {
             pushOptions("free", defaultOptions.free);
         if (defaultOptions.realloc != "realloc")
             pushOptions("realloc", defaultOptions.realloc);
+        if (defaultOptions.calloc != "calloc")
+            pushOptions("calloc", defaultOptions.calloc);
+        if (!defaultOptions.allocator.empty())
+            pushOptions("allocator", defaultOptions.allocator);
+        if (defaultOptions.stackArrayLimit != kara::options::Options().stackArrayLimit)
+            pushOptions("stack-array-limit", defaultOptions.stackArrayLimit);
 
         if (defaultOptions.rawPlatform)
             pushOptions("raw-platform", defaultOptions.rawPlatform);
         if (defaultOptions.mutableGlobals)
             pushOptions("mutable-globals", defaultOptions.mutableGlobals);
+        if (defaultOptions.nonAtomicShared)
+            pushOptions("non-atomic-shared", defaultOptions.nonAtomicShared);
+
+        if (defaultOptions.optimize)
+            pushOptions("optimize", *defaultOptions.optimize);
+        if (defaultOptions.lto)
+            pushOptions("lto", defaultOptions.lto);
+        if (defaultOptions.thinLto)
+            pushOptions("thin-lto", defaultOptions.thinLto);
+
+        if (!defaultOptions.verify.empty())
+            pushOptions("verify", defaultOptions.verify);
+        if (defaultOptions.jobs != kara::options::Options().jobs)
+            pushOptions("jobs", defaultOptions.jobs);
+        if (defaultOptions.inMemoryObjects)
+            pushOptions("in-memory-objects", defaultOptions.inMemoryObjects);
+
+        if (defaultOptions.pgoInstrument)
+            pushOptions("pgo-instrument", defaultOptions.pgoInstrument);
+        if (!defaultOptions.pgoUse.empty())
+            pushOptions("pgo-use", defaultOptions.pgoUse);
 
         if (changed)
             emitter << YAML::Key << "options" << YAML::Value << options;
@@ -147,11 +174,38 @@ namespace kara::cli {
                 defaultOptions.free = v.as<std::string>();
             if (auto v = value["realloc"])
                 defaultOptions.realloc = v.as<std::string>();
+            if (auto v = value["calloc"])
+                defaultOptions.calloc = v.as<std::string>();
+            if (auto v = value["allocator"])
+                defaultOptions.allocator = v.as<std::string>();
+            if (auto v = value["stack-array-limit"])
+                defaultOptions.stackArrayLimit = v.as<size_t>();
 
             if (auto v = value["raw-platform"])
                 defaultOptions.rawPlatform = v.as<bool>();
             if (auto v = value["mutable-globals"])
                 defaultOptions.mutableGlobals = v.as<bool>();
+            if (auto v = value["non-atomic-shared"])
+                defaultOptions.nonAtomicShared = v.as<bool>();
+
+            if (auto v = value["optimize"])
+                defaultOptions.optimize = v.as<size_t>();
+            if (auto v = value["lto"])
+                defaultOptions.lto = v.as<bool>();
+            if (auto v = value["thin-lto"])
+                defaultOptions.thinLto = v.as<bool>();
+
+            if (auto v = value["verify"])
+                defaultOptions.verify = v.as<std::string>();
+            if (auto v = value["jobs"])
+                defaultOptions.jobs = v.as<size_t>();
+            if (auto v = value["in-memory-objects"])
+                defaultOptions.inMemoryObjects = v.as<bool>();
+
+            if (auto v = value["pgo-instrument"])
+                defaultOptions.pgoInstrument = v.as<bool>();
+            if (auto v = value["pgo-use"])
+                defaultOptions.pgoUse = v.as<std::string>();
         }
     }
 
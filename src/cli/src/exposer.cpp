@@ -6,8 +6,10 @@
 #include <parser/typename.h>
 #include <parser/variable.h>
 #include <parser/function.h>
+#include <parser/expression.h>
 
 #include <utils/typename.h>
+#include <utils/expression.h>
 
 #include <yaml-cpp/yaml.h>
 
@@ -18,8 +20,11 @@
 namespace kara::cli {
     std::string toTypeString(const hermes::Node *node) {
         switch (node->is<parser::Kind>()) {
-        case parser::Kind::NamedTypename:
-            return node->as<parser::NamedTypename>()->name;
+        case parser::Kind::NamedTypename: {
+            auto e = node->as<parser::NamedTypename>();
+
+            return e->isGeneric ? fmt::format("^{}", e->name) : e->name;
+        }
         case parser::Kind::PrimitiveTypename:
             switch (node->as<parser::PrimitiveTypename>()->type) {
             case utils::PrimitiveType::Any:
@@ -77,11 +82,43 @@ namespace kara::cli {
                 return fmt::format("[{}:]", toTypeString(e->body()));
             case utils::ArrayKind::Iterable:
                 return fmt::format("[{}::]", toTypeString(e->body()));
+            case utils::ArrayKind::Hybrid:
+                return fmt::format("[{},{}]", toTypeString(e->body()), std::get<uint64_t>(e->fixedSize()->value));
             default:
                 throw;
             }
         }
 
+        case parser::Kind::MapTypename: {
+            auto e = node->as<parser::MapTypename>();
+
+            return fmt::format("[{} -> {}]", toTypeString(e->key()), toTypeString(e->value()));
+        }
+
+        case parser::Kind::TupleTypename: {
+            auto e = node->as<parser::TupleTypename>();
+
+            auto elements = e->elements();
+
+            std::vector<std::string> text(elements.size());
+            std::transform(
+                elements.begin(), elements.end(), text.begin(), [](const auto &p) { return toTypeString(p); });
+
+            return fmt::format("({})", fmt::join(text, " & "));
+        }
+
+        case parser::Kind::VariantTypename: {
+            auto e = node->as<parser::VariantTypename>();
+
+            auto alternatives = e->alternatives();
+
+            std::vector<std::string> text(alternatives.size());
+            std::transform(
+                alternatives.begin(), alternatives.end(), text.begin(), [](const auto &p) { return toTypeString(p); });
+
+            return fmt::format("({})", fmt::join(text, " | "));
+        }
+
         case parser::Kind::FunctionTypename: {
             auto e = node->as<parser::FunctionTypename>();
 
@@ -111,6 +148,19 @@ namespace kara::cli {
         }
     }
 
+    // C headers read a number, kara globals hold an expression which is only shown when it is a plain number
+    const parser::Number *constantValue(const parser::Variable *node) {
+        if (node->hasConstantValue)
+            return node->constantValue();
+
+        if (!node->hasInitialValue)
+            return nullptr;
+
+        auto noun = std::get_if<utils::ExpressionNoun>(&node->value()->result);
+
+        return noun && noun->content->is(parser::Kind::Number) ? noun->content->as<parser::Number>() : nullptr;
+    }
+
     void expose(const parser::Root *root, YAML::Emitter &emitter) {
         emitter << YAML::BeginSeq;
 
@@ -137,7 +187,11 @@ namespace kara::cli {
                 }
 
                 emitter << YAML::EndSeq;
-                emitter << YAML::Key << "return-type" << YAML::Value << toTypeString(f->fixedType());
+                emitter << YAML::Key << "return-type" << YAML::Value;
+                if (f->hasFixedType)
+                    emitter << toTypeString(f->fixedType());
+                else
+                    emitter << YAML::Null;
                 emitter << YAML::Key << "external" << YAML::Value << f->isExtern;
                 emitter << YAML::Key << "c-var-args" << YAML::Value << f->isCVarArgs;
                 emitter << YAML::EndMap;
@@ -152,17 +206,22 @@ namespace kara::cli {
                     return std::visit([](auto x) { return std::to_string(x); }, node->value);
                 };
 
-                assert(!v->hasInitialValue);
+                auto constant = constantValue(v);
 
                 emitter << YAML::BeginMap;
                 emitter << YAML::Key << "kind" << YAML::Value << "variable";
                 emitter << YAML::Key << "name" << YAML::Value << v->name;
                 emitter << YAML::Key << "mutable" << YAML::Value << v->isMutable;
-                emitter << YAML::Key << "type" << YAML::Value << toTypeString(v->fixedType());
+                emitter << YAML::Key << "type" << YAML::Value;
+                if (v->hasFixedType)
+                    emitter << toTypeString(v->fixedType());
+                else
+                    emitter << YAML::Null;
                 emitter << YAML::Key << "external" << YAML::Value << v->isExternal;
+                emitter << YAML::Key << "initialized" << YAML::Value << (v->hasInitialValue || v->hasConstantValue);
                 emitter << YAML::Key << "constant-value" << YAML::Value;
-                if (v->hasConstantValue)
-                    emitter << toString(v->constantValue());
+                if (constant)
+                    emitter << toString(constant);
                 else
                     emitter << YAML::Null;
                 emitter << YAML::EndMap;
@@ -203,6 +262,44 @@ namespace kara::cli {
                 break;
             }
 
+            case parser::Kind::Enum: {
+                auto n = e->as<parser::Enum>();
+
+                auto toString = [](const parser::Number *node) -> std::string {
+                    return std::visit([](auto x) { return std::to_string(x); }, node->value);
+                };
+
+                emitter << YAML::BeginMap;
+                emitter << YAML::Key << "kind" << YAML::Value << "enum";
+                emitter << YAML::Key << "name" << YAML::Value << n->name;
+                emitter << YAML::Key << "type" << YAML::Value;
+                if (n->hasFixedType)
+                    emitter << toTypeString(n->fixedType());
+                else
+                    emitter << YAML::Null;
+                emitter << YAML::Key << "cases" << YAML::Value;
+                emitter << YAML::BeginSeq;
+
+                for (auto c : n->cases()) {
+                    emitter << YAML::BeginMap;
+                    emitter << YAML::Key << "name" << YAML::Value << c->name;
+                    emitter << YAML::Key << "value" << YAML::Value;
+                    if (c->hasValue)
+                        emitter << toString(c->value());
+                    else
+                        emitter << YAML::Null;
+                    emitter << YAML::EndMap;
+                }
+
+                emitter << YAML::EndSeq;
+                emitter << YAML::EndMap;
+
+                break;
+            }
+
+            case parser::Kind::Import:
+                break;
+
             default:
                 throw;
             }
@@ -5,16 +5,35 @@
 #include <builder/error.h>
 #include <builder/builder.h>
 
+#include <llvm/Analysis/ModuleSummaryAnalysis.h>
+#include <llvm/Analysis/ProfileSummaryInfo.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/CodeGen/ParallelCG.h>
 #include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/Verifier.h>
+#include <llvm/LTO/LTO.h>
 #include <llvm/Linker/Linker.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/Caching.h>
+#include <llvm/Support/SmallVectorMemoryBuffer.h>
+#include <llvm/Support/Threading.h>
+#include <llvm/Support/xxhash.h>
+#include <llvm/Transforms/IPO/Internalize.h>
+#include <llvm/Transforms/Utils/Cloning.h>
 
 #include <lld/Common/Driver.h>
 
 #include <yaml-cpp/yaml.h>
 
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#include <unistd.h>
+
 #include <cassert>
 #include <fstream>
+#include <algorithm>
 #include <sstream>
 #include <filesystem>
 
@@ -205,6 +224,240 @@ namespace kara::cli {
         return "";
     }
 
+    // changes whenever a file of the target does, profiles are matched against it to find stale ones
+    std::string stampSources(const TargetConfig &config) {
+        std::stringstream text;
+
+        for (const auto &file : config.files) {
+            std::ifstream stream(file);
+
+            text << file << '\n' << stream.rdbuf();
+        }
+
+        return fmt::format("{:016x}", llvm::xxHash64(text.str()));
+    }
+
+    void optimizeModule(llvm::Module &module, llvm::TargetMachine *machine, size_t level, bool lto,
+        const llvm::Optional<llvm::PGOOptions> &pgo) {
+        llvm::LoopAnalysisManager loopAnalysis;
+        llvm::FunctionAnalysisManager functionAnalysis;
+        llvm::CGSCCAnalysisManager cgsccAnalysis;
+        llvm::ModuleAnalysisManager moduleAnalysis;
+
+        llvm::PassBuilder passBuilder(machine, llvm::PipelineTuningOptions(), pgo);
+
+        passBuilder.registerModuleAnalyses(moduleAnalysis);
+        passBuilder.registerCGSCCAnalyses(cgsccAnalysis);
+        passBuilder.registerFunctionAnalyses(functionAnalysis);
+        passBuilder.registerLoopAnalyses(loopAnalysis);
+        passBuilder.crossRegisterProxies(loopAnalysis, functionAnalysis, cgsccAnalysis, moduleAnalysis);
+
+        auto optimizationLevel = ([level]() {
+            switch (level) {
+            case 1:
+                return llvm::OptimizationLevel::O1;
+            case 2:
+                return llvm::OptimizationLevel::O2;
+            default:
+                return llvm::OptimizationLevel::O3;
+            }
+        })();
+
+        if (!lto) {
+            passBuilder.buildPerModuleDefaultPipeline(optimizationLevel).run(module, moduleAnalysis);
+
+            return;
+        }
+
+        llvm::ModulePassManager passes;
+
+        // instrumentation and profile use only run before the link, the lto pipeline skips them
+        if (pgo)
+            passes.addPass(passBuilder.buildLTOPreLinkDefaultPipeline(optimizationLevel));
+
+        // the lto pipeline assumes it sees the whole program, which internalizing executables made true
+        passes.addPass(passBuilder.buildLTODefaultPipeline(optimizationLevel, nullptr));
+
+        passes.run(module, moduleAnalysis);
+    }
+
+    std::unique_ptr<llvm::MemoryBuffer> makeThinBitcode(const llvm::Module &module) {
+        llvm::ProfileSummaryInfo profile(module);
+        auto index = llvm::buildModuleSummaryIndex(module, nullptr, &profile);
+
+        llvm::SmallVector<char, 0> buffer;
+        llvm::raw_svector_ostream output(buffer);
+
+        llvm::WriteBitcodeToFile(module, output, false, &index);
+
+        return llvm::MemoryBuffer::getMemBufferCopy(
+            llvm::StringRef(buffer.data(), buffer.size()), module.getModuleIdentifier());
+    }
+
+    // returns one object per task, objects of unchanged modules come from the cache in directory
+    std::vector<std::unique_ptr<llvm::MemoryBuffer>> runThinBackend(const builder::Target &target,
+        const std::vector<std::unique_ptr<llvm::MemoryBuffer>> &inputs, size_t level, llvm::Reloc::Model relocation,
+        const fs::path &directory) {
+        llvm::lto::Config config;
+        config.CPU = target.machine->getTargetCPU().str();
+        config.MAttrs = { target.machine->getTargetFeatureString().str() };
+        config.Options = target.machine->Options;
+        config.RelocModel = relocation;
+        config.CGOptLevel = target.machine->getOptLevel();
+        config.OptLevel = static_cast<unsigned>(level);
+        config.DefaultTriple = target.triple;
+
+        auto backend = llvm::lto::createInProcessThinBackend(llvm::heavyweight_hardware_concurrency());
+        llvm::lto::LTO lto(std::move(config), std::move(backend));
+
+        std::unordered_set<std::string> prevailing;
+
+        for (const auto &input : inputs) {
+            auto file = llvm::lto::InputFile::create(input->getMemBufferRef());
+
+            if (!file)
+                throw std::runtime_error(llvm::toString(file.takeError()));
+
+            auto symbols = (*file)->symbols();
+            std::vector<llvm::lto::SymbolResolution> resolutions(symbols.size());
+
+            for (size_t a = 0; a < symbols.size(); a++) {
+                auto &symbol = symbols[a];
+                auto &resolution = resolutions[a];
+
+                // first definition wins, later copies of linkonce_odr instantiations and weak globals are dropped
+                resolution.Prevailing = !symbol.isUndefined() && prevailing.insert(symbol.getName().str()).second;
+                resolution.FinalDefinitionInLinkageUnit = resolution.Prevailing;
+
+                // matches internalizing a full module, only main, export functions and data stay visible
+                resolution.VisibleToRegularObj
+                    = symbol.getIRName() == "main" || symbol.isUsed() || !symbol.isExecutable();
+            }
+
+            if (auto error = lto.add(std::move(*file), resolutions))
+                throw std::runtime_error(llvm::toString(std::move(error)));
+        }
+
+        fs::create_directories(directory);
+
+        auto tasks = lto.getMaxTasks();
+
+        std::vector<llvm::SmallVector<char, 0>> streamed(tasks);
+        std::vector<std::unique_ptr<llvm::MemoryBuffer>> objects(tasks);
+
+        auto addStream = [&streamed](size_t task) {
+            auto output = std::make_unique<llvm::raw_svector_ostream>(streamed[task]);
+
+            return std::make_unique<llvm::CachedFileStream>(std::move(output));
+        };
+
+        // hits and freshly built entries both come back through here
+        auto addBuffer = [&objects](size_t task, std::unique_ptr<llvm::MemoryBuffer> buffer) {
+            objects[task] = std::move(buffer);
+        };
+
+        auto cache = llvm::localCache("ThinLTO", "Thin", (directory / "cache").string(), addBuffer);
+
+        if (!cache)
+            throw std::runtime_error(llvm::toString(cache.takeError()));
+
+        if (auto error = lto.run(addStream, *cache))
+            throw std::runtime_error(llvm::toString(std::move(error)));
+
+        std::vector<std::unique_ptr<llvm::MemoryBuffer>> result;
+
+        // tasks without anything to emit, like an empty regular lto partition, leave no object behind
+        for (size_t a = 0; a < tasks; a++) {
+            if (objects[a])
+                result.push_back(std::move(objects[a]));
+            else if (!streamed[a].empty())
+                result.push_back(std::make_unique<llvm::SmallVectorMemoryBuffer>(std::move(streamed[a])));
+        }
+
+        return result;
+    }
+
+    // one object per partition, partitions of module are code generated on their own threads
+    std::vector<std::unique_ptr<llvm::MemoryBuffer>> emitObjects(llvm::Module &module, const builder::Target &target,
+        size_t partitions, llvm::Reloc::Model relocation, bool preserveLocals) {
+        std::vector<llvm::SmallVector<char, 0>> buffers(partitions);
+        std::vector<std::unique_ptr<llvm::raw_svector_ostream>> streams;
+        std::vector<llvm::raw_pwrite_stream *> outputs;
+
+        for (auto &buffer : buffers) {
+            streams.push_back(std::make_unique<llvm::raw_svector_ostream>(buffer));
+            outputs.push_back(streams.back().get());
+        }
+
+        // a target machine cannot be shared between threads, every partition gets its own
+        auto makeMachine = [&target, relocation]() {
+            auto machine = target.machine;
+
+            return std::unique_ptr<llvm::TargetMachine>(target.target->createTargetMachine(target.triple,
+                machine->getTargetCPU(), machine->getTargetFeatureString(), machine->Options, relocation,
+                machine->getCodeModel(), machine->getOptLevel()));
+        };
+
+        // splitCodeGen aborts on a machine without object output, asking one first turns that into an error
+        {
+            llvm::SmallVector<char, 0> scratch;
+            llvm::raw_svector_ostream stream(scratch);
+            llvm::legacy::PassManager passes;
+
+            if (makeMachine()->addPassesToEmitFile(passes, stream, nullptr, llvm::CodeGenFileType::CGFT_ObjectFile))
+                throw std::runtime_error("Target machine does not support object output.");
+        }
+
+        llvm::splitCodeGen(module, outputs, {}, makeMachine, llvm::CodeGenFileType::CGFT_ObjectFile, preserveLocals);
+
+        streams.clear();
+
+        std::vector<std::unique_ptr<llvm::MemoryBuffer>> result;
+
+        for (auto &buffer : buffers)
+            result.push_back(std::make_unique<llvm::SmallVectorMemoryBuffer>(std::move(buffer)));
+
+        return result;
+    }
+
+    void writeObjectFile(const llvm::MemoryBuffer &object, const fs::path &path) {
+        std::ofstream stream(path, std::ios::binary);
+
+        if (!stream.is_open())
+            throw std::runtime_error(fmt::format("Cannot open file {} for output", path.string()));
+
+        stream.write(object.getBufferStart(), static_cast<std::streamsize>(object.getBufferSize()));
+    }
+
+    // lld only takes paths, a memfd gives it one without the object touching the disk, empty if not possible
+    std::string makeMemoryFile(const llvm::MemoryBuffer &object, const std::string &name, std::vector<int> &files) {
+#ifdef __linux__
+        auto descriptor = memfd_create(name.c_str(), 0);
+
+        if (descriptor < 0)
+            return "";
+
+        files.push_back(descriptor);
+
+        auto data = object.getBufferStart();
+        auto remaining = object.getBufferSize();
+
+        while (remaining > 0) {
+            auto written = write(descriptor, data, remaining);
+
+            if (written < 0)
+                return "";
+
+            data += written;
+            remaining -= written;
+        }
+
+        return fmt::format("/proc/self/fd/{}", descriptor);
+#else
+        return "";
+#endif
+    }
+
     std::string ProjectManager::createTargetDirectory(const std::string &target) {
         fs::path directory = fs::path(mainTarget.outputDirectory) / target;
 
@@ -301,6 +554,16 @@ namespace kara::cli {
         }
 
         result->defaultOptions.merge(targetConfig->options.defaultOptions);
+        result->defaultOptions.merge(overrides);
+
+        // the bundled allocators are built along with the cli, they link like any other library
+        auto &allocator = result->defaultOptions.allocator;
+        auto &libraries = result->libraries;
+
+        if ((allocator == "kara_arena" || allocator == "kara_pool")
+            && std::find(libraries.begin(), libraries.end(), KARA_RUNTIME_LIBRARY) == libraries.end()) {
+            libraries.emplace_back(KARA_RUNTIME_LIBRARY);
+        }
 
         auto &ptr = *result;
         targetInfos[target] = std::move(result);
@@ -341,8 +604,18 @@ namespace kara::cli {
 
         auto &options = targetInfo.defaultOptions;
 
+        if (options.lto && options.thinLto)
+            throw std::runtime_error(fmt::format("Target {} cannot use both lto and thin lto.", name));
+
+        // libraries only hand their module to the executables that import them
+        auto emitsBitcode = (options.lto || options.thinLto) && targetConfig->type == TargetType::Library;
+        auto runsThinBackend = options.thinLto && targetConfig->type == TargetType::Executable;
+
         auto directory = createTargetDirectory(name);
-        auto outputFile = fs::path(directory) / fmt::format("{}.o", name);
+        auto outputFile = fs::path(directory) / fmt::format("{}.{}", name, emitsBitcode ? "bc" : "o");
+
+        if (runsThinBackend)
+            outputFile = fs::path(directory) / "thin";
 
         log(LogSource::target, "Building {}", outputFile.string());
 
@@ -378,6 +651,14 @@ namespace kara::cli {
             }
         }
 
+        // summaries are built per file, the linked module below is only kept for verifying and printing
+        std::vector<std::unique_ptr<llvm::MemoryBuffer>> thinInputs;
+
+        if (runsThinBackend) {
+            for (const auto &module : modules)
+                thinInputs.push_back(makeThinBitcode(*module));
+        }
+
         auto base = std::make_unique<llvm::Module>(name, *builderTarget.context);
         llvm::Linker linker(*base);
 
@@ -386,9 +667,42 @@ namespace kara::cli {
 
         modules.clear();
 
+        if ((options.lto || options.thinLto) && targetConfig->type == TargetType::Executable) {
+            std::unordered_set<const TargetConfig *> linked;
+            std::vector<const TargetConfig *> pending = targetInfo.depends;
+
+            while (!pending.empty()) {
+                auto dependency = pending.back();
+                pending.pop_back();
+
+                if (!linked.insert(dependency).second)
+                    continue;
+
+                auto &dependencyInfo = readTarget(dependency);
+                pending.insert(pending.end(), dependencyInfo.depends.begin(), dependencyInfo.depends.end());
+
+                auto &dependencyResult = *updatedTargets.at(dependency);
+
+                // interfaces have nothing to build
+                if (!dependencyResult.module)
+                    continue;
+
+                if (runsThinBackend)
+                    thinInputs.push_back(makeThinBitcode(*dependencyResult.module));
+                else
+                    linker.linkInModule(llvm::CloneModule(*dependencyResult.module));
+            }
+        }
+
         result->module = std::move(base);
 
-        if (llvm::verifyModule(*result->module, &llvm::errs())) {
+        // like clang, only unoptimized builds check the whole module unless asked otherwise
+        auto verifyLevel = options.verify.empty() ? (options.optimize.value_or(0) ? "off" : "full") : options.verify;
+
+        if (verifyLevel != "off" && verifyLevel != "function" && verifyLevel != "full")
+            throw std::runtime_error(fmt::format("Unknown verify level {} for target {}.", verifyLevel, name));
+
+        if (verifyLevel == "full" && llvm::verifyModule(*result->module, &llvm::errs())) {
             fmt::print("Module IR:\n");
             result->module->print(llvm::outs(), nullptr);
             fmt::print("\n");
@@ -396,30 +710,126 @@ namespace kara::cli {
             throw std::runtime_error(fmt::format("Module for target {} failed to verify.", name));
         }
 
+        // every file of an executable is linked in above, only main and export functions are called from outside
+        if (targetConfig->type == TargetType::Executable) {
+            llvm::internalizeModule(*result->module, [](const llvm::GlobalValue &value) {
+                return !llvm::isa<llvm::Function>(value) || value.getName() == "main";
+            });
+        }
+
+        auto usesProfile = !options.pgoUse.empty();
+
+        if (options.pgoInstrument && usesProfile)
+            throw std::runtime_error(fmt::format("Target {} cannot be instrumented and use a profile at once.", name));
+
+        if (runsThinBackend && (options.pgoInstrument || usesProfile))
+            throw std::runtime_error(fmt::format("Target {} cannot use pgo with thin lto.", name));
+
+        llvm::Optional<llvm::PGOOptions> pgo;
+
+        // the lock remembers which sources were instrumented, so a profile from an older build can be called out
+        auto stampKey = fmt::format("pgo-{}-sources", name);
+
+        if (options.pgoInstrument) {
+            auto profile = fs::absolute(fs::path(directory) / fmt::format("{}.profraw", name));
+
+            pgo = llvm::PGOOptions(profile.string(), "", "", llvm::PGOOptions::IRInstr);
+
+            lock.parameters[stampKey] = stampSources(*targetConfig);
+        } else if (usesProfile) {
+            auto profile = fs::absolute(options.pgoUse);
+
+            if (!fs::exists(profile))
+                throw std::runtime_error(fmt::format("Cannot find profile {} for target {}.", profile.string(), name));
+
+            auto stampIt = lock.parameters.find(stampKey);
+
+            if (stampIt == lock.parameters.end() || stampIt->second != stampSources(*targetConfig)) {
+                log(LogSource::target,
+                    "Profile {} was not collected from the current sources of {}, changed functions will not use it.",
+                    profile.string(), name);
+            }
+
+            lock.parameters[fmt::format("pgo-{}-profile", name)] = profile.string();
+
+            pgo = llvm::PGOOptions(profile.string(), "", "", llvm::PGOOptions::IRUse);
+        }
+
+        // lto and pgo only work through the pipeline, so they run it at 2 unless given a level
+        auto pipelined = options.lto || options.thinLto || pgo;
+        auto level = options.optimize.value_or(pipelined ? 2 : 0);
+
+        if (pipelined && !level)
+            throw std::runtime_error(fmt::format("Target {} cannot use lto or pgo at optimization level 0.", name));
+
+        // under lto, a library is optimized as part of the executables that link it in
+        if (!emitsBitcode && !runsThinBackend && level)
+            optimizeModule(*result->module, builderTarget.machine, level, options.lto, pgo);
+
         if (logHeader(LogSource::target)) {
             fmt::print("Writing ");
             fmt::print(fmt::emphasis::italic, "{}\n", outputFile.string());
         }
 
-        {
-            llvm::legacy::PassManager passManager;
+        auto relocation = positionIndependent ? llvm::Reloc::PIC_ : builderTarget.machine->getRelocationModel();
 
+        if (emitsBitcode) {
             std::error_code error;
             llvm::raw_fd_ostream output(outputFile.string(), error);
 
             if (error)
                 throw std::runtime_error(fmt::format("Cannot open file {} for output", outputFile.string()));
 
-            auto emitResult = builderTarget.machine->addPassesToEmitFile(
-                passManager, output, nullptr, llvm::CodeGenFileType::CGFT_ObjectFile);
+            llvm::WriteBitcodeToFile(*result->module, output);
+        } else if (runsThinBackend) {
+            result->objects = runThinBackend(builderTarget, thinInputs, level, relocation, outputFile);
+        } else {
+            size_t partitions = options.jobs;
 
-            if (emitResult)
-                throw std::runtime_error("Target machine does not support object output.");
+            if (!partitions)
+                partitions = llvm::heavyweight_hardware_concurrency().compute_thread_count();
 
-            passManager.run(*result->module);
+            // splitting gives locals hidden external names, fine for an executable that is linked right here
+            // but a library object would leak them to whatever links it later
+            auto preserveLocals = targetConfig->type != TargetType::Executable;
+
+            result->objects = emitObjects(*result->module, builderTarget, partitions, relocation, preserveLocals);
         }
 
-        if (targetConfig->type == TargetType::Executable) {
+        // libraries always write their objects, executables can keep them in memory for lld or the jit
+        auto keepsObjectsInMemory = options.inMemoryObjects && targetConfig->type == TargetType::Executable;
+
+        std::vector<int> memoryFiles;
+        std::vector<std::string> objectFiles;
+
+        for (size_t a = 0; a < result->objects.size(); a++) {
+            // nothing to write, the jit reads them from the result
+            if (keepsObjectsInMemory && !linksExecutables)
+                break;
+
+            auto &object = *result->objects[a];
+            auto path = outputFile;
+
+            if (runsThinBackend)
+                path = outputFile / fmt::format("{}.o", a);
+            else if (result->objects.size() > 1)
+                path = fs::path(directory) / fmt::format("{}.{}.o", name, a);
+
+            std::string file;
+
+            if (keepsObjectsInMemory)
+                file = makeMemoryFile(object, path.filename().string(), memoryFiles);
+
+            if (file.empty()) {
+                writeObjectFile(object, path);
+
+                file = path.string();
+            }
+
+            objectFiles.push_back(std::move(file));
+        }
+
+        if (targetConfig->type == TargetType::Executable && linksExecutables) {
             auto linkFile = fs::path(directory) / name;
 
             if (logHeader(LogSource::target)) {
@@ -448,11 +858,26 @@ namespace kara::cli {
                 libraryNames.insert(file);
             }
 
-            std::vector<std::string> arguments = { root, outputFile.string(), "-o", linkFile.string() };
+            std::vector<std::string> arguments = { root };
+
+            auto startFiles = platform->startFiles();
+            arguments.insert(arguments.end(), startFiles.begin(), startFiles.end());
+
+            arguments.insert(arguments.end(), objectFiles.begin(), objectFiles.end());
+            arguments.insert(arguments.end(), { "-o", linkFile.string() });
 
             auto additionalArguments = platform->defaultLinkerArguments();
             arguments.insert(arguments.end(), additionalArguments.begin(), additionalArguments.end());
 
+            if (options.pgoInstrument) {
+                auto runtime = platform->profileRuntime();
+
+                if (runtime.empty())
+                    log(LogSource::platform, "Profile runtime cannot be found, link will probably fail.");
+                else
+                    arguments.insert(arguments.end(), runtime.begin(), runtime.end());
+            }
+
             for (const auto &path : libraryPaths)
                 arguments.push_back(fmt::format("-L{}", path));
 
@@ -463,7 +888,15 @@ namespace kara::cli {
 
             arguments.insert(arguments.end(), linkOpts.begin(), linkOpts.end());
 
-            auto linkerResult = invokeLinker(linkerType, arguments);
+            auto endFiles = platform->endFiles();
+            arguments.insert(arguments.end(), endFiles.begin(), endFiles.end());
+
+            auto linker = linkerType.empty() ? platform->defaultLinkerType() : linkerType;
+            auto linkerResult = invokeLinker(linker, arguments);
+
+            for (auto descriptor : memoryFiles)
+                close(descriptor);
+
             if (!linkerResult.empty()) {
                 fmt::print("Module IR:\n");
                 result->module->print(llvm::outs(), nullptr);
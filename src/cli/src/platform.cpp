@@ -57,6 +57,9 @@ namespace kara::cli {
         case llvm::Triple::OSType::Darwin:
             return std::make_unique<MacOSPlatform>(std::move(root), std::move(name), lock);
 
+        case llvm::Triple::OSType::Linux:
+            return std::make_unique<LinuxPlatform>(std::move(root), std::move(name), lock);
+
         default:
             return std::make_unique<Platform>(std::move(root), std::move(name), lock);
         }
@@ -173,8 +176,64 @@ namespace kara::cli {
         return {};
     }
 
+    std::string Platform::defaultLinkerType() {
+        llvm::Triple tripleInfo(this->triple);
+
+        switch (tripleInfo.getObjectFormat()) {
+        case llvm::Triple::ObjectFormatType::MachO:
+            return "macho";
+
+        case llvm::Triple::ObjectFormatType::COFF:
+            return tripleInfo.isWindowsGNUEnvironment() ? "mingw" : "coff";
+
+        case llvm::Triple::ObjectFormatType::Wasm:
+            return "wasm";
+
+        default:
+            return "elf";
+        }
+    }
+
     std::vector<std::string> Platform::defaultLinkerArguments() { return {}; }
 
+    std::vector<std::string> Platform::startFiles() { return {}; }
+    std::vector<std::string> Platform::endFiles() { return {}; }
+
+    std::vector<std::string> Platform::profileRuntime() {
+        auto runtimeIt = lock.parameters.find("profile-runtime");
+        if (runtimeIt != lock.parameters.end() && fs::exists(runtimeIt->second))
+            return { runtimeIt->second };
+
+        // clang --print-runtime-dir
+        auto [status, buffer] = invokeCLIWithStdOut("clang", { root, "--print-runtime-dir" });
+
+        if (status != 0)
+            return {};
+
+        fs::path directory(std::string(trimString(std::string(buffer.begin(), buffer.end()))));
+
+        llvm::Triple tripleInfo(this->triple);
+
+        // per target directory layout, older per os layout, then darwin
+        std::vector<std::string> names = {
+            "libclang_rt.profile.a",
+            fmt::format("libclang_rt.profile-{}.a", tripleInfo.getArchName().str()),
+            "libclang_rt.profile_osx.a",
+        };
+
+        for (const auto &name : names) {
+            auto path = directory / name;
+
+            if (fs::exists(path)) {
+                lock.parameters["profile-runtime"] = path.string();
+
+                return { path.string() };
+            }
+        }
+
+        return {};
+    }
+
     Platform::Platform(std::string root, std::string triple, BuildLockFile &lock)
         : root(std::move(root))
         , triple(std::move(triple))
@@ -236,4 +295,164 @@ namespace kara::cli {
 
     MacOSPlatform::MacOSPlatform(std::string root, std::string triple, BuildLockFile &lock)
         : Platform(std::move(root), std::move(triple), lock) { }
+
+    bool LinuxPlatform::matchesHost() {
+        llvm::Triple tripleInfo(this->triple);
+        llvm::Triple hostInfo(llvm::sys::getProcessTriple());
+
+        // the vendor does not change which files the host toolchain finds
+        return tripleInfo.getArch() == hostInfo.getArch() && tripleInfo.getOS() == hostInfo.getOS()
+            && tripleInfo.getEnvironment() == hostInfo.getEnvironment();
+    }
+
+    std::string LinuxPlatform::findToolchainFile(const std::string &key, const std::string &argument) {
+        auto fileIt = lock.parameters.find(key);
+        if (fileIt != lock.parameters.end() && fs::exists(fileIt->second))
+            return fileIt->second;
+
+        // cc -print-file-name=crt1.o
+        auto [status, buffer] = invokeCLIWithStdOut("cc", { root, argument });
+
+        if (status != 0)
+            return "";
+
+        // the driver echoes the bare name back if it cannot find the file
+        fs::path path(std::string(trimString(std::string(buffer.begin(), buffer.end()))));
+
+        if (!path.is_absolute() || !fs::exists(path))
+            return "";
+
+        auto result = fs::canonical(path).string();
+
+        lock.parameters[key] = result;
+
+        return result;
+    }
+
+    std::string LinuxPlatform::dynamicLoader() {
+        auto loaderIt = lock.parameters.find("linux-loader");
+        if (loaderIt != lock.parameters.end() && fs::exists(loaderIt->second))
+            return loaderIt->second;
+
+        llvm::Triple tripleInfo(this->triple);
+
+        // glibc first, then musl, the path is written into the executable so it is not resolved any further
+        std::vector<std::string> candidates;
+
+        switch (tripleInfo.getArch()) {
+        case llvm::Triple::ArchType::x86_64:
+            candidates = { "/lib64/ld-linux-x86-64.so.2", "/lib/ld-musl-x86_64.so.1" };
+            break;
+
+        case llvm::Triple::ArchType::x86:
+            candidates = { "/lib/ld-linux.so.2", "/lib/ld-musl-i386.so.1" };
+            break;
+
+        case llvm::Triple::ArchType::aarch64:
+            candidates = { "/lib/ld-linux-aarch64.so.1", "/lib/ld-musl-aarch64.so.1" };
+            break;
+
+        default:
+            break;
+        }
+
+        for (const auto &candidate : candidates) {
+            if (fs::exists(candidate)) {
+                lock.parameters["linux-loader"] = candidate;
+
+                return candidate;
+            }
+        }
+
+        return "";
+    }
+
+    std::vector<std::string> LinuxPlatform::defaultLinkerArguments() {
+        std::vector<std::string> result;
+
+        if (!matchesHost()) {
+            log(LogSource::platform,
+                "Skipping toolchain discovery, {} is not the host triple. Pass crt objects and libc in linker-options.",
+                triple);
+
+            return result;
+        }
+
+        auto loader = dynamicLoader();
+
+        if (loader.empty())
+            log(LogSource::platform, "Dynamic loader cannot be found, executable will probably not start.");
+        else
+            result.insert(result.end(), { "-dynamic-linker", loader });
+
+        // libc.so is usually a linker script that pulls in libc.so.6 and libc_nonshared.a
+        auto libc = findToolchainFile("linux-libc", "-print-file-name=libc.so");
+
+        if (libc.empty()) {
+            log(LogSource::platform, "libc cannot be found, link will probably fail. is a c toolchain installed?");
+        } else {
+            result.push_back(fmt::format("-L{}", fs::path(libc).parent_path().string()));
+            result.push_back("-lc");
+        }
+
+        // libgcc.a or compiler-rt builtins, for helpers llvm lowers some operations to
+        auto builtins = findToolchainFile("linux-builtins", "-print-libgcc-file-name");
+
+        if (!builtins.empty())
+            result.push_back(builtins);
+
+        return result;
+    }
+
+    std::vector<std::string> LinuxPlatform::startFiles() {
+        std::vector<std::string> result;
+
+        if (!matchesHost())
+            return result;
+
+        for (const auto &name : { "crt1.o", "crti.o", "crtbegin.o" }) {
+            auto path = findToolchainFile(fmt::format("linux-{}", name), fmt::format("-print-file-name={}", name));
+
+            if (path.empty())
+                log(LogSource::platform, "{} cannot be found, link will probably fail.", name);
+            else
+                result.push_back(path);
+        }
+
+        return result;
+    }
+
+    std::vector<std::string> LinuxPlatform::endFiles() {
+        std::vector<std::string> result;
+
+        if (!matchesHost())
+            return result;
+
+        for (const auto &name : { "crtend.o", "crtn.o" }) {
+            auto path = findToolchainFile(fmt::format("linux-{}", name), fmt::format("-print-file-name={}", name));
+
+            if (path.empty())
+                log(LogSource::platform, "{} cannot be found, link will probably fail.", name);
+            else
+                result.push_back(path);
+        }
+
+        return result;
+    }
+
+    std::vector<std::string> LinuxPlatform::profileRuntime() {
+        if (!matchesHost())
+            return {};
+
+        auto result = Platform::profileRuntime();
+
+        // instrumented objects do not reference the runtime on linux, clang passes the same -u when it links
+        if (!result.empty())
+            result.insert(result.begin(), "-u__llvm_profile_runtime");
+
+        return result;
+    }
+
+    LinuxPlatform::LinuxPlatform(std::string root, std::string triple, BuildLockFile &lock)
+        : Platform(std::move(root), std::move(triple), lock) { }
 }
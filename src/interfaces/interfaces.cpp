@@ -1,6 +1,7 @@
 #include <interfaces/interfaces.h>
 
 #include <parser/function.h>
+#include <parser/expression.h>
 #include <parser/literals.h>
 #include <parser/type.h>
 #include <parser/variable.h>
@@ -15,8 +16,11 @@ using namespace kara;
 
 std::string toTypeString(const hermes::Node *node) {
     switch (node->is<parser::Kind>()) {
-    case parser::Kind::NamedTypename:
-        return node->as<parser::NamedTypename>()->name;
+    case parser::Kind::NamedTypename: {
+        auto e = node->as<parser::NamedTypename>();
+
+        return e->isGeneric ? fmt::format("^{}", e->name) : e->name;
+    }
     case parser::Kind::PrimitiveTypename:
         switch (node->as<parser::PrimitiveTypename>()->type) {
         case utils::PrimitiveType::Any:
@@ -74,11 +78,43 @@ std::string toTypeString(const hermes::Node *node) {
             return fmt::format("[{}:]", toTypeString(e->body()));
         case utils::ArrayKind::Iterable:
             return fmt::format("[{}::]", toTypeString(e->body()));
+        case utils::ArrayKind::Hybrid:
+            return fmt::format("[{},{}]", toTypeString(e->body()), std::get<uint64_t>(e->fixedSize()->value));
         default:
             throw;
         }
     }
 
+    case parser::Kind::MapTypename: {
+        auto e = node->as<parser::MapTypename>();
+
+        return fmt::format("[{} -> {}]", toTypeString(e->key()), toTypeString(e->value()));
+    }
+
+    case parser::Kind::TupleTypename: {
+        auto e = node->as<parser::TupleTypename>();
+
+        auto elements = e->elements();
+
+        std::vector<std::string> text(elements.size());
+        std::transform(
+            elements.begin(), elements.end(), text.begin(), [](const auto &p) { return toTypeString(p); });
+
+        return fmt::format("({})", fmt::join(text, " & "));
+    }
+
+    case parser::Kind::VariantTypename: {
+        auto e = node->as<parser::VariantTypename>();
+
+        auto alternatives = e->alternatives();
+
+        std::vector<std::string> text(alternatives.size());
+        std::transform(
+            alternatives.begin(), alternatives.end(), text.begin(), [](const auto &p) { return toTypeString(p); });
+
+        return fmt::format("({})", fmt::join(text, " | "));
+    }
+
     case parser::Kind::FunctionTypename: {
         auto e = node->as<parser::FunctionTypename>();
 
@@ -152,11 +188,19 @@ int main(int count, const char **args) {
                 return std::visit([](auto x) { return std::to_string(x); }, node->value);
             };
 
-            assert(!v->hasInitialValue);
+            // a kara global holds an expression, only a plain number is printed
+            auto constant = v->constantValue();
+
+            if (v->hasInitialValue) {
+                auto noun = std::get_if<utils::ExpressionNoun>(&v->value()->result);
+
+                if (noun && noun->content->is(parser::Kind::Number))
+                    constant = noun->content->as<parser::Number>();
+            }
 
-            fmt::print("{} {} {}{}{}\n", v->isMutable ? "var" : "let", v->name, toTypeString(v->fixedType()),
-                v->isExternal ? " external" : "",
-                v->hasConstantValue ? fmt::format(" = {}", toString(v->constantValue())) : "");
+            fmt::print("{} {}{}{}{}\n", v->isMutable ? "var" : "let", v->name,
+                v->hasFixedType ? fmt::format(" {}", toTypeString(v->fixedType())) : "",
+                v->isExternal ? " external" : "", constant ? fmt::format(" = {}", toString(constant)) : "");
 
             break;
         }
@@ -183,6 +227,27 @@ int main(int count, const char **args) {
             break;
         }
 
+        case parser::Kind::Enum: {
+            auto n = e->as<parser::Enum>();
+
+            auto toString = [](const parser::Number *node) -> std::string {
+                return std::visit([](auto x) { return std::to_string(x); }, node->value);
+            };
+
+            std::vector<std::string> elements;
+
+            auto cases = n->cases();
+            elements.reserve(cases.size());
+
+            for (auto c : cases)
+                elements.push_back(c->hasValue ? fmt::format("{} = {}", c->name, toString(c->value())) : c->name);
+
+            fmt::print("enum {}{} {{\n\t{}\n}}\n", n->name,
+                n->hasFixedType ? fmt::format(" {}", toTypeString(n->fixedType())) : "", fmt::join(elements, ",\n\t"));
+
+            break;
+        }
+
         default:
             throw;
         }
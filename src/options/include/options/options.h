@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <optional>
 #include <set>
 #include <string>
 
@@ -16,6 +18,22 @@ namespace kara::options {
         explicit OptionsError(std::string reason);
     };
 
+    // flags given on the command line, each one that is set replaces the option of every target, even with a default
+    struct Overrides {
+        std::optional<size_t> optimize;
+        std::optional<bool> lto;
+        std::optional<bool> thinLto;
+
+        std::optional<std::string> verify;
+        std::optional<size_t> jobs;
+        std::optional<bool> inMemoryObjects;
+
+        std::optional<bool> pgoInstrument;
+        std::optional<std::string> pgoUse;
+
+        void connect(CLI::App &app);
+    };
+
     struct Options {
         //        std::set<std::string> inputs;
         //        std::string output;
@@ -27,16 +45,54 @@ namespace kara::options {
         std::string malloc = "malloc";
         std::string free = "free";
         std::string realloc = "realloc";
+        std::string calloc = "calloc";
+
+        // if set, allocations go through sized hooks instead of the stubs above:
+        //  {allocator}_allocate (i8 * (size_t size, size_t align))
+        //  {allocator}_deallocate (void (i8 *, size_t size, size_t align))
+        //  {allocator}_reallocate (i8 * (i8 *, size_t oldSize, size_t newSize, size_t align))
+        std::string allocator;
+
+        // [T:expr] locals bigger than this many bytes are heap allocated instead of placed on the stack
+        // 0 puts every one of them on the heap
+        size_t stackArrayLimit = 64 * 1024;
 
         bool rawPlatform = false;
         bool mutableGlobals = false;
 
+        // level of the llvm pipeline run on each target, 0 to skip it
+        // unset skips it too, except under lto and pgo which run it at 2
+        std::optional<size_t> optimize;
+        // executables link in the modules of every library target they import and optimize them as one
+        bool lto = false;
+        // like lto but modules stay per file, functions are imported across them by summary and codegen is parallel
+        bool thinLto = false;
+
+        // off, function (each function as it is built) or full (the linked module of each target)
+        // empty picks full for unoptimized targets and off otherwise
+        std::string verify;
+
+        // partitions each target module is split into for code generation on as many threads, 0 for one per core
+        size_t jobs = 1;
+
+        // executables hand their objects to lld (through a memfd on linux) or the jit without writing them to disk
+        bool inMemoryObjects = false;
+
+        // instrument targets to write build/{target}/{target}.profraw when run, merge it with llvm-profdata for pgoUse
+        bool pgoInstrument = false;
+        // path to an indexed .profdata that guides the llvm pipeline
+        std::string pgoUse;
+
+        // *shared T counts are updated with plain loads and stores instead of atomics, for single threaded targets
+        bool nonAtomicShared = false;
+
         bool operator==(const Options &other) const;
         bool operator!=(const Options &other) const;
 
         void connect(CLI::App &app);
 
         void merge(const Options &other);
+        void merge(const Overrides &other);
 
         Options() = default;
         Options(int count, const char **args);
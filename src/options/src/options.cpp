@@ -12,7 +12,12 @@ namespace kara::options {
 
     bool Options::operator==(const Options &other) const {
         return triple == other.triple && malloc == other.malloc && free == other.free && realloc == other.realloc
-            && rawPlatform == other.rawPlatform && mutableGlobals == other.mutableGlobals;
+            && calloc == other.calloc
+            && allocator == other.allocator && stackArrayLimit == other.stackArrayLimit
+            && rawPlatform == other.rawPlatform && mutableGlobals == other.mutableGlobals
+            && nonAtomicShared == other.nonAtomicShared && optimize == other.optimize && lto == other.lto
+            && thinLto == other.thinLto && pgoInstrument == other.pgoInstrument && pgoUse == other.pgoUse
+            && verify == other.verify && jobs == other.jobs && inMemoryObjects == other.inMemoryObjects;
     }
 
     bool Options::operator!=(const Options &other) const { return !operator==(other); }
@@ -33,9 +38,34 @@ namespace kara::options {
         app.add_option("--malloc", malloc, "Name of malloc stub function to link against (i8 * (size_t)).");
         app.add_option("--free", free, "Name of free stub function to link against (void (i8 *)).");
         app.add_option("--realloc", realloc, "Name of realloc stub function to link against (i8 * (i8 *, size_t)).");
+        app.add_option("--calloc", calloc, "Name of calloc stub function to link against (i8 * (size_t, size_t)).");
+        app.add_option("--allocator", allocator,
+            "Prefix of sized allocator hooks to link against ({prefix}_allocate, {prefix}_deallocate, "
+            "{prefix}_reallocate), overrides --malloc, --free and --realloc.");
+        app.add_option("--stack-array-limit", stackArrayLimit,
+            "Largest [T:expr] local in bytes that is placed on the stack, bigger ones go to the heap "
+            "(0 to always use the heap).");
 
         app.add_flag("--raw-platform", rawPlatform, "Disable any special handling for target platforms in build.");
         app.add_flag("--mutable-globals", mutableGlobals, "Whether or not to enable mutable globals.");
+        app.add_flag("--non-atomic-shared", nonAtomicShared,
+            "Use non-atomic reference counts for *shared T, only safe on single threaded targets.");
+
+        app.add_option_function<size_t>("-O,--optimize", [this](size_t level) { optimize = level; },
+               "Level of LLVM optimization passes to run (0 to 3).")
+            ->check(CLI::Range(0, 3));
+        app.add_flag("--lto", lto, "Link library targets into executables as IR and optimize them together.");
+        app.add_flag(
+            "--thin-lto", thinLto, "Like --lto, but import across modules by summary and codegen in parallel.");
+
+        app.add_option("--verify", verify, "When to verify IR (off, function or full), defaults by -O level.")
+            ->check(CLI::IsMember({ "off", "function", "full" }));
+        app.add_option("-j,--jobs", jobs, "Threads to split code generation across (0 for one per core).");
+        app.add_flag(
+            "--in-memory-objects", inMemoryObjects, "Pass executable objects to the linker without writing them.");
+
+        app.add_flag("--pgo-instrument", pgoInstrument, "Instrument the target to write a .profraw profile when run.");
+        app.add_option("--pgo-use", pgoUse, "Indexed .profdata profile to optimize the target with.");
     }
 
     // this is bad without nullopt
@@ -52,11 +82,75 @@ namespace kara::options {
             free = other.free;
         if (other.realloc != defaultOptions.realloc)
             realloc = other.realloc;
+        if (other.calloc != defaultOptions.calloc)
+            calloc = other.calloc;
+        if (other.allocator != defaultOptions.allocator)
+            allocator = other.allocator;
+        if (other.stackArrayLimit != defaultOptions.stackArrayLimit)
+            stackArrayLimit = other.stackArrayLimit;
 
         if (other.rawPlatform != defaultOptions.rawPlatform)
             rawPlatform = other.rawPlatform;
         if (other.mutableGlobals != defaultOptions.mutableGlobals)
             mutableGlobals = other.mutableGlobals;
+        if (other.nonAtomicShared != defaultOptions.nonAtomicShared)
+            nonAtomicShared = other.nonAtomicShared;
+
+        if (other.optimize)
+            optimize = other.optimize;
+        if (other.lto != defaultOptions.lto)
+            lto = other.lto;
+        if (other.thinLto != defaultOptions.thinLto)
+            thinLto = other.thinLto;
+
+        if (other.verify != defaultOptions.verify)
+            verify = other.verify;
+        if (other.jobs != defaultOptions.jobs)
+            jobs = other.jobs;
+        if (other.inMemoryObjects != defaultOptions.inMemoryObjects)
+            inMemoryObjects = other.inMemoryObjects;
+
+        if (other.pgoInstrument != defaultOptions.pgoInstrument)
+            pgoInstrument = other.pgoInstrument;
+        if (other.pgoUse != defaultOptions.pgoUse)
+            pgoUse = other.pgoUse;
+    }
+
+    void Options::merge(const Overrides &other) {
+        if (other.optimize)
+            optimize = other.optimize;
+        lto = other.lto.value_or(lto);
+        thinLto = other.thinLto.value_or(thinLto);
+
+        verify = other.verify.value_or(verify);
+        jobs = other.jobs.value_or(jobs);
+        inMemoryObjects = other.inMemoryObjects.value_or(inMemoryObjects);
+
+        pgoInstrument = other.pgoInstrument.value_or(pgoInstrument);
+        pgoUse = other.pgoUse.value_or(pgoUse);
+    }
+
+    void Overrides::connect(CLI::App &app) {
+        // bound through callbacks so only flags that were given are set
+        app.add_option_function<size_t>("-O,--optimize", [this](size_t level) { optimize = level; },
+               "Level of LLVM optimization passes to run (0 to 3).")
+            ->check(CLI::Range(0, 3));
+        app.add_flag_function("--lto", [this](int64_t) { lto = true; },
+            "Link library targets into executables as IR and optimize them together.");
+        app.add_flag_function("--thin-lto", [this](int64_t) { thinLto = true; },
+            "Like --lto, but import by summary and codegen in parallel.");
+
+        app.add_flag_function("--pgo-instrument", [this](int64_t) { pgoInstrument = true; },
+            "Instrument to write a .profraw when run.");
+        app.add_option_function<std::string>("--pgo-use", [this](const std::string &path) { pgoUse = path; },
+            "Indexed .profdata profile to optimize the target with.");
+        app.add_option_function<std::string>("--verify", [this](const std::string &level) { verify = level; },
+               "When to verify IR (off, function or full).")
+            ->check(CLI::IsMember({ "off", "function", "full" }));
+        app.add_option_function<size_t>("-j,--jobs", [this](size_t count) { jobs = count; },
+            "Threads to split code generation across (0 for one per core).");
+        app.add_flag_function("--in-memory-objects", [this](int64_t) { inMemoryObjects = true; },
+            "Link without writing executable objects.");
     }
 
     Options::Options(int count, const char **args) {
@@ -19,6 +19,17 @@ namespace kara::parser {
 
         bool isCVarArgs = false; // uh oh
 
+        // annotations after the parameters or return type, e.g. add(a int, b int) int inline => a + b
+        bool isInline = false;
+        bool isNoInline = false;
+        bool isCold = false;
+        bool isHot = false;
+        bool isPure = false;
+        bool isExport = false; // keeps external linkage when the function is part of an executable
+
+        // names introduced by ^T in parameter types in order of appearance, empty unless the function is generic
+        std::vector<std::string> generics;
+
         [[nodiscard]] std::vector<const Variable *> parameters() const;
 
         [[nodiscard]] const Node *fixedType() const;
@@ -26,4 +37,18 @@ namespace kara::parser {
 
         explicit Function(Node *parent, bool external = false);
     };
+
+    // (a int, b int) int => a + b or (a int) => { ... }, laid out like Function so both build the same way
+    struct Lambda : public hermes::Node {
+        size_t parameterCount = 0;
+
+        bool hasFixedType = false;
+
+        [[nodiscard]] std::vector<const Variable *> parameters() const;
+
+        [[nodiscard]] const Node *fixedType() const;
+        [[nodiscard]] const Node *body() const;
+
+        explicit Lambda(Node *parent);
+    };
 }
@@ -6,12 +6,17 @@ namespace kara::parser {
     enum class Kind {
         Root,
         Function,
+        Lambda,
         Variable,
+        Unpack,
         NamedTypename,
         PrimitiveTypename,
         OptionalTypename,
         ReferenceTypename,
         ArrayTypename,
+        MapTypename,
+        TupleTypename,
+        VariantTypename,
         FunctionTypename,
         Assign,
         Expression,
@@ -29,12 +34,16 @@ namespace kara::parser {
         If,
         For,
         ForIn,
+        Match,
+        MatchArm,
         Bool,
         New,
         Special,
         Array,
         Index,
         Type,
+        Enum,
+        EnumCase,
         Dot,
         Ternary,
         Slash,
@@ -10,8 +10,10 @@
 namespace kara::parser {
     struct Expression;
 
+    // (a) groups an expression, (a, b) makes a tuple
     struct Parentheses : public hermes::Node {
         [[nodiscard]] const Expression *body() const;
+        [[nodiscard]] std::vector<const Expression *> elements() const;
 
         explicit Parentheses(Node *parent);
     };
@@ -55,6 +57,8 @@ namespace kara::parser {
     };
 
     struct New : public hermes::Node {
+        bool isShared = false;
+
         [[nodiscard]] const Node *type() const;
 
         explicit New(Node *parent);
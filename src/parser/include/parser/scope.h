@@ -37,6 +37,25 @@ namespace kara::parser {
         explicit ForIn(Node *parent);
     };
 
+    // name Type => { ... } runs when the variant holds Type, value => { ... } when the matched value equals value
+    // and else => { ... } runs for anything not listed
+    struct MatchArm : public hermes::Node {
+        bool isDefault = false;
+
+        [[nodiscard]] const Variable *binding() const; // nullptr unless this is a name Type arm
+        [[nodiscard]] const Expression *pattern() const; // nullptr unless this is a value arm
+        [[nodiscard]] const Code *body() const;
+
+        explicit MatchArm(Node *parent);
+    };
+
+    struct Match : public hermes::Node {
+        [[nodiscard]] const Expression *value() const;
+        [[nodiscard]] std::vector<const MatchArm *> arms() const;
+
+        explicit Match(Node *parent);
+    };
+
     struct For : public hermes::Node {
         bool infinite = true;
 
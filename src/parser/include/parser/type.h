@@ -7,6 +7,7 @@
 #include <optional>
 
 namespace kara::parser {
+    struct Number;
     struct Variable;
 
     struct Type : public hermes::Node {
@@ -19,4 +20,27 @@ namespace kara::parser {
 
         explicit Type(Node *parent, bool external = false);
     };
+
+    // A or A = 5, a case without a value is one more than the case before it
+    struct EnumCase : public hermes::Node {
+        std::string name;
+
+        bool hasValue = false;
+
+        [[nodiscard]] const Number *value() const;
+
+        explicit EnumCase(Node *parent);
+    };
+
+    // enum Name { A, B }, or enum Name T { A, B } to pick the underlying integer type
+    struct Enum : public hermes::Node {
+        std::string name;
+
+        bool hasFixedType = false;
+
+        [[nodiscard]] const Node *fixedType() const;
+        [[nodiscard]] std::vector<const EnumCase *> cases() const;
+
+        explicit Enum(Node *parent);
+    };
 }
@@ -15,6 +15,8 @@ namespace kara::parser {
     struct NamedTypename : public hermes::Node {
         std::string name;
 
+        bool isGeneric = false; // ^T, introduces T and infers it from what is passed to the function
+
         explicit NamedTypename(Node *parent, bool external = false);
     };
 
@@ -54,6 +56,25 @@ namespace kara::parser {
         explicit ArrayTypename(Node *parent, bool external = false);
     };
 
+    struct MapTypename : public hermes::Node {
+        [[nodiscard]] const Node *key() const;
+        [[nodiscard]] const Node *value() const;
+
+        explicit MapTypename(Node *parent, bool external = false);
+    };
+
+    struct TupleTypename : public hermes::Node {
+        [[nodiscard]] std::vector<const Node *> elements() const;
+
+        explicit TupleTypename(Node *parent, bool external = false);
+    };
+
+    struct VariantTypename : public hermes::Node {
+        [[nodiscard]] std::vector<const Node *> alternatives() const;
+
+        explicit VariantTypename(Node *parent, bool external = false);
+    };
+
     struct FunctionTypename : public hermes::Node {
         utils::FunctionKind kind = utils::FunctionKind::Regular;
 
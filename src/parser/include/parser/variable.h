@@ -15,7 +15,7 @@ namespace kara::parser {
         bool isMutable = false;
         bool hasFixedType = false;
         bool hasInitialValue = false;
-        bool hasConstantValue = false;
+        bool hasConstantValue = false; // only for globals read from C headers, parsed globals hold an Expression
 
         bool isExternal = false;
 
@@ -25,4 +25,12 @@ namespace kara::parser {
 
         explicit Variable(Node *parent, bool isExplicit = true, bool external = false);
     };
+
+    // let (a, b) = value, every name is a Variable child that takes its type from the tuple
+    struct Unpack : public hermes::Node {
+        [[nodiscard]] std::vector<const Variable *> names() const;
+        [[nodiscard]] const Expression *value() const;
+
+        explicit Unpack(Node *parent);
+    };
 }
@@ -1,5 +1,6 @@
 #include <parser/expression.h>
 
+#include <parser/function.h>
 #include <parser/literals.h>
 #include <parser/operator.h>
 
@@ -85,7 +86,7 @@ namespace kara::parser {
             while (push<Unary>(true))
                 ;
 
-            push<Parentheses, Array, String, Special, Bool, Number, New, Reference>();
+            push<Lambda, Parentheses, Array, String, Special, Bool, Number, New, Reference>();
 
             while (true) {
                 // Ternary, As, Slash here?
@@ -104,6 +105,7 @@ namespace kara::parser {
         std::vector<const Operator *> operators;
 
         std::unordered_set<parser::Kind> literal = {
+            parser::Kind::Lambda,
             parser::Kind::Parentheses,
             parser::Kind::Array,
             parser::Kind::String,
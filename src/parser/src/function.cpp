@@ -5,7 +5,63 @@
 #include <parser/typename.h>
 #include <parser/variable.h>
 
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <unordered_set>
+
 namespace kara::parser {
+    namespace {
+        void findGenerics(const hermes::Node *node, std::vector<std::string> &names) {
+            if (node->is(Kind::NamedTypename)) {
+                auto e = node->as<NamedTypename>();
+
+                if (e->isGeneric && std::find(names.begin(), names.end(), e->name) == names.end())
+                    names.push_back(e->name);
+            }
+
+            for (const auto &child : node->children)
+                findGenerics(child.get(), names);
+        }
+    }
+
+    // One Time Descriptor, No Type -> Don't Add to Tree
+    struct FunctionAttribute : public hermes::Node {
+        enum class AttributeKind {
+            Inline,
+            NoInline,
+            Cold,
+            Hot,
+            Pure,
+            Export,
+        };
+
+        static const char *name(AttributeKind kind) {
+            switch (kind) {
+                case AttributeKind::Inline: return "inline";
+                case AttributeKind::NoInline: return "noinline";
+                case AttributeKind::Cold: return "cold";
+                case AttributeKind::Hot: return "hot";
+                case AttributeKind::Pure: return "pure";
+                case AttributeKind::Export: return "export";
+                default: throw;
+            }
+        }
+
+        AttributeKind kind = AttributeKind::Inline;
+
+        explicit FunctionAttribute(Node *parent) : Node(parent) {
+            kind = select<AttributeKind>({
+                { "inline", AttributeKind::Inline },
+                { "noinline", AttributeKind::NoInline },
+                { "cold", AttributeKind::Cold },
+                { "hot", AttributeKind::Hot },
+                { "pure", AttributeKind::Pure },
+                { "export", AttributeKind::Export },
+            }, true);
+        }
+    };
+
     std::vector<const Variable *> Function::parameters() const {
         std::vector<const Variable *> result(parameterCount);
 
@@ -39,11 +95,70 @@ namespace kara::parser {
             needs(")");
         }
 
+        for (auto parameter : parameters())
+            findGenerics(parameter, generics);
+
+        std::unordered_set<FunctionAttribute::AttributeKind> attributes;
+
+        auto pickAttributes = [&]() {
+            auto attribute = pick<FunctionAttribute>(true);
+
+            while (attribute) {
+                if (attributes.find(attribute->kind) != attributes.end()) {
+                    error(fmt::format("Attribute {} was found twice for function.",
+                        FunctionAttribute::name(attribute->kind)));
+                }
+
+                switch (attribute->kind) {
+                    case FunctionAttribute::AttributeKind::Inline:
+                        isInline = true;
+                        break;
+
+                    case FunctionAttribute::AttributeKind::NoInline:
+                        isNoInline = true;
+                        break;
+
+                    case FunctionAttribute::AttributeKind::Cold:
+                        isCold = true;
+                        break;
+
+                    case FunctionAttribute::AttributeKind::Hot:
+                        isHot = true;
+                        break;
+
+                    case FunctionAttribute::AttributeKind::Pure:
+                        isPure = true;
+                        break;
+
+                    case FunctionAttribute::AttributeKind::Export:
+                        isExport = true;
+                        break;
+
+                    default:
+                        throw;
+                }
+
+                attributes.insert(attribute->kind);
+
+                attribute = pick<FunctionAttribute>(true);
+            }
+        };
+
+        pickAttributes();
+
         if (!(peek("{") || peek("=>") || peek("external"))) {
             pushTypename(this);
             hasFixedType = true;
+
+            pickAttributes();
         }
 
+        if (isInline && isNoInline)
+            error("Function cannot be both inline and noinline.");
+
+        if (isCold && isHot)
+            error("Function cannot be both cold and hot.");
+
         if (next("external")) {
             match();
             isExtern = true;
@@ -62,4 +177,48 @@ namespace kara::parser {
             needs("}");
         }
     }
+
+    std::vector<const Variable *> Lambda::parameters() const {
+        std::vector<const Variable *> result(parameterCount);
+
+        for (size_t a = 0; a < parameterCount; a++)
+            result[a] = children[a]->as<Variable>();
+
+        return result;
+    }
+
+    const hermes::Node *Lambda::fixedType() const { return hasFixedType ? children[parameterCount].get() : nullptr; }
+
+    const hermes::Node *Lambda::body() const { return children[parameterCount + hasFixedType].get(); }
+
+    Lambda::Lambda(Node *parent)
+        : Node(parent, Kind::Lambda) {
+        // nothing is matched until =>, so (a + b) and (a) fall back to Parentheses
+        needs("(");
+
+        while (!end() && !peek(")")) {
+            push<Variable>(false, false);
+            parameterCount++;
+
+            next(",");
+        }
+
+        needs(")");
+
+        if (!peek("=>")) {
+            pushTypename(this);
+            hasFixedType = true;
+        }
+
+        needs("=>");
+        match();
+
+        if (next("{")) {
+            push<Code>();
+
+            needs("}");
+        } else {
+            push<Expression>();
+        }
+    }
 }
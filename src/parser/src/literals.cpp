@@ -12,6 +12,15 @@
 namespace kara::parser {
     const Expression *Parentheses::body() const { return children.front()->as<Expression>(); }
 
+    std::vector<const Expression *> Parentheses::elements() const {
+        std::vector<const Expression *> result(children.size());
+
+        for (size_t a = 0; a < children.size(); a++)
+            result[a] = children[a]->as<Expression>();
+
+        return result;
+    }
+
     Parentheses::Parentheses(Node *parent)
         : Node(parent, Kind::Parentheses) {
         if (next("group"))
@@ -21,6 +30,9 @@ namespace kara::parser {
 
         push<Expression>();
 
+        while (next(","))
+            push<Expression>();
+
         needs(")");
     }
 
@@ -241,6 +253,8 @@ namespace kara::parser {
         : Node(parent, Kind::New) {
         match("*");
 
+        isShared = next("shared", true);
+
         pushTypename(this);
     }
 }
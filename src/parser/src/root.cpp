@@ -39,7 +39,7 @@ namespace kara::parser {
         state.push(spaceStoppable); // needed to start parsing properly
 
         while (!end()) {
-            push<Import, Type, Variable, Function>();
+            push<Import, Type, Enum, Variable, Function>();
 
             while (next(","))
                 ;
@@ -9,7 +9,7 @@ namespace kara::parser {
     Code::Code(Node *parent)
         : Node(parent, Kind::Code) {
         while (!end() && !peek("}")) {
-            push<Block, Insight, If, For, Statement, Variable, Assign, Expression>();
+            push<Block, Insight, If, For, Match, Statement, Unpack, Variable, Assign, Expression>();
 
             while (next(","))
                 ;
@@ -72,6 +72,61 @@ namespace kara::parser {
         push<Expression>();
     }
 
+    const Variable *MatchArm::binding() const {
+        return children.front()->is(Kind::Variable) ? children.front()->as<Variable>() : nullptr;
+    }
+
+    const Expression *MatchArm::pattern() const {
+        return children.front()->is(Kind::Expression) ? children.front()->as<Expression>() : nullptr;
+    }
+
+    const Code *MatchArm::body() const { return children.back()->as<Code>(); }
+
+    MatchArm::MatchArm(Node *parent)
+        : Node(parent, Kind::MatchArm) {
+        if (next("else", true))
+            isDefault = true;
+        else
+            push<Variable, Expression>();
+
+        needs("=>");
+
+        needs("{");
+
+        push<Code>();
+
+        needs("}");
+    }
+
+    const Expression *Match::value() const { return children.front()->as<Expression>(); }
+
+    std::vector<const MatchArm *> Match::arms() const {
+        std::vector<const MatchArm *> result(children.size() - 1);
+
+        for (size_t a = 0; a < result.size(); a++)
+            result[a] = children[a + 1]->as<MatchArm>();
+
+        return result;
+    }
+
+    Match::Match(Node *parent)
+        : Node(parent, Kind::Match) {
+        match("match", true);
+
+        push<Expression>();
+
+        needs("{");
+
+        while (!end() && !peek("}")) {
+            push<MatchArm>();
+
+            while (next(","))
+                ;
+        }
+
+        needs("}");
+    }
+
     const hermes::Node *For::condition() const { return infinite ? nullptr : children[0].get(); }
 
     const Code *For::body() const { return children[!infinite]->as<Code>(); }
@@ -1,5 +1,6 @@
 #include <parser/type.h>
 
+#include <parser/literals.h>
 #include <parser/variable.h>
 
 namespace kara::parser {
@@ -49,4 +50,50 @@ namespace kara::parser {
             throw;
         }
     }
+
+    const Number *EnumCase::value() const { return hasValue ? children.front()->as<Number>() : nullptr; }
+
+    EnumCase::EnumCase(Node *parent)
+        : Node(parent, Kind::EnumCase) {
+        name = token();
+
+        if (next("=")) {
+            hasValue = true;
+
+            push<Number>();
+        }
+    }
+
+    const hermes::Node *Enum::fixedType() const { return hasFixedType ? children.front().get() : nullptr; }
+
+    std::vector<const EnumCase *> Enum::cases() const {
+        std::vector<const EnumCase *> result(children.size() - hasFixedType);
+
+        for (size_t a = 0; a < result.size(); a++)
+            result[a] = children[a + hasFixedType]->as<EnumCase>();
+
+        return result;
+    }
+
+    Enum::Enum(Node *parent)
+        : Node(parent, Kind::Enum) {
+        match("enum", true);
+
+        name = token();
+
+        if (!peek("{")) {
+            hasFixedType = true;
+            pushTypename(this);
+        }
+
+        needs("{");
+
+        while (!end() && !peek("}")) {
+            push<EnumCase>();
+
+            next(",");
+        }
+
+        needs("}");
+    }
 }
@@ -15,6 +15,8 @@ namespace kara::parser {
         if (external)
             return;
 
+        isGeneric = next("^");
+
         name = token();
     }
 
@@ -123,6 +125,7 @@ namespace kara::parser {
                         error("Shared pointer requested but base type is not unique (*).");
 
                     kind = utils::ReferenceKind::Shared;
+                    isShared = true;
                     break;
 
                 case ReferenceTypenameAttribute::AttributeKind::Ptr:
@@ -167,7 +170,16 @@ namespace kara::parser {
     const hermes::Node *ArrayTypename::body() const { return children.front().get(); }
 
     const Number *ArrayTypename::fixedSize() const {
-        return type == utils::ArrayKind::FixedSize ? children[1].get()->as<Number>() : nullptr;
+        if (type != utils::ArrayKind::FixedSize && type != utils::ArrayKind::Hybrid)
+            return nullptr;
+
+        auto size = children[1].get();
+
+        // [T:4] is parsed as an expression holding one number
+        if (size->is(Kind::Expression))
+            return std::get<utils::ExpressionNoun>(size->as<Expression>()->result).content->as<Number>();
+
+        return size->as<Number>();
     }
 
     const Expression *ArrayTypename::variableSize() const {
@@ -188,27 +200,98 @@ namespace kara::parser {
 
             if (next(":")) {
                 type = utils::ArrayKind::Iterable;
-            } else {
-                if (push<Number, Expression>(true)) {
-                    switch (children.back()->is<Kind>()) {
-                    case Kind::Number:
-                        type = utils::ArrayKind::FixedSize;
-                        break;
-
-                    case Kind::Expression:
-                        type = utils::ArrayKind::UnboundedSized;
-                        break;
-
-                    default:
-                        throw;
-                    }
-                }
+            } else if (push<Expression>(true)) {
+                // anything past a single number is folded by the builder if it can be, [T:N * 2]
+                auto noun = std::get_if<utils::ExpressionNoun>(&children.back()->as<Expression>()->result);
+
+                if (noun && noun->content->is(Kind::Number))
+                    type = utils::ArrayKind::FixedSize;
+                else
+                    type = utils::ArrayKind::UnboundedSized;
             }
+        } else if (next(",")) {
+            type = utils::ArrayKind::Hybrid;
+
+            push<Number>();
         }
 
         needs("]");
     }
 
+    const hermes::Node *MapTypename::key() const { return children[0].get(); }
+    const hermes::Node *MapTypename::value() const { return children[1].get(); }
+
+    MapTypename::MapTypename(Node *parent, bool external)
+        : Node(parent, Kind::MapTypename) {
+        if (external)
+            return;
+
+        match("[");
+
+        pushTypename(this);
+
+        match("->");
+
+        pushTypename(this);
+
+        needs("]");
+    }
+
+    std::vector<const hermes::Node *> TupleTypename::elements() const {
+        std::vector<const Node *> result(children.size());
+
+        std::transform(children.begin(), children.end(), result.begin(), [](const auto &r) { return r.get(); });
+
+        return result;
+    }
+
+    TupleTypename::TupleTypename(Node *parent, bool external)
+        : Node(parent, Kind::TupleTypename) {
+        if (external)
+            return;
+
+        match("(");
+
+        pushTypename(this);
+
+        // (T) is just T, a tuple needs at least two elements
+        match("&");
+
+        pushTypename(this);
+
+        while (next("&"))
+            pushTypename(this);
+
+        needs(")");
+    }
+
+    std::vector<const hermes::Node *> VariantTypename::alternatives() const {
+        std::vector<const Node *> result(children.size());
+
+        std::transform(children.begin(), children.end(), result.begin(), [](const auto &r) { return r.get(); });
+
+        return result;
+    }
+
+    VariantTypename::VariantTypename(Node *parent, bool external)
+        : Node(parent, Kind::VariantTypename) {
+        if (external)
+            return;
+
+        match("(");
+
+        pushTypename(this);
+
+        match("|");
+
+        pushTypename(this);
+
+        while (next("|"))
+            pushTypename(this);
+
+        needs(")");
+    }
+
     std::vector<const hermes::Node *> FunctionTypename::parameters() const {
         std::vector<const Node *> result(children.size() - 1);
 
@@ -247,7 +330,7 @@ namespace kara::parser {
     }
 
     void pushTypename(hermes::Node *parent) {
-        parent->push<ReferenceTypename, OptionalTypename, ArrayTypename, PrimitiveTypename, FunctionTypename,
-            NamedTypename>();
+        parent->push<ReferenceTypename, OptionalTypename, MapTypename, ArrayTypename, TupleTypename,
+            VariantTypename, PrimitiveTypename, FunctionTypename, NamedTypename>();
     }
 }
@@ -32,14 +32,27 @@ namespace kara::parser {
 
         name = token();
 
+        // for x in array, type is taken from the array
+        if (parent && parent->is(Kind::ForIn) && peek("in", true))
+            return;
+
+        // let (a, b) = value, type is taken from the tuple
+        if (parent && parent->is(Kind::Unpack))
+            return;
+
+        // name Type => { ... }, the type picks the alternative and nothing follows it
+        if (parent && parent->is(Kind::MatchArm)) {
+            hasFixedType = true;
+            pushTypename(this);
+
+            return;
+        }
+
+        // globals are folded by the builder, any constant expression can follow =
         if (next("=")) {
-            if (parent && parent->is(Kind::Root) && push<Number>(true)) {
-                hasConstantValue = true;
-            } else {
-                push<Expression>();
+            push<Expression>();
 
-                hasInitialValue = true;
-            }
+            hasInitialValue = true;
         } else {
             hasFixedType = true;
             pushTypename(this);
@@ -47,14 +60,48 @@ namespace kara::parser {
             if (next("external", true)) {
                 isExternal = true;
             } else if (next("=")) {
-                if (parent && parent->is(Kind::Root) && push<Number>(true)) {
-                    hasConstantValue = true;
-                } else {
-                    push<Expression>();
+                push<Expression>();
 
-                    hasInitialValue = true;
-                }
+                hasInitialValue = true;
             }
         }
     }
+
+    std::vector<const Variable *> Unpack::names() const {
+        std::vector<const Variable *> result(children.size() - 1);
+
+        for (size_t a = 0; a < result.size(); a++)
+            result[a] = children[a]->as<Variable>();
+
+        return result;
+    }
+
+    const Expression *Unpack::value() const { return children.back()->as<Expression>(); }
+
+    Unpack::Unpack(Node *parent)
+        : Node(parent, Kind::Unpack) {
+        bool isMutable = select<bool>({ { "let", false }, { "var", true } }, true);
+        match();
+
+        match("(");
+
+        while (!end() && !peek(")")) {
+            push<Variable>(false);
+
+            auto variable = children.back()->as<Variable>();
+            variable->isMutable = variable->isMutable || isMutable;
+
+            if (!next(","))
+                break;
+        }
+
+        needs(")");
+
+        if (children.size() < 2)
+            error("Unpacking requires at least two names.");
+
+        needs("=");
+
+        push<Expression>();
+    }
 }
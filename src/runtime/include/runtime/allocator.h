@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+
+// Allocators for the `allocator` option, set `allocator: kara_arena` or `allocator: kara_pool` under a target's
+// options in project.yaml and the cli links this runtime library into the target.
+//
+// ABI expected by generated code for a prefix P:
+//  void *P_allocate(size_t size, size_t align);
+//  void P_deallocate(void *pointer, size_t size, size_t align);
+//  void *P_reallocate(void *pointer, size_t oldSize, size_t newSize, size_t align);
+//
+// pointer may be null for deallocate (no-op) and reallocate (acts as allocate).
+// size may be 0 on deallocate when the compiler cannot know it (*[T:expr]).
+extern "C" {
+    // Bump allocator, deallocate only gives back memory from the most recent allocation.
+    // Every thread has its own current arena, one is created on first use if none is entered.
+    struct kara_arena;
+
+    kara_arena *kara_arena_create(size_t chunkSize);
+    void kara_arena_destroy(kara_arena *arena);
+
+    // frees everything allocated from arena, keeps the first chunk around
+    void kara_arena_reset(kara_arena *arena);
+
+    // makes arena current for this thread, returns the arena that was current
+    kara_arena *kara_arena_enter(kara_arena *arena);
+    kara_arena *kara_arena_current();
+
+    void *kara_arena_allocate(size_t size, size_t align);
+    void kara_arena_deallocate(void *pointer, size_t size, size_t align);
+    void *kara_arena_reallocate(void *pointer, size_t oldSize, size_t newSize, size_t align);
+
+    // Size class allocator, small objects are carved from aligned slabs and recycled through thread local free lists.
+    void *kara_pool_allocate(size_t size, size_t align);
+    void kara_pool_deallocate(void *pointer, size_t size, size_t align);
+    void *kara_pool_reallocate(void *pointer, size_t oldSize, size_t newSize, size_t align);
+}
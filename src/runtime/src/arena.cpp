@@ -0,0 +1,198 @@
+#include <runtime/allocator.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <algorithm>
+
+#include <pthread.h>
+
+struct kara_arena {
+    struct Chunk {
+        Chunk *previous = nullptr;
+        size_t size = 0; // bytes after the chunk header
+    };
+
+    size_t chunkSize = 0;
+
+    Chunk *chunk = nullptr;
+
+    uintptr_t cursor = 0;
+    uintptr_t end = 0;
+
+    uintptr_t last = 0; // start of the most recent allocation, for deallocate/reallocate in place
+};
+
+namespace kara::runtime {
+    namespace {
+        constexpr size_t defaultChunkSize = 64 * 1024;
+
+        uintptr_t alignUp(uintptr_t value, size_t align) {
+            if (align <= 1)
+                return value;
+
+            return (value + align - 1) & ~(uintptr_t(align) - 1);
+        }
+
+        uintptr_t chunkData(kara_arena::Chunk *chunk) { return reinterpret_cast<uintptr_t>(chunk + 1); }
+
+        void grow(kara_arena *arena, size_t size, size_t align) {
+            auto bytes = std::max(arena->chunkSize, size + align);
+
+            auto memory = static_cast<kara_arena::Chunk *>(std::malloc(sizeof(kara_arena::Chunk) + bytes));
+
+            if (!memory)
+                std::abort();
+
+            auto chunk = new (memory) kara_arena::Chunk { arena->chunk, bytes };
+
+            arena->chunk = chunk;
+            arena->cursor = chunkData(chunk);
+            arena->end = arena->cursor + bytes;
+            arena->last = 0;
+        }
+
+        // holds the arena that gets created when a thread allocates without entering one
+        // trivially destructible, generated code links this without a c++ runtime to register destructors with
+        struct ThreadArena {
+            kara_arena *current = nullptr;
+            kara_arena *fallback = nullptr;
+        };
+
+        thread_local ThreadArena threadArena;
+
+        // destroys the fallback arena of a thread when it exits
+        pthread_key_t fallbackKey;
+        pthread_once_t fallbackOnce = PTHREAD_ONCE_INIT;
+
+        void destroyFallback(void *arena) { kara_arena_destroy(static_cast<kara_arena *>(arena)); }
+
+        void makeFallbackKey() { pthread_key_create(&fallbackKey, destroyFallback); }
+    }
+}
+
+using namespace kara::runtime;
+
+kara_arena *kara_arena_create(size_t chunkSize) {
+    auto memory = std::malloc(sizeof(kara_arena));
+
+    if (!memory)
+        std::abort();
+
+    auto arena = new (memory) kara_arena;
+
+    arena->chunkSize = chunkSize ? chunkSize : defaultChunkSize;
+
+    return arena;
+}
+
+void kara_arena_destroy(kara_arena *arena) {
+    if (!arena)
+        return;
+
+    auto chunk = arena->chunk;
+
+    while (chunk) {
+        auto previous = chunk->previous;
+        std::free(chunk);
+
+        chunk = previous;
+    }
+
+    if (threadArena.current == arena)
+        threadArena.current = nullptr;
+    if (threadArena.fallback == arena) {
+        threadArena.fallback = nullptr;
+
+        pthread_setspecific(fallbackKey, nullptr);
+    }
+
+    std::free(arena);
+}
+
+void kara_arena_reset(kara_arena *arena) {
+    if (!arena || !arena->chunk)
+        return;
+
+    auto chunk = arena->chunk;
+
+    while (chunk->previous) {
+        auto previous = chunk->previous;
+        std::free(chunk);
+
+        chunk = previous;
+    }
+
+    arena->chunk = chunk;
+    arena->cursor = chunkData(chunk);
+    arena->end = arena->cursor + chunk->size;
+    arena->last = 0;
+}
+
+kara_arena *kara_arena_enter(kara_arena *arena) {
+    auto previous = threadArena.current;
+    threadArena.current = arena;
+
+    return previous;
+}
+
+kara_arena *kara_arena_current() {
+    if (threadArena.current)
+        return threadArena.current;
+
+    if (!threadArena.fallback) {
+        threadArena.fallback = kara_arena_create(0);
+
+        pthread_once(&fallbackOnce, makeFallbackKey);
+        pthread_setspecific(fallbackKey, threadArena.fallback);
+    }
+
+    return threadArena.fallback;
+}
+
+void *kara_arena_allocate(size_t size, size_t align) {
+    auto arena = kara_arena_current();
+
+    auto start = alignUp(arena->cursor, align);
+
+    if (!arena->chunk || start + size > arena->end) {
+        grow(arena, size, align);
+
+        start = alignUp(arena->cursor, align);
+    }
+
+    arena->cursor = start + size;
+    arena->last = start;
+
+    return reinterpret_cast<void *>(start);
+}
+
+void kara_arena_deallocate(void *pointer, size_t, size_t) {
+    auto arena = kara_arena_current();
+
+    // only the most recent allocation can be given back, the rest waits for reset
+    if (pointer && reinterpret_cast<uintptr_t>(pointer) == arena->last) {
+        arena->cursor = arena->last;
+        arena->last = 0;
+    }
+}
+
+void *kara_arena_reallocate(void *pointer, size_t oldSize, size_t newSize, size_t align) {
+    if (!pointer)
+        return kara_arena_allocate(newSize, align);
+
+    auto arena = kara_arena_current();
+    auto start = reinterpret_cast<uintptr_t>(pointer);
+
+    if (start == arena->last && start + newSize <= arena->end) {
+        arena->cursor = start + newSize;
+
+        return pointer;
+    }
+
+    auto result = kara_arena_allocate(newSize, align);
+    std::memcpy(result, pointer, std::min(oldSize, newSize));
+
+    return result;
+}
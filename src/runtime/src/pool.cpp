@@ -0,0 +1,153 @@
+#include <runtime/allocator.h>
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <algorithm>
+
+namespace kara::runtime {
+    namespace {
+        // Every block handed out lives in a slab aligned to slabSize, so the header is found by masking the pointer.
+        // That keeps deallocate working when the size is not known (0).
+        constexpr size_t slabSize = 64 * 1024;
+        constexpr size_t headerSize = 64;
+        constexpr size_t minimumAlign = 16;
+
+        constexpr std::array<size_t, 18> classes = {
+            16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096, 6144, 8192,
+        };
+
+        struct SlabHeader {
+            size_t size = 0; // object size for pooled slabs, usable bytes for large blocks
+            bool large = false;
+        };
+
+        static_assert(sizeof(SlabHeader) <= headerSize);
+
+        struct FreeNode {
+            FreeNode *next = nullptr;
+        };
+
+        struct ThreadPool {
+            std::array<FreeNode *, classes.size()> free = {};
+
+            // bump region of the slab currently being carved per class
+            std::array<uintptr_t, classes.size()> cursor = {};
+            std::array<uintptr_t, classes.size()> end = {};
+        };
+
+        thread_local ThreadPool threadPool;
+
+        size_t roundUp(size_t value, size_t align) { return (value + align - 1) / align * align; }
+
+        SlabHeader *headerOf(void *pointer) {
+            return reinterpret_cast<SlabHeader *>(reinterpret_cast<uintptr_t>(pointer) & ~(uintptr_t(slabSize) - 1));
+        }
+
+        void *makeSlab(size_t bytes) {
+            auto memory = std::aligned_alloc(slabSize, roundUp(bytes, slabSize));
+
+            if (!memory)
+                std::abort();
+
+            return memory;
+        }
+
+        // classes.size() if size does not fit a class
+        size_t classFor(size_t size) {
+            auto it = std::lower_bound(classes.begin(), classes.end(), std::max(size, size_t(1)));
+
+            return std::distance(classes.begin(), it);
+        }
+
+        void *allocateLarge(size_t size) {
+            auto memory = makeSlab(headerSize + size);
+
+            new (memory) SlabHeader { roundUp(headerSize + size, slabSize) - headerSize, true };
+
+            return static_cast<uint8_t *>(memory) + headerSize;
+        }
+
+        void *allocateSmall(size_t index) {
+            auto &pool = threadPool;
+
+            if (auto node = pool.free[index]) {
+                pool.free[index] = node->next;
+
+                return node;
+            }
+
+            auto size = classes[index];
+
+            if (pool.cursor[index] + size > pool.end[index]) {
+                auto memory = makeSlab(slabSize);
+
+                new (memory) SlabHeader { size, false };
+
+                pool.cursor[index] = reinterpret_cast<uintptr_t>(memory) + headerSize;
+                pool.end[index] = reinterpret_cast<uintptr_t>(memory) + slabSize;
+            }
+
+            auto result = pool.cursor[index];
+            pool.cursor[index] += size;
+
+            return reinterpret_cast<void *>(result);
+        }
+    }
+}
+
+using namespace kara::runtime;
+
+void *kara_pool_allocate(size_t size, size_t align) {
+    auto index = classFor(size);
+
+    // objects inside a slab are only guaranteed minimumAlign, large blocks are aligned to headerSize
+    if (index >= classes.size() || align > minimumAlign) {
+        if (align > headerSize)
+            std::abort();
+
+        return allocateLarge(size);
+    }
+
+    return allocateSmall(index);
+}
+
+void kara_pool_deallocate(void *pointer, size_t, size_t) {
+    if (!pointer)
+        return;
+
+    auto header = headerOf(pointer);
+
+    if (header->large) {
+        std::free(header);
+
+        return;
+    }
+
+    // slabs are never released, blocks freed on another thread join that thread's list
+    auto index = classFor(header->size);
+
+    auto node = static_cast<FreeNode *>(pointer);
+    node->next = threadPool.free[index];
+
+    threadPool.free[index] = node;
+}
+
+void *kara_pool_reallocate(void *pointer, size_t, size_t newSize, size_t align) {
+    if (!pointer)
+        return kara_pool_allocate(newSize, align);
+
+    auto capacity = headerOf(pointer)->size;
+
+    if (newSize <= capacity && (headerOf(pointer)->large || classFor(newSize) == classFor(capacity)))
+        return pointer;
+
+    auto result = kara_pool_allocate(newSize, align);
+    std::memcpy(result, pointer, std::min(capacity, newSize));
+
+    kara_pool_deallocate(pointer, capacity, align);
+
+    return result;
+}
@@ -7,19 +7,24 @@
 
 namespace kara::parser {
     struct Type;
+    struct Enum;
     struct Expression;
 }
 
 namespace kara::utils {
     // Builder Typename
     struct NamedTypename;
+    struct EnumTypename;
     struct ArrayTypename;
+    struct MapTypename;
+    struct TupleTypename;
+    struct VariantTypename;
     struct FunctionTypename;
     struct OptionalTypename;
     struct PrimitiveTypename;
     struct ReferenceTypename;
-    using Typename = std::variant<NamedTypename, ArrayTypename, FunctionTypename, OptionalTypename, PrimitiveTypename,
-        ReferenceTypename>;
+    using Typename = std::variant<NamedTypename, EnumTypename, ArrayTypename, MapTypename, TupleTypename,
+        VariantTypename, FunctionTypename, OptionalTypename, PrimitiveTypename, ReferenceTypename>;
 
     enum class PrimitiveType {
         Any,
@@ -44,6 +49,7 @@ namespace kara::utils {
         Unbounded, // [MyType:]
         UnboundedSized, // [MyType:expr]
         Iterable, // [MyType::]
+        Hybrid, // [MyType,50]
     };
 
     enum class ReferenceKind {
@@ -83,6 +89,14 @@ namespace kara::utils {
         bool operator!=(const NamedTypename &other) const;
     };
 
+    struct EnumTypename {
+        std::string name;
+        const parser::Enum *type = nullptr;
+
+        bool operator==(const EnumTypename &other) const;
+        bool operator!=(const EnumTypename &other) const;
+    };
+
     using FunctionParameters = std::vector<std::pair<std::string, Typename>>;
 
     struct FunctionTypename {
@@ -122,17 +136,43 @@ namespace kara::utils {
 
         std::shared_ptr<Typename> value;
 
-        size_t size = 0; // only for ArrayKind::FixedSize
+        size_t size = 0; // only for ArrayKind::FixedSize and ArrayKind::Hybrid (inline elements)
         const parser::Expression *expression = nullptr; // only for ArrayKind::UnboundedSized
 
         bool operator==(const ArrayTypename &other) const;
         bool operator!=(const ArrayTypename &other) const;
     };
 
+    struct MapTypename {
+        std::shared_ptr<Typename> key;
+        std::shared_ptr<Typename> value;
+
+        bool operator==(const MapTypename &other) const;
+        bool operator!=(const MapTypename &other) const;
+    };
+
+    struct TupleTypename {
+        std::vector<Typename> elements; // laid out like a C struct, in order
+
+        bool operator==(const TupleTypename &other) const;
+        bool operator!=(const TupleTypename &other) const;
+    };
+
+    struct VariantTypename {
+        std::vector<Typename> alternatives; // the tag is the index of the alternative being held
+
+        bool operator==(const VariantTypename &other) const;
+        bool operator!=(const VariantTypename &other) const;
+    };
+
     Typename from(PrimitiveType type);
 
     std::string toString(const NamedTypename &type);
+    std::string toString(const EnumTypename &type);
     std::string toString(const ArrayTypename &type);
+    std::string toString(const MapTypename &type);
+    std::string toString(const TupleTypename &type);
+    std::string toString(const VariantTypename &type);
     std::string toString(const FunctionTypename &type);
     std::string toString(const PrimitiveTypename &type);
     std::string toString(const ReferenceTypename &type);
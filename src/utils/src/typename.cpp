@@ -3,6 +3,7 @@
 #include <fmt/format.h>
 
 #include <array>
+#include <algorithm>
 
 namespace kara::utils {
     bool PrimitiveTypename::operator==(const PrimitiveTypename &other) const { return type == other.type; }
@@ -13,6 +14,10 @@ namespace kara::utils {
 
     bool NamedTypename::operator!=(const NamedTypename &other) const { return !operator==(other); }
 
+    bool EnumTypename::operator==(const EnumTypename &other) const { return type == other.type; }
+
+    bool EnumTypename::operator!=(const EnumTypename &other) const { return !operator==(other); }
+
     bool FunctionTypename::operator==(const FunctionTypename &other) const {
         auto check = [this, &other]() -> bool {
             if (parameters.size() != other.parameters.size())
@@ -51,6 +56,20 @@ namespace kara::utils {
 
     bool ArrayTypename::operator!=(const ArrayTypename &other) const { return !operator==(other); }
 
+    bool MapTypename::operator==(const MapTypename &other) const {
+        return *key == *other.key && *value == *other.value;
+    }
+
+    bool MapTypename::operator!=(const MapTypename &other) const { return !operator==(other); }
+
+    bool TupleTypename::operator==(const TupleTypename &other) const { return elements == other.elements; }
+
+    bool TupleTypename::operator!=(const TupleTypename &other) const { return !operator==(other); }
+
+    bool VariantTypename::operator==(const VariantTypename &other) const { return alternatives == other.alternatives; }
+
+    bool VariantTypename::operator!=(const VariantTypename &other) const { return !operator==(other); }
+
     std::string toString(const ArrayTypename &type) {
         std::string end = ([&type]() -> std::string {
             switch (type.kind) {
@@ -64,6 +83,8 @@ namespace kara::utils {
                 return fmt::format(":expr");
             case ArrayKind::VariableSize:
                 return "";
+            case ArrayKind::Hybrid:
+                return fmt::format(",{}", type.size);
             default:
                 throw;
             }
@@ -72,6 +93,26 @@ namespace kara::utils {
         return fmt::format("[{}{}]", toString(*type.value), end);
     }
 
+    std::string toString(const MapTypename &type) {
+        return fmt::format("[{} -> {}]", toString(*type.key), toString(*type.value));
+    }
+
+    std::string toString(const TupleTypename &type) {
+        std::vector<std::string> elements(type.elements.size());
+        std::transform(type.elements.begin(), type.elements.end(), elements.begin(),
+            [](const auto &t) { return toString(t); });
+
+        return fmt::format("({})", fmt::join(elements, " & "));
+    }
+
+    std::string toString(const VariantTypename &type) {
+        std::vector<std::string> alternatives(type.alternatives.size());
+        std::transform(type.alternatives.begin(), type.alternatives.end(), alternatives.begin(),
+            [](const auto &t) { return toString(t); });
+
+        return fmt::format("({})", fmt::join(alternatives, " | "));
+    }
+
     std::string toString(const PrimitiveTypename &type) {
         switch (type.type) {
         case PrimitiveType::Any:
@@ -109,6 +150,8 @@ namespace kara::utils {
 
     std::string toString(const NamedTypename &type) { return type.name; }
 
+    std::string toString(const EnumTypename &type) { return type.name; }
+
     std::string toString(const OptionalTypename &type) {
         return fmt::format("{}{}", type.bubbles ? "!" : "?", toString(*type.value));
     }